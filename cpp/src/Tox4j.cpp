@@ -1,18 +1,69 @@
+#include "util/debug_log.h"
+#include "util/exceptions.h"
+
 #include <jni.h>
 
 #include <tox/tox.h>
 
 
+extern func_name_table const tox_func_names;
+extern func_name_table const toxav_func_names;
+
+/*
+ * All function name tables for the debug log. This is a list of addresses,
+ * so it is constant-initialised and needs no code to run at load time.
+ */
+func_name_table const *const func_name_tables[] = {
+  &tox_func_names,
+  &toxav_func_names,
+  nullptr
+};
+
+
+extern tox_exception_table const tox_exceptions;
+extern tox_exception_table const toxav_exceptions;
+extern tox_exception_table const toxcrypto_exceptions;
+
+/*
+ * All exception class tables, cached in JNI_OnLoad. Like the function name
+ * tables, these are constant-initialised.
+ */
+tox_exception_table const *const tox_exception_tables[] = {
+  &tox_exceptions,
+  &toxav_exceptions,
+  &toxcrypto_exceptions,
+  nullptr
+};
+
+
+bool register_natives_av (JNIEnv *env);
+bool register_natives_core (JNIEnv *env);
+bool register_natives_crypto (JNIEnv *env);
+
+
 /*
  * Do setup here. Caching of needed java method IDs etc should be done in this
  * function. It is guaranteed to be called when the library is loaded, and
  * nothing else will be called before this function is called.
  */
 jint
-JNI_OnLoad (JavaVM *, void *)
+JNI_OnLoad (JavaVM *vm, void *)
 {
   if (!TOX_VERSION_IS_ABI_COMPATIBLE ())
     return -1;
+
+  JNIEnv *env;
+  if (vm->GetEnv (reinterpret_cast<void **> (&env), JNI_VERSION_1_4) != JNI_OK)
+    return -1;
+
+  // On failure, the pending NoClassDefFoundError or NoSuchMethodError is
+  // thrown from System.loadLibrary.
+  if (!cache_exception_classes (env) ||
+      !register_natives_av (env) ||
+      !register_natives_core (env) ||
+      !register_natives_crypto (env))
+    return -1;
+
   return JNI_VERSION_1_4;
 }
 
@@ -21,8 +72,12 @@ extern "C" void __gcov_flush ();
 #endif
 
 void
-JNI_OnUnload (JavaVM *, void *)
+JNI_OnUnload (JavaVM *vm, void *)
 {
+  JNIEnv *env;
+  if (vm->GetEnv (reinterpret_cast<void **> (&env), JNI_VERSION_1_4) == JNI_OK)
+    release_exception_classes (env);
+
 #ifdef HAVE_COVERAGE
   __gcov_flush ();
 #endif
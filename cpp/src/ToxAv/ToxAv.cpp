@@ -1,5 +1,11 @@
 #include "ToxAv.h"
 
+#include "util/hash.h"
+
+#include <algorithm>
+#include <cmath>
+#include <utility>
+
 using namespace av;
 
 ToxInstances<tox::av_ptr, std::unique_ptr<Events>> av::instances;
@@ -7,6 +13,692 @@ ToxInstances<tox::av_ptr, std::unique_ptr<Events>> av::instances;
 template<> char const *module_name<ToxAV>() { return "av"; }
 template<> char const *exn_prefix<ToxAV>() { return "av"; }
 
+
+std::size_t
+FramePool::acquire (std::size_t size)
+{
+  for (std::size_t i = 0; i < slots.size (); i++)
+    if (!slots[i].busy && slots[i].capacity >= size)
+      {
+        slots[i].busy = true;
+        return i + 1;
+      }
+  return 0;
+}
+
+void
+FramePool::hold (std::size_t slot)
+{
+  if (slot != 0)
+    slots[slot - 1].held = true;
+}
+
+void
+FramePool::release (std::size_t slot)
+{
+  if (slot != 0)
+    {
+      slots[slot - 1].busy = false;
+      slots[slot - 1].held = false;
+    }
+}
+
+void
+FramePool::release_all ()
+{
+  for (Slot &slot : slots)
+    if (!slot.held)
+      slot.busy = false;
+}
+
+
+proto::VideoReceiveFrame &
+VideoMailbox::put (FramePool &pool)
+{
+  uint32_t dropped = 0;
+  if (full)
+    {
+      dropped = frame.dropped_frames () + 1;
+      pool.release (frame.frame_slot ());
+    }
+  frame.Clear ();
+  frame.set_dropped_frames (dropped);
+  full = true;
+  return frame;
+}
+
+bool
+VideoMailbox::take (FramePool &pool, proto::AvEvents &events)
+{
+  pool.release (taken_slot);
+  taken_slot = 0;
+  if (!full)
+    return false;
+
+  taken_slot = frame.frame_slot ();
+  events.add_video_receive_frame ()->Swap (&frame);
+  frame.Clear ();
+  full = false;
+  return true;
+}
+
+void
+VideoMailbox::clear (FramePool &pool)
+{
+  pool.release (taken_slot);
+  taken_slot = 0;
+  if (full)
+    pool.release (frame.frame_slot ());
+  frame.Clear ();
+  full = false;
+}
+
+
+bool
+FriendVideo::accept_frame (std::chrono::steady_clock::time_point now)
+{
+  if (now < next_frame)
+    return false;
+
+  // Keep to the schedule unless we fell behind by more than a frame, as
+  // after a pause in the stream.
+  if (now - next_frame > min_interval)
+    next_frame = now + min_interval;
+  else
+    next_frame += min_interval;
+  return true;
+}
+
+
+void
+FriendVideo::scaled_size (uint16_t width, uint16_t height, uint16_t &scaled_width, uint16_t &scaled_height) const
+{
+  uint32_t const box_width = max_width != 0 ? max_width : width;
+  uint32_t const box_height = max_height != 0 ? max_height : height;
+  if (width <= box_width && height <= box_height)
+    {
+      scaled_width = width;
+      scaled_height = height;
+    }
+  else if (uint32_t (width) * box_height > uint32_t (height) * box_width)
+    {
+      scaled_width = box_width;
+      scaled_height = std::max<uint32_t> (1, uint32_t (height) * box_width / width);
+    }
+  else
+    {
+      scaled_width = std::max<uint32_t> (1, uint32_t (width) * box_height / height);
+      scaled_height = box_height;
+    }
+}
+
+
+void
+SendStats::record (TOXAV_ERR_SEND_FRAME error, std::size_t bytes, std::chrono::steady_clock::duration elapsed)
+{
+  send_time += elapsed;
+  max_send_time = std::max (max_send_time, elapsed);
+  if (error != TOXAV_ERR_SEND_FRAME_OK)
+    {
+      failures[error]++;
+      return;
+    }
+  frames++;
+  this->bytes += bytes;
+}
+
+void
+SendStats::merge (SendStats const &other)
+{
+  frames += other.frames;
+  bytes += other.bytes;
+  send_time += other.send_time;
+  max_send_time = std::max (max_send_time, other.max_send_time);
+  for (auto const &failure : other.failures)
+    failures[failure.first] += failure.second;
+}
+
+
+void
+ReceiveStats::record (std::size_t bytes, std::chrono::steady_clock::time_point now)
+{
+  if (frames != 0)
+    {
+      double const interval = std::chrono::duration<double, std::milli> (now - last_arrival).count ();
+      if (frames == 1)
+        interval_ms = interval;
+      // The gain of 1/16 is the one RFC 3550 uses for jitter.
+      interval_ms += (interval - interval_ms) / 16;
+      arrival_jitter_ms += (std::abs (interval - interval_ms) - arrival_jitter_ms) / 16;
+    }
+  frames++;
+  this->bytes += bytes;
+  last_arrival = now;
+}
+
+
+void
+FriendStats::Resolution::update (uint16_t frame_width, uint16_t frame_height)
+{
+  if (frame_width == width && frame_height == height)
+    return;
+  if (width != 0 || height != 0)
+    changes++;
+  width = frame_width;
+  height = frame_height;
+}
+
+
+resampler::polyphase &
+av::resampler_for (Resamplers &resamplers, uint32_t friend_number,
+                   uint32_t input_rate, uint8_t input_channels,
+                   uint32_t output_rate, uint8_t output_channels)
+{
+  auto found = resamplers.find (friend_number);
+  if (found != resamplers.end () && !found->second.converts (input_rate, input_channels))
+    {
+      resamplers.erase (found);
+      found = resamplers.end ();
+    }
+
+  if (found == resamplers.end ())
+    found = resamplers.emplace (friend_number,
+      resampler::polyphase (input_rate, input_channels, output_rate, output_channels)).first;
+  return found->second;
+}
+
+
+bool
+VoiceActivity::voice (uint32_t friend_number, int16_t const *pcm, std::size_t sample_count, uint8_t channels, uint32_t sampling_rate)
+{
+  if (!enabled)
+    return true;
+
+  auto found = friends.find (friend_number);
+  if (found == friends.end ())
+    found = friends.emplace (friend_number, vad::detector (threshold_dbfs, hangover_ms)).first;
+  return found->second.update (pcm, sample_count, channels, sampling_rate);
+}
+
+
+uint64_t
+VideoDedup::digest (uint16_t width, uint16_t height, uint8_t const *y, uint8_t const *u, uint8_t const *v)
+{
+  std::size_t const ySize = std::size_t (width) * height;
+  std::size_t const uvSize = std::size_t (width / 2) * (height / 2);
+  // The size is part of the digest, so the same bytes at another size differ.
+  uint64_t result = hash::digest (y, ySize, uint64_t (width) << 16 | height);
+  result = hash::digest (u, uvSize, result);
+  return hash::digest (v, uvSize, result);
+}
+
+bool
+VideoDedup::unchanged (uint32_t friend_number, uint64_t digest, std::chrono::steady_clock::time_point now)
+{
+  if (!enabled)
+    return false;
+
+  auto found = friends.find (friend_number);
+  if (found == friends.end () || found->second.digest != digest)
+    return false;
+  if (keep_alive.count () != 0 && now - found->second.last_sent >= keep_alive)
+    return false;
+
+  found->second.skipped++;
+  return true;
+}
+
+void
+VideoDedup::sent (uint32_t friend_number, uint64_t digest, std::chrono::steady_clock::time_point now)
+{
+  if (!enabled)
+    return;
+
+  Friend &sent_to = friends.emplace (friend_number, Friend { digest, now, 0 }).first->second;
+  sent_to.digest = digest;
+  sent_to.last_sent = now;
+}
+
+uint64_t
+VideoDedup::skipped (uint32_t friend_number) const
+{
+  auto found = friends.find (friend_number);
+  if (found == friends.end ())
+    return 0;
+  return found->second.skipped;
+}
+
+
+std::chrono::steady_clock::duration
+VideoPacer::Queue::interval () const
+{
+  uint32_t fps = max_fps;
+  if (bit_rate != 0 && reported_bit_rate < bit_rate)
+    fps = std::max<uint32_t> (1, uint64_t (max_fps) * reported_bit_rate / bit_rate);
+  return std::chrono::duration_cast<std::chrono::steady_clock::duration> (std::chrono::seconds (1)) / fps;
+}
+
+
+VideoPacer::VideoPacer (int32_t instance_number, ToxAV *av)
+  : VideoPacer (instance_number, av, toxav_video_send_frame_paced)
+{
+}
+
+VideoPacer::VideoPacer (int32_t instance_number, ToxAV *av, SendFrame send_frame)
+  : instance_number (instance_number)
+  , av (av)
+  , send_frame (send_frame)
+  , thread (&VideoPacer::run, this)
+{
+}
+
+VideoPacer::~VideoPacer ()
+{
+  {
+    std::lock_guard<std::mutex> lock (mutex);
+    stopping = true;
+  }
+  wake.notify_one ();
+  thread.join ();
+}
+
+void
+VideoPacer::configure (uint32_t friend_number, uint32_t max_fps, std::size_t depth, uint32_t bit_rate)
+{
+  std::lock_guard<std::mutex> lock (mutex);
+  if (max_fps == 0)
+    {
+      queues.erase (friend_number);
+      return;
+    }
+
+  auto found = queues.find (friend_number);
+  if (found == queues.end ())
+    found = queues.emplace (friend_number, Queue { {}, depth, max_fps, bit_rate, bit_rate, {}, 0, false, 0, 0, {} }).first;
+
+  Queue &queue = found->second;
+  queue.depth = depth;
+  queue.max_fps = max_fps;
+  queue.bit_rate = bit_rate;
+  queue.reported_bit_rate = bit_rate;
+  while (queue.frames.size () > depth)
+    {
+      queue.frames.pop_front ();
+      queue.dropped++;
+    }
+}
+
+bool
+VideoPacer::enqueue (uint32_t friend_number, int64_t capture_ms, uint16_t width, uint16_t height,
+                     uint8_t const *y, uint8_t const *u, uint8_t const *v)
+{
+  std::size_t const ySize = std::size_t (width) * height;
+  std::size_t const uvSize = std::size_t (width / 2) * (height / 2);
+
+  {
+    std::lock_guard<std::mutex> lock (mutex);
+    auto found = queues.find (friend_number);
+    if (found == queues.end ())
+      return false;
+
+    Queue &queue = found->second;
+    if (queue.frames.size () == queue.depth)
+      {
+        queue.spare.push_back (std::move (queue.frames.front ().planes));
+        queue.frames.pop_front ();
+        queue.dropped++;
+      }
+
+    std::vector<uint8_t> planes;
+    if (!queue.spare.empty ())
+      {
+        planes = std::move (queue.spare.back ());
+        queue.spare.pop_back ();
+      }
+    planes.resize (ySize + uvSize * 2);
+    std::copy (y, y + ySize, planes.begin ());
+    std::copy (u, u + uvSize, planes.begin () + ySize);
+    std::copy (v, v + uvSize, planes.begin () + ySize + uvSize);
+
+    queue.frames.push_back (Frame { capture_ms, width, height, std::move (planes), 0 });
+    pending = true;
+  }
+  wake.notify_one ();
+  return true;
+}
+
+void
+VideoPacer::bit_rate_status (uint32_t friend_number, uint32_t video_bit_rate)
+{
+  std::lock_guard<std::mutex> lock (mutex);
+  auto found = queues.find (friend_number);
+  if (found != queues.end ())
+    found->second.reported_bit_rate = video_bit_rate;
+}
+
+void
+VideoPacer::take_stats (Stats &into)
+{
+  std::lock_guard<std::mutex> lock (mutex);
+  for (auto const &entry : stats)
+    into[entry.first].video_sent.merge (entry.second);
+  stats.clear ();
+}
+
+uint32_t
+VideoPacer::take_failures (uint32_t friend_number)
+{
+  std::lock_guard<std::mutex> lock (mutex);
+  auto found = queues.find (friend_number);
+  if (found == queues.end ())
+    return 0;
+  return std::exchange (found->second.failures, 0);
+}
+
+namespace
+{
+  // How long a frame toxav was too busy to take waits before it is retried.
+  std::chrono::milliseconds const SYNC_RETRY_DELAY (2);
+}
+
+void
+VideoPacer::run ()
+{
+  struct Send
+  {
+    uint32_t friend_number;
+    Frame frame;
+    // The queue's state before this frame was taken, to restore on retry.
+    int64_t last_capture_ms;
+    bool sent_any;
+    TOXAV_ERR_SEND_FRAME error;
+    std::chrono::steady_clock::duration elapsed;
+  };
+  std::vector<Send> sending;
+
+  std::unique_lock<std::mutex> lock (mutex);
+  while (!stopping)
+    {
+      pending = false;
+      auto const now = std::chrono::steady_clock::now ();
+      auto wake_at = std::chrono::steady_clock::time_point::max ();
+
+      for (auto &entry : queues)
+        {
+          Queue &queue = entry.second;
+          if (queue.frames.empty ())
+            continue;
+          if (now < queue.next_send)
+            {
+              wake_at = std::min (wake_at, queue.next_send);
+              continue;
+            }
+
+          // A frame captured less than an interval after the last one sent
+          // is stale once a newer frame is waiting, so the frames that go out
+          // stay evenly spaced in capture time.
+          auto const interval = queue.interval ();
+          int64_t const interval_ms = std::chrono::duration_cast<std::chrono::milliseconds> (interval).count ();
+          while (queue.sent_any && queue.frames.size () > 1
+                 && queue.frames.front ().capture_ms - queue.last_capture_ms < interval_ms)
+            {
+              queue.spare.push_back (std::move (queue.frames.front ().planes));
+              queue.frames.pop_front ();
+              queue.dropped++;
+            }
+
+          sending.push_back (Send {
+            entry.first, std::move (queue.frames.front ()), queue.last_capture_ms, queue.sent_any,
+            TOXAV_ERR_SEND_FRAME_OK, {}
+          });
+          queue.frames.pop_front ();
+          queue.last_capture_ms = sending.back ().frame.capture_ms;
+          queue.sent_any = true;
+
+          // Keep to the schedule unless we fell behind by more than a frame.
+          if (now - queue.next_send > interval)
+            queue.next_send = now + interval;
+          else
+            queue.next_send += interval;
+          if (!queue.frames.empty ())
+            wake_at = std::min (wake_at, queue.next_send);
+        }
+
+      // Encode and send without the lock, so that enqueue never waits.
+      lock.unlock ();
+      for (Send &send : sending)
+        {
+          Frame const &frame = send.frame;
+          std::size_t const ySize = std::size_t (frame.width) * frame.height;
+          std::size_t const uvSize = std::size_t (frame.width / 2) * (frame.height / 2);
+          uint8_t const *y = frame.planes.data ();
+          uint8_t const *u = y + ySize;
+          uint8_t const *v = u + uvSize;
+
+          // There is no Java caller to throw to, so failures are only logged
+          // and counted.
+          LogEntry log_entry (instance_number, toxav_video_send_frame_paced, av, send.friend_number, frame.width, frame.height, y, u, v);
+          auto const start = std::chrono::steady_clock::now ();
+          log_entry.print_result (send_frame, av, send.friend_number, frame.width, frame.height, y, u, v, &send.error);
+          send.elapsed = std::chrono::steady_clock::now () - start;
+          if (send.error != TOXAV_ERR_SEND_FRAME_OK)
+            log_entry.set_error ();
+        }
+      lock.lock ();
+
+      for (Send &send : sending)
+        {
+          auto found = queues.find (send.friend_number);
+          if (found != queues.end () && send.error == TOXAV_ERR_SEND_FRAME_SYNC
+              && send.frame.sync_retries < SYNC_RETRIES)
+            {
+              Queue &queue = found->second;
+              send.frame.sync_retries++;
+              queue.frames.push_front (std::move (send.frame));
+              queue.last_capture_ms = send.last_capture_ms;
+              queue.sent_any = send.sent_any;
+              while (queue.frames.size () > queue.depth)
+                {
+                  queue.spare.push_back (std::move (queue.frames.front ().planes));
+                  queue.frames.pop_front ();
+                  queue.dropped++;
+                }
+              queue.next_send = std::chrono::steady_clock::now () + SYNC_RETRY_DELAY;
+              wake_at = std::min (wake_at, queue.next_send);
+              continue;
+            }
+
+          stats[send.friend_number].record (send.error, send.frame.planes.size (), send.elapsed);
+          if (found == queues.end ())
+            continue;
+          found->second.spare.push_back (std::move (send.frame.planes));
+          if (BitRateController::congestion (send.error))
+            found->second.failures++;
+        }
+      sending.clear ();
+
+      auto const wakeup = [this] { return stopping || pending; };
+      if (wake_at == std::chrono::steady_clock::time_point::max ())
+        wake.wait (lock, wakeup);
+      else
+        wake.wait_until (lock, wake_at, wakeup);
+    }
+}
+
+
+BitRateController::BitRateController (Range audio, Range video, std::chrono::steady_clock::duration hold)
+  : audio (audio)
+  , video (video)
+  , hold (hold)
+{
+}
+
+void
+BitRateController::suggest (uint32_t audio_bit_rate, uint32_t video_bit_rate)
+{
+  // The first report gives the rates the call started with. They are still
+  // taken as a suggestion, which moves them into range if they are outside.
+  if (!seeded)
+    {
+      this->audio_bit_rate = audio_bit_rate;
+      this->video_bit_rate = video_bit_rate;
+      seeded = true;
+    }
+
+  suggested = true;
+  suggested_audio = audio_bit_rate;
+  suggested_video = video_bit_rate;
+}
+
+/**
+ * The rate to move to from current towards target, or current if the step
+ * is too small or an increase comes too soon.
+ */
+static uint32_t
+next_bit_rate (uint32_t current, uint32_t target, BitRateController::Range range, bool may_increase)
+{
+  if (range.max == 0)
+    return current;
+
+  target = std::min (std::max (target, range.min), range.max);
+  uint32_t const margin = current / 8;
+  if (target + margin < current)
+    return target;
+  if (target > current + margin && may_increase)
+    return target;
+  return current;
+}
+
+bool
+BitRateController::decide (std::chrono::steady_clock::time_point now, proto::BitRateDecision &decision)
+{
+  uint32_t audio_next = audio_bit_rate;
+  uint32_t video_next = video_bit_rate;
+  bool const held = now - last_change < hold;
+
+  // Failures while a change is held are taken to be answered by it.
+  if (failures != 0 && video.max != 0 && seeded && !held)
+    {
+      video_next = std::max (video.min, video_bit_rate - video_bit_rate / 4);
+      decision.set_reason (proto::BitRateDecision::SEND_FAILURES);
+    }
+  else if (suggested)
+    {
+      audio_next = next_bit_rate (audio_bit_rate, suggested_audio, audio, !held);
+      video_next = next_bit_rate (video_bit_rate, suggested_video, video, !held);
+      decision.set_reason (proto::BitRateDecision::SUGGESTED);
+    }
+
+  failures = 0;
+  // A suggestion that was too soon to follow is kept for later.
+  if (audio_next == audio_bit_rate && video_next == video_bit_rate)
+    return false;
+
+  suggested = false;
+  audio_bit_rate = audio_next;
+  video_bit_rate = video_next;
+  last_change = now;
+
+  decision.set_audio_bit_rate (audio.max != 0 ? audio_bit_rate : 0);
+  decision.set_video_bit_rate (video.max != 0 ? video_bit_rate : 0);
+  return true;
+}
+
+bool
+BitRateController::congestion (TOXAV_ERR_SEND_FRAME error)
+{
+  // SYNC only reaches here once a retry found toxav still busy.
+  return error == TOXAV_ERR_SEND_FRAME_RTP_FAILED
+      || error == TOXAV_ERR_SEND_FRAME_SYNC;
+}
+
+
+AudioMixer::AudioMixer (std::size_t sample_count, uint8_t channels, uint32_t sampling_rate, std::size_t jitter_frames)
+  : sample_count (sample_count)
+  , channels (channels)
+  , sampling_rate (sampling_rate)
+  , jitter_frames (jitter_frames)
+  , frame_duration (std::chrono::duration_cast<std::chrono::steady_clock::duration> (
+      std::chrono::duration<double> (double (sample_count) / sampling_rate)))
+  , sum (sample_count * channels)
+  , mixed (sample_count * channels)
+{
+}
+
+void
+AudioMixer::set_participants (std::vector<uint32_t> const &friend_numbers)
+{
+  std::vector<Participant> updated;
+  updated.reserve (friend_numbers.size ());
+  for (uint32_t friend_number : friend_numbers)
+    {
+      if (std::any_of (updated.begin (), updated.end (),
+            [=] (Participant const &participant) { return participant.friend_number == friend_number; }))
+        continue;
+      auto found = std::find_if (participants.begin (), participants.end (),
+        [=] (Participant const &participant) { return participant.friend_number == friend_number; });
+      if (found != participants.end ())
+        updated.push_back (std::move (*found));
+      else
+        updated.push_back (Participant { friend_number, mixer::jitter_buffer (sample_count * channels, jitter_frames) });
+    }
+  participants = std::move (updated);
+
+  for (auto it = resamplers.begin (); it != resamplers.end (); )
+    if (std::none_of (participants.begin (), participants.end (),
+          [&] (Participant const &participant) { return participant.friend_number == it->first; }))
+      it = resamplers.erase (it);
+    else
+      ++it;
+
+  frames.resize (participants.size () * sample_count * channels);
+  present.resize (participants.size ());
+}
+
+bool
+AudioMixer::receive (uint32_t friend_number, int16_t const *pcm, std::size_t sample_count, uint8_t channels, uint32_t sampling_rate)
+{
+  for (Participant &participant : participants)
+    if (participant.friend_number == friend_number)
+      {
+        if (channels == this->channels && sampling_rate == this->sampling_rate)
+          participant.buffer.push (pcm, sample_count * channels);
+        else
+          {
+            resampled.clear ();
+            resampler_for (resamplers, friend_number, sampling_rate, channels, this->sampling_rate, this->channels)
+              .process (pcm, sample_count, resampled);
+            participant.buffer.push (resampled.data (), resampled.size ());
+          }
+        return true;
+      }
+  return false;
+}
+
+void
+AudioMixer::mix_frame ()
+{
+  std::size_t const frame_size = sample_count * channels;
+
+  std::fill (sum.begin (), sum.end (), 0);
+  for (std::size_t i = 0; i < participants.size (); i++)
+    {
+      int16_t *frame = &frames[i * frame_size];
+      present[i] = participants[i].buffer.pop (frame);
+      if (present[i])
+        mixer::accumulate (sum.data (), frame, frame_size);
+    }
+
+}
+
+int16_t const *
+AudioMixer::mix_minus (std::size_t i)
+{
+  std::size_t const frame_size = sample_count * channels;
+  mixer::mix_minus (mixed.data (), sum.data (), present[i] ? &frames[i * frame_size] : nullptr, frame_size);
+  return mixed.data ();
+}
+
 void
 reference_symbols_av ()
 {
@@ -18,3 +710,16 @@ reference_symbols_av ()
 #undef CXX_FUNCTION_REF
 #undef JAVA_METHOD_REF
 }
+
+
+bool
+register_natives_av (JNIEnv *env)
+{
+  static JNINativeMethod const methods[] = {
+#define JNI_NATIVE(NAME, SIGNATURE) JNI_NATIVE_METHOD (NAME, SIGNATURE),
+#include "generated/registrations.h"
+#undef JNI_NATIVE
+  };
+
+  return register_natives (env, JAVA_CLASS_NAME, methods);
+}
@@ -10,17 +10,571 @@
 // Header from toxcore.
 #include <tox/av.h>
 
+#include "util/mixer.h"
+#include "util/resampler.h"
+#include "util/vad.h"
+
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
 #ifndef SUBSYSTEM
 #define SUBSYSTEM TOXAV
 #define CLASS     ToxAv
 #define PREFIX    toxav
+#define OBJECT    ToxAV
 #endif
 
 namespace av
 {
   namespace proto = im::tox::tox4j::av::proto;
 
-  using Events = proto::AvEvents;
+  /**
+   * Direct ByteBuffers registered from Java for received video frames. The
+   * Java side keeps the buffers reachable for as long as they are registered,
+   * so only their addresses are kept here. A slot handed out during one
+   * iteration stays busy until the next toxavIterate, by which time Java has
+   * dispatched the frame it contains. Slots held for a video mailbox stay
+   * busy until they are released by number.
+   */
+  struct FramePool
+  {
+    struct Slot
+    {
+      uint8_t *data;
+      std::size_t capacity;
+      bool busy;
+      bool held;
+    };
+
+    std::vector<Slot> slots;
+
+    /**
+     * Reserve a free slot with room for at least size bytes. Returns the
+     * 1-based slot number, or 0 if no such slot is free.
+     */
+    std::size_t acquire (std::size_t size);
+    void hold (std::size_t slot);
+    void release (std::size_t slot);
+    void release_all ();
+  };
+
+  /**
+   * The latest video frame received from a friend in mailbox mode, kept
+   * across iterations until Java takes it. A newer frame replaces it and
+   * counts it as dropped. The frame pool slot of the waiting frame is held
+   * until it is replaced or taken, and that of the frame taken last until
+   * the next take, since Java may still be reading it.
+   */
+  struct VideoMailbox
+  {
+    proto::VideoReceiveFrame frame;
+    bool full = false;
+    std::size_t taken_slot = 0;
+
+    /**
+     * Make room for a new frame, and return the message to fill in.
+     */
+    proto::VideoReceiveFrame &put (FramePool &pool);
+
+    /**
+     * Move the waiting frame into events. Returns false if there is none.
+     */
+    bool take (FramePool &pool, proto::AvEvents &events);
+
+    /**
+     * Drop the waiting frame and release all slots.
+     */
+    void clear (FramePool &pool);
+  };
+
+  /**
+   * Limits on the video received from one friend, applied before a frame is
+   * added to the events for Java.
+   */
+  struct FriendVideo
+  {
+    // Bounding box for delivered frames. Larger frames are scaled down,
+    // keeping their aspect ratio. Zero means no limit.
+    uint16_t max_width = 0;
+    uint16_t max_height = 0;
+    // Frames arriving sooner than this after the last delivered one are
+    // dropped. Zero delivers every frame.
+    std::chrono::steady_clock::duration min_interval {};
+    std::chrono::steady_clock::time_point next_frame {};
+    // Keep at most one undelivered frame, replacing it with newer ones.
+    bool mailbox = false;
+
+    /**
+     * Whether these are the defaults, which deliver every frame unchanged.
+     */
+    bool unlimited () const
+    {
+      return max_width == 0 && max_height == 0 && min_interval.count () == 0 && !mailbox;
+    }
+
+    /**
+     * Whether to deliver a frame arriving now. If so, this schedules the next
+     * one without accumulating drift.
+     */
+    bool accept_frame (std::chrono::steady_clock::time_point now);
+
+    /**
+     * The size at which a frame of the given size is delivered.
+     */
+    void scaled_size (uint16_t width, uint16_t height, uint16_t &scaled_width, uint16_t &scaled_height) const;
+  };
+
+  /**
+   * Counters of the frames sent to a friend in one medium. Bytes are those
+   * of the raw samples or planes passed to toxav.
+   */
+  struct SendStats
+  {
+    uint64_t frames = 0;
+    uint64_t bytes = 0;
+    // Time spent inside the toxav send function, which is mostly encoding.
+    std::chrono::steady_clock::duration send_time {};
+    std::chrono::steady_clock::duration max_send_time {};
+    // Frames that failed to send, by error code.
+    std::map<TOXAV_ERR_SEND_FRAME, uint64_t> failures;
+
+    void record (TOXAV_ERR_SEND_FRAME error, std::size_t bytes, std::chrono::steady_clock::duration elapsed);
+    void merge (SendStats const &other);
+  };
+
+  /**
+   * Counters of the frames received from a friend in one medium, before any
+   * native processing. The time between arrivals is smoothed with the gain
+   * RTP uses, keeping its mean and its mean deviation, the arrival-interval
+   * jitter. Without RTP timestamps this is not the RFC 3550 interarrival
+   * jitter: gaps in the sender's capture count as jitter too.
+   */
+  struct ReceiveStats
+  {
+    uint64_t frames = 0;
+    uint64_t bytes = 0;
+    std::chrono::steady_clock::time_point last_arrival {};
+    double interval_ms = 0;
+    double arrival_jitter_ms = 0;
+
+    void record (std::size_t bytes, std::chrono::steady_clock::time_point now);
+  };
+
+  /**
+   * Media counters for one friend, since the instance was created or the
+   * friend was added to the Tox instance.
+   */
+  struct FriendStats
+  {
+    struct Resolution
+    {
+      uint16_t width;
+      uint16_t height;
+      uint32_t changes;
+
+      /**
+       * Note the size of a frame, counting it as a change unless it is the
+       * first frame.
+       */
+      void update (uint16_t frame_width, uint16_t frame_height);
+    };
+
+    SendStats audio_sent;
+    SendStats video_sent;
+    ReceiveStats audio_received;
+    ReceiveStats video_received;
+    Resolution sent_resolution {};
+    Resolution received_resolution {};
+  };
+
+  typedef std::unordered_map<uint32_t, FriendStats> Stats;
+
+  typedef std::unordered_map<uint32_t, resampler::polyphase> Resamplers;
+
+  /**
+   * The resampler for a friend's audio, replaced when the format it arrives
+   * in changes.
+   */
+  resampler::polyphase &resampler_for (Resamplers &resamplers, uint32_t friend_number,
+                                       uint32_t input_rate, uint8_t input_channels,
+                                       uint32_t output_rate, uint8_t output_channels);
+
+  /**
+   * A conference mixed natively. Audio received from its participants goes
+   * into their jitter buffers instead of to Java, and every frame duration
+   * each participant is sent the mix of all the others.
+   */
+  struct AudioMixer
+  {
+    struct Participant
+    {
+      uint32_t friend_number;
+      mixer::jitter_buffer buffer;
+    };
+
+    AudioMixer (std::size_t sample_count, uint8_t channels, uint32_t sampling_rate, std::size_t jitter_frames);
+
+    /**
+     * Change the participants, keeping the buffered audio of those who stay.
+     * A friend number listed more than once is added once.
+     */
+    void set_participants (std::vector<uint32_t> const &friend_numbers);
+
+    /**
+     * Buffer a received frame if it is from a participant. Returns whether
+     * it was, in which case the frame is not passed on to Java. Frames in a
+     * different format than the mixer's are resampled.
+     */
+    bool receive (uint32_t friend_number, int16_t const *pcm, std::size_t sample_count, uint8_t channels, uint32_t sampling_rate);
+
+    /**
+     * Mix all frames that are due by now, and call send with each
+     * participant's friend number and the mix of the others, a frame of
+     * sample_count samples in the mixer's format.
+     */
+    template<typename Send>
+    void
+    mix (std::chrono::steady_clock::time_point now, Send send)
+    {
+      // After a stall, start over from now instead of sending a burst of frames.
+      if (now - next_mix > frame_duration * 4)
+        next_mix = now;
+
+      while (next_mix <= now)
+        {
+          mix_frame ();
+          for (std::size_t i = 0; i < participants.size (); i++)
+            send (participants[i].friend_number, mix_minus (i));
+          next_mix += frame_duration;
+        }
+    }
+
+    std::size_t const sample_count;
+    uint8_t const channels;
+    uint32_t const sampling_rate;
+    std::size_t const jitter_frames;
+    std::chrono::steady_clock::duration const frame_duration;
+    std::chrono::steady_clock::time_point next_mix {};
+
+    std::vector<Participant> participants;
+
+  private:
+    // Sum the participants' next frames.
+    void mix_frame ();
+    // The sum of the current frames without participant i's.
+    int16_t const *mix_minus (std::size_t i);
+
+    std::vector<int32_t> sum;
+    std::vector<int16_t> frames;
+    std::vector<char> present;
+    std::vector<int16_t> mixed;
+    Resamplers resamplers;
+    std::vector<int16_t> resampled;
+  };
+
+  /**
+   * Audio sent at a rate toxav does not support, converted to 48 kHz. The
+   * converted samples are sent in frames of the same duration as the input
+   * frames, and any remainder waits for the next input frame.
+   */
+  struct ResampledSend
+  {
+    Resamplers resamplers;
+    std::unordered_map<uint32_t, std::vector<int16_t>> queues;
+  };
+
+  /**
+   * Voice activity detection for one direction of audio, with a detector per
+   * friend.
+   */
+  struct VoiceActivity
+  {
+    bool enabled = false;
+    int threshold_dbfs = 0;
+    uint32_t hangover_ms = 0;
+    std::unordered_map<uint32_t, vad::detector> friends;
+
+    /**
+     * Whether a frame should be passed on. Always true when disabled.
+     */
+    bool voice (uint32_t friend_number, int16_t const *pcm, std::size_t sample_count, uint8_t channels, uint32_t sampling_rate);
+  };
+
+  /**
+   * Skipping of video frames that are the same as the last one sent to a
+   * friend. Frames are compared by a digest of their planes, so a changed
+   * frame is only skipped if its digest collides with the previous one.
+   */
+  struct VideoDedup
+  {
+    struct Friend
+    {
+      uint64_t digest;
+      std::chrono::steady_clock::time_point last_sent;
+      uint64_t skipped;
+    };
+
+    bool enabled = false;
+    // An unchanged frame is sent anyway once this long has passed since the
+    // last one, so the receiver keeps getting video. Zero skips them all,
+    // which leaves the receiver's picture stale if the last frame was lost.
+    std::chrono::steady_clock::duration keep_alive {};
+    std::unordered_map<uint32_t, Friend> friends;
+
+    static uint64_t digest (uint16_t width, uint16_t height, uint8_t const *y, uint8_t const *u, uint8_t const *v);
+
+    /**
+     * Whether a frame with this digest can be skipped, counting it if so.
+     * Always false when disabled.
+     */
+    bool unchanged (uint32_t friend_number, uint64_t digest, std::chrono::steady_clock::time_point now);
+
+    /**
+     * Record a frame that was sent successfully.
+     */
+    void sent (uint32_t friend_number, uint64_t digest, std::chrono::steady_clock::time_point now);
+
+    /**
+     * The number of frames skipped for a friend since dedup was configured.
+     */
+    uint64_t skipped (uint32_t friend_number) const;
+  };
+
+  /**
+   * Video frames queued per friend and sent from a pacing thread, so that
+   * Java only copies a frame in and never waits for it to be encoded. Each
+   * friend's frames go out no faster than its frame rate, which is lowered
+   * in proportion when toxav reports a video bit rate below the one the call
+   * was set up with. When a queue is full, its oldest frame is dropped.
+   * Frames that toxav was too busy to take are put back and retried
+   * shortly after.
+   *
+   * The thread takes neither the instance lock nor this object's lock while
+   * sending, so it cannot deadlock with toxav_iterate delivering a bit rate
+   * status, and is joined by the destructor.
+   */
+  struct VideoPacer
+  {
+    struct Frame
+    {
+      // Capture time in milliseconds on the caller's clock. Only differences
+      // between the frames of one friend are used.
+      int64_t capture_ms;
+      uint16_t width;
+      uint16_t height;
+      // Packed I420 planes.
+      std::vector<uint8_t> planes;
+      // Times toxav was busy when this frame was sent.
+      uint32_t sync_retries;
+    };
+
+    struct Queue
+    {
+      std::deque<Frame> frames;
+      std::size_t depth;
+      uint32_t max_fps;
+      // The video bit rate in kbit/s that max_fps is meant for, and the last
+      // one toxav reported. Zero does not adapt the frame rate.
+      uint32_t bit_rate;
+      uint32_t reported_bit_rate;
+      std::chrono::steady_clock::time_point next_send;
+      int64_t last_capture_ms;
+      bool sent_any;
+      uint64_t dropped;
+      uint32_t failures;
+      // Plane buffers of sent and dropped frames, for reuse.
+      std::vector<std::vector<uint8_t>> spare;
+
+      std::chrono::steady_clock::duration interval () const;
+    };
+
+    typedef bool (*SendFrame) (ToxAV *av, uint32_t friend_number, uint16_t width, uint16_t height,
+                               uint8_t const *y, uint8_t const *u, uint8_t const *v, TOXAV_ERR_SEND_FRAME *error);
+
+    // toxav only try-locks its mutex, and reports SYNC without sending while
+    // toxav_iterate or another send holds it. Such a frame is put back and
+    // retried this many times before it counts as failed.
+    enum { SYNC_RETRIES = 5 };
+
+    VideoPacer (int32_t instance_number, ToxAV *av);
+    // Send with a function other than toxav_video_send_frame_paced, in tests.
+    VideoPacer (int32_t instance_number, ToxAV *av, SendFrame send_frame);
+    ~VideoPacer ();
+
+    /**
+     * Set up the queue for a friend, or remove it with max_fps 0.
+     */
+    void configure (uint32_t friend_number, uint32_t max_fps, std::size_t depth, uint32_t bit_rate);
+
+    /**
+     * Copy a frame into a friend's queue. Returns false if the friend has no
+     * queue.
+     */
+    bool enqueue (uint32_t friend_number, int64_t capture_ms, uint16_t width, uint16_t height,
+                  uint8_t const *y, uint8_t const *u, uint8_t const *v);
+
+    void bit_rate_status (uint32_t friend_number, uint32_t video_bit_rate);
+
+    /**
+     * The number of a friend's frames that failed to send since the last
+     * call.
+     */
+    uint32_t take_failures (uint32_t friend_number);
+
+    /**
+     * Add the counters of the frames sent since the last call to the
+     * friends' video send counters.
+     */
+    void take_stats (Stats &stats);
+
+  private:
+    void run ();
+
+    int32_t const instance_number;
+    ToxAV *const av;
+    SendFrame const send_frame;
+
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::unordered_map<uint32_t, Queue> queues;
+    // Kept apart from the queues, so that they outlive reconfiguration.
+    std::unordered_map<uint32_t, SendStats> stats;
+    bool pending = false;
+    bool stopping = false;
+
+    std::thread thread;
+  };
+
+  /**
+   * Bit rates of a call chosen natively, within a configured range for each
+   * of audio and video. A range with a maximum of 0 leaves that bit rate
+   * alone. Lower rates suggested by toxav are followed at once, higher ones
+   * only after the rate has held for a while, and either only when they
+   * differ by more than an eighth, so the rate does not flap. Video frames
+   * that fail to send because toxav or the network is congested lower the
+   * video bit rate by a quarter, no more often than the hold allows. The
+   * rates start at the first ones toxav reports for the call, and failures
+   * before that are ignored, since there is no rate yet to lower.
+   */
+  struct BitRateController
+  {
+    struct Range
+    {
+      uint32_t min;
+      uint32_t max;
+    };
+
+    BitRateController (Range audio, Range video, std::chrono::steady_clock::duration hold);
+
+    void suggest (uint32_t audio_bit_rate, uint32_t video_bit_rate);
+
+    /**
+     * Whether to change the bit rates now, and if so to what.
+     */
+    bool decide (std::chrono::steady_clock::time_point now, proto::BitRateDecision &decision);
+
+    /**
+     * Whether a video send failure counts against the bit rate. Errors in
+     * the call or the frame itself say nothing about the network.
+     */
+    static bool congestion (TOXAV_ERR_SEND_FRAME error);
+
+    Range audio;
+    Range video;
+    std::chrono::steady_clock::duration hold;
+
+    // The rates last set, or first reported by toxav.
+    uint32_t audio_bit_rate = 0;
+    uint32_t video_bit_rate = 0;
+    bool seeded = false;
+    std::chrono::steady_clock::time_point last_change {};
+
+    bool suggested = false;
+    uint32_t suggested_audio = 0;
+    uint32_t suggested_video = 0;
+    // Video frames that failed with a congestion error.
+    uint32_t failures = 0;
+  };
+
+  struct Events
+  {
+    proto::AvEvents pending;
+    FramePool frames;
+    // Format in which received video frames are passed to Java.
+    proto::VideoFormat video_format = proto::I420;
+    proto::AudioMetering audio_metering = proto::METERING_OFF;
+    // I420 planes of the last frame sent from RGBA pixels, kept to avoid
+    // allocating them for every frame.
+    std::vector<uint8_t> send_frame;
+    // Receive limits by friend number, and the planes of the last frame that
+    // was scaled down for one of them.
+    std::unordered_map<uint32_t, FriendVideo> friend_video;
+    std::vector<uint8_t> scaled_frame;
+    // Frames waiting for Java to take them, for friends in mailbox mode.
+    std::unordered_map<uint32_t, VideoMailbox> video_mailboxes;
+    // Conferences mixed natively, by mixer number.
+    std::unordered_map<int32_t, AudioMixer> mixers;
+    // Format that received audio is converted to before it goes to Java. A
+    // rate of 0 passes it on unchanged.
+    uint32_t audio_sampling_rate = 0;
+    uint8_t audio_channels = 0;
+    Resamplers receive_resamplers;
+    std::vector<int16_t> resampled;
+    ResampledSend resampled_send;
+    // Silent frames are not sent, and are reduced to a silence event when
+    // received.
+    VoiceActivity send_voice;
+    VoiceActivity receive_voice;
+    // Unchanged video frames are not sent again.
+    VideoDedup video_dedup;
+    // Created when pacing is first set up. The instance manager destroys the
+    // events before the ToxAV, so the pacing thread never outlives it.
+    std::unique_ptr<VideoPacer> video_pacer;
+    // Calls whose bit rates are set natively, by friend number.
+    std::unordered_map<uint32_t, BitRateController> bit_rate_control;
+    Stats stats;
+  };
 
   extern ToxInstances<tox::av_ptr, std::unique_ptr<Events>> instances;
 }
+
+
+/*
+ * Forwarders to the send functions, used by the direct ByteBuffer and
+ * non-throwing methods so that their calls are logged under a name of their
+ * own.
+ */
+bool toxav_audio_send_frame_direct (ToxAV *av, uint32_t friend_number, int16_t const *pcm, size_t sample_count, uint8_t channels, uint32_t sampling_rate, TOXAV_ERR_SEND_FRAME *error);
+bool toxav_video_send_frame_direct (ToxAV *av, uint32_t friend_number, uint16_t width, uint16_t height, uint8_t const *y, uint8_t const *u, uint8_t const *v, TOXAV_ERR_SEND_FRAME *error);
+bool toxav_audio_send_frame_no_throw (ToxAV *av, uint32_t friend_number, int16_t const *pcm, size_t sample_count, uint8_t channels, uint32_t sampling_rate, TOXAV_ERR_SEND_FRAME *error);
+bool toxav_video_send_frame_no_throw (ToxAV *av, uint32_t friend_number, uint16_t width, uint16_t height, uint8_t const *y, uint8_t const *u, uint8_t const *v, TOXAV_ERR_SEND_FRAME *error);
+bool toxav_audio_send_frame_many (ToxAV *av, uint32_t friend_number, int16_t const *pcm, size_t sample_count, uint8_t channels, uint32_t sampling_rate, TOXAV_ERR_SEND_FRAME *error);
+bool toxav_video_send_frame_many (ToxAV *av, uint32_t friend_number, uint16_t width, uint16_t height, uint8_t const *y, uint8_t const *u, uint8_t const *v, TOXAV_ERR_SEND_FRAME *error);
+bool toxav_audio_send_frame_mixed (ToxAV *av, uint32_t friend_number, int16_t const *pcm, size_t sample_count, uint8_t channels, uint32_t sampling_rate, TOXAV_ERR_SEND_FRAME *error);
+bool toxav_audio_send_frame_resampled (ToxAV *av, uint32_t friend_number, int16_t const *pcm, size_t sample_count, uint8_t channels, uint32_t sampling_rate, TOXAV_ERR_SEND_FRAME *error);
+bool toxav_video_send_frame_paced (ToxAV *av, uint32_t friend_number, uint16_t width, uint16_t height, uint8_t const *y, uint8_t const *u, uint8_t const *v, TOXAV_ERR_SEND_FRAME *error);
+bool toxav_video_send_frame_rgba (ToxAV *av, uint32_t friend_number, uint16_t width, uint16_t height, uint8_t const *y, uint8_t const *u, uint8_t const *v, TOXAV_ERR_SEND_FRAME *error);
+
+void toxav_set_video_frame_pool (av::Events &events, std::vector<av::FramePool::Slot> slots);
+void toxav_set_video_format (av::Events &events, av::proto::VideoFormat format);
+void toxav_set_audio_metering (av::Events &events, av::proto::AudioMetering metering);
+void toxav_set_video_receive_options (av::Events &events, uint32_t friend_number, av::FriendVideo options);
+void toxav_set_video_mailbox (av::Events &events, uint32_t friend_number, bool enabled);
+bool toxav_take_video_frame (av::Events &events, uint32_t friend_number, av::proto::AvEvents &taken);
+void toxav_set_audio_receive_format (av::Events &events, uint32_t sampling_rate, uint8_t channels);
+void toxav_set_voice_activity_detection (av::Events &events, int threshold_dbfs, uint32_t hangover_ms, bool send, bool receive);
+void toxav_set_video_dedup (av::Events &events, bool enabled, std::chrono::steady_clock::duration keep_alive);
+void toxav_set_video_pacing (av::Events &events, int32_t instance_number, ToxAV *av, uint32_t friend_number, uint32_t max_fps, std::size_t depth, uint32_t bit_rate);
+bool toxav_video_enqueue_frame (av::Events &events, uint32_t friend_number, int64_t capture_ms, uint16_t width, uint16_t height, uint8_t const *y, uint8_t const *u, uint8_t const *v);
+void toxav_set_bit_rate_control (av::Events &events, uint32_t friend_number, av::BitRateController::Range audio, av::BitRateController::Range video, std::chrono::steady_clock::duration hold);
+void toxav_prune_stats (Tox const *tox, av::Events &events);
+av::proto::AvStats toxav_get_stats (ToxAV *av, av::Events &events);
+uint64_t toxav_get_video_frames_skipped (av::Events const &events, uint32_t friend_number);
+void toxav_set_audio_mixer (av::Events &events, int32_t mixer_number, std::vector<uint32_t> const &friend_numbers, std::size_t sample_count, uint8_t channels, uint32_t sampling_rate, std::size_t jitter_frames);
@@ -1,5 +1,11 @@
 #include "ToxAv.h"
 
+#include "util/yuv.h"
+
+#include <tox/core.h>
+
+#include <algorithm>
+
 using namespace av;
 
 /*
@@ -14,6 +20,115 @@ TOX_METHOD (jint, IterationInterval,
     toxav_iteration_interval);
 }
 
+/**
+ * Let each bit rate controller react to the suggestions and send failures
+ * since the last iteration, and set and report the rates it chooses.
+ */
+static void
+control_bit_rates (jint instanceNumber, ToxAV *av, Events &events)
+{
+  auto const now = std::chrono::steady_clock::now ();
+  for (auto &entry : events.bit_rate_control)
+    {
+      uint32_t const friend_number = entry.first;
+      BitRateController &controller = entry.second;
+      if (events.video_pacer)
+        controller.failures += events.video_pacer->take_failures (friend_number);
+
+      proto::BitRateDecision decision;
+      if (!controller.decide (now, decision))
+        continue;
+
+      // A negative rate leaves it unchanged.
+      int32_t const audio_bit_rate = controller.audio.max != 0 ? int32_t (controller.audio_bit_rate) : -1;
+      int32_t const video_bit_rate = controller.video.max != 0 ? int32_t (controller.video_bit_rate) : -1;
+      TOXAV_ERR_BIT_RATE_SET error;
+      LogEntry log_entry (instanceNumber, toxav_bit_rate_set, av, friend_number, audio_bit_rate, video_bit_rate);
+      log_entry.print_result (toxav_bit_rate_set, av, friend_number, audio_bit_rate, video_bit_rate, &error);
+      if (error != TOXAV_ERR_BIT_RATE_SET_OK)
+        {
+          log_entry.set_error ();
+          continue;
+        }
+
+      decision.set_friend_number (friend_number);
+      *events.pending.add_bit_rate_decision () = decision;
+    }
+}
+
+/**
+ * Send a frame with send_func, timing the call and counting it in the
+ * friend's stats and, if a video frame failed for congestion, in the
+ * friend's bit rate controller. toxav only try-locks its mutex, so a send
+ * that finds it busy is retried once. Returns the error code, for the
+ * caller to throw or return.
+ */
+template<typename SendFunc, typename ...Args>
+static TOXAV_ERR_SEND_FRAME
+counted_send (JNIEnv *env, jint instanceNumber, ToxAV *av, Events &events,
+              SendStats FriendStats::*stats, std::size_t bytes,
+              SendFunc send_func, uint32_t friend_number, Args &...args)
+{
+  auto const start = std::chrono::steady_clock::now ();
+  TOXAV_ERR_SEND_FRAME error;
+  for (int attempt = 0; attempt < 2; attempt++)
+    {
+      if (attempt != 0)
+        std::this_thread::yield ();
+      LogEntry log_entry (instanceNumber, send_func, av, friend_number, args...);
+      error = ::with_error_result (log_entry, env, send_func, av, friend_number, args...);
+      if (error != TOXAV_ERR_SEND_FRAME_SYNC)
+        break;
+    }
+  (events.stats[friend_number].*stats).record (error, bytes, std::chrono::steady_clock::now () - start);
+
+  if (stats == &FriendStats::video_sent && BitRateController::congestion (error))
+    {
+      auto controller = events.bit_rate_control.find (friend_number);
+      if (controller != events.bit_rate_control.end ())
+        controller->second.failures++;
+    }
+  return error;
+}
+
+/**
+ * The result of a non-throwing send, as with_error_code would return it.
+ */
+static jlong
+send_result_code (JNIEnv *env, TOXAV_ERR_SEND_FRAME error)
+{
+  ErrorHandling const result = handle_error_enum<TOXAV_ERR_SEND_FRAME> (error);
+  switch (result.result)
+    {
+    case ErrorHandling::SUCCESS:
+      return 0;
+    case ErrorHandling::FAILURE:
+      return error_code_result<ToxAV> (env, error, result.error);
+    case ErrorHandling::UNHANDLED:
+      throw_illegal_state_exception (env, error, "Unknown error code");
+      break;
+    }
+  return error_code_unavailable;
+}
+
+static std::size_t
+pcm_bytes (jint sampleCount, jint channels)
+{
+  return std::size_t (sampleCount) * channels * sizeof (int16_t);
+}
+
+static std::size_t
+i420_bytes (jint width, jint height)
+{
+  return std::size_t (width) * height + std::size_t (width / 2) * (height / 2) * 2;
+}
+
+bool
+toxav_audio_send_frame_mixed (ToxAV *av, uint32_t friend_number, int16_t const *pcm, size_t sample_count, uint8_t channels, uint32_t sampling_rate, TOXAV_ERR_SEND_FRAME *error)
+{
+  return toxav_audio_send_frame (av, friend_number, pcm, sample_count, channels, sampling_rate, error);
+}
+
 /*
  * Class:     im_tox_tox4j_impl_ToxAvJni
  * Method:    toxavIterate
@@ -25,6 +140,9 @@ TOX_METHOD (jbyteArray, Iterate,
   return instances.with_instance (env, instanceNumber,
     [=] (ToxAV *av, Events &events) -> jbyteArray
       {
+        // Java has dispatched the previous iteration's frames by now.
+        events.frames.release_all ();
+
         LogEntry log_entry (instanceNumber, toxav_iterate, av);
 
 #if 0
@@ -32,18 +150,613 @@ TOX_METHOD (jbyteArray, Iterate,
 #else
         log_entry.print_result (toxav_iterate, av);
 #endif
-        if (events.ByteSize () == 0)
+        if (!events.mixers.empty ())
+          {
+            auto const now = std::chrono::steady_clock::now ();
+            for (auto &entry : events.mixers)
+              {
+                AudioMixer &mixer = entry.second;
+                std::size_t sample_count = mixer.sample_count;
+                uint8_t channels = mixer.channels;
+                uint32_t sampling_rate = mixer.sampling_rate;
+                mixer.mix (now,
+                  [&] (uint32_t friend_number, int16_t const *pcm)
+                    {
+                      // A participant whose call is not up yet just misses the frame.
+                      counted_send (env, instanceNumber, av, events,
+                        &FriendStats::audio_sent, pcm_bytes (sample_count, channels),
+                        toxav_audio_send_frame_mixed, friend_number, pcm, sample_count, channels, sampling_rate
+                      );
+                    }
+                );
+              }
+          }
+
+        if (!events.bit_rate_control.empty ())
+          control_bit_rates (instanceNumber, av, events);
+
+        // Counters of deleted friends would otherwise carry over to a friend
+        // later added with the same number.
+        if (!events.stats.empty ())
+          toxav_prune_stats (toxav_get_tox (av), events);
+
+        if (events.pending.ByteSize () == 0)
           return nullptr;
 
-        std::vector<char> buffer (events.ByteSize ());
-        events.SerializeToArray (buffer.data (), buffer.size ());
-        events.Clear ();
+        std::vector<char> buffer (events.pending.ByteSize ());
+        events.pending.SerializeToArray (buffer.data (), buffer.size ());
+        events.pending.Clear ();
+
+        return toJavaArray (env, buffer);
+      }
+  );
+}
+
+void
+toxav_set_video_frame_pool (Events &events, std::vector<FramePool::Slot> slots)
+{
+  // Frames waiting in a mailbox may be in the old buffers.
+  for (auto &mailbox : events.video_mailboxes)
+    mailbox.second.clear (events.frames);
+  events.frames.slots = std::move (slots);
+}
+
+/*
+ * Class:     im_tox_tox4j_impl_ToxAvJni
+ * Method:    toxavSetVideoFramePool
+ * Signature: (I[Ljava/nio/ByteBuffer;)V
+ */
+TOX_METHOD (void, SetVideoFramePool,
+  jint instanceNumber, jobjectArray buffers)
+{
+  std::vector<FramePool::Slot> slots;
+  if (buffers != nullptr)
+    {
+      jsize const count = env->GetArrayLength (buffers);
+      for (jsize i = 0; i < count; i++)
+        {
+          jobject buffer = env->GetObjectArrayElement (buffers, i);
+          auto *data = buffer ? static_cast<uint8_t *> (env->GetDirectBufferAddress (buffer)) : nullptr;
+          jlong capacity = data ? env->GetDirectBufferCapacity (buffer) : 0;
+          env->DeleteLocalRef (buffer);
+
+          if (data == nullptr)
+            return throw_illegal_argument_exception (env, instanceNumber, "Frame pool buffers must be direct ByteBuffers");
+          slots.push_back ({ data, std::size_t (capacity), false, false });
+        }
+    }
+
+  return instances.with_instance (env, instanceNumber,
+    [&] (ToxAV *av, Events &events)
+      {
+        assert (av != nullptr);
+        toxav_set_video_frame_pool (events, std::move (slots));
+      }
+  );
+}
+
+void
+toxav_set_video_format (Events &events, proto::VideoFormat format)
+{
+  events.video_format = format;
+}
+
+/*
+ * Class:     im_tox_tox4j_impl_ToxAvJni
+ * Method:    toxavSetVideoFormat
+ * Signature: (II)V
+ */
+TOX_METHOD (void, SetVideoFormat,
+  jint instanceNumber, jint format)
+{
+  if (!proto::VideoFormat_IsValid (format))
+    return throw_illegal_argument_exception (env, instanceNumber, "Invalid video format");
+
+  return instances.with_instance (env, instanceNumber,
+    [=] (ToxAV *av, Events &events)
+      {
+        assert (av != nullptr);
+        toxav_set_video_format (events, proto::VideoFormat (format));
+      }
+  );
+}
+
+void
+toxav_set_audio_metering (Events &events, proto::AudioMetering metering)
+{
+  events.audio_metering = metering;
+}
+
+/*
+ * Class:     im_tox_tox4j_impl_ToxAvJni
+ * Method:    toxavSetAudioMetering
+ * Signature: (II)V
+ */
+TOX_METHOD (void, SetAudioMetering,
+  jint instanceNumber, jint metering)
+{
+  if (!proto::AudioMetering_IsValid (metering))
+    return throw_illegal_argument_exception (env, instanceNumber, "Invalid audio metering mode");
+
+  return instances.with_instance (env, instanceNumber,
+    [=] (ToxAV *av, Events &events)
+      {
+        assert (av != nullptr);
+        toxav_set_audio_metering (events, proto::AudioMetering (metering));
+      }
+  );
+}
+
+void
+toxav_set_video_receive_options (Events &events, uint32_t friend_number, FriendVideo options)
+{
+  FriendVideo &video = events.friend_video[friend_number];
+  options.mailbox = video.mailbox;
+  video = options;
+  if (video.unlimited ())
+    events.friend_video.erase (friend_number);
+}
+
+/*
+ * Class:     im_tox_tox4j_impl_ToxAvJni
+ * Method:    toxavSetVideoReceiveOptions
+ * Signature: (IIIII)V
+ */
+TOX_METHOD (void, SetVideoReceiveOptions,
+  jint instanceNumber, jint friendNumber, jint maxWidth, jint maxHeight, jint maxFps)
+{
+  if (maxWidth < 0 || maxWidth > UINT16_MAX || maxHeight < 0 || maxHeight > UINT16_MAX || maxFps < 0)
+    return throw_illegal_argument_exception (env, instanceNumber, "Invalid video receive options");
+
+  FriendVideo options;
+  options.max_width = maxWidth;
+  options.max_height = maxHeight;
+  if (maxFps != 0)
+    options.min_interval = std::chrono::duration_cast<std::chrono::steady_clock::duration> (std::chrono::seconds (1)) / maxFps;
+
+  return instances.with_instance (env, instanceNumber,
+    [=] (ToxAV *av, Events &events)
+      {
+        assert (av != nullptr);
+        toxav_set_video_receive_options (events, friendNumber, options);
+      }
+  );
+}
+
+void
+toxav_set_video_mailbox (Events &events, uint32_t friend_number, bool enabled)
+{
+  FriendVideo &video = events.friend_video[friend_number];
+  video.mailbox = enabled;
+  if (video.unlimited ())
+    events.friend_video.erase (friend_number);
+
+  if (!enabled)
+    {
+      auto found = events.video_mailboxes.find (friend_number);
+      if (found != events.video_mailboxes.end ())
+        {
+          found->second.clear (events.frames);
+          events.video_mailboxes.erase (found);
+        }
+    }
+}
+
+/*
+ * Class:     im_tox_tox4j_impl_ToxAvJni
+ * Method:    toxavSetVideoMailbox
+ * Signature: (IIZ)V
+ */
+TOX_METHOD (void, SetVideoMailbox,
+  jint instanceNumber, jint friendNumber, jboolean enabled)
+{
+  return instances.with_instance (env, instanceNumber,
+    [=] (ToxAV *av, Events &events)
+      {
+        assert (av != nullptr);
+        toxav_set_video_mailbox (events, friendNumber, enabled);
+      }
+  );
+}
+
+bool
+toxav_take_video_frame (Events &events, uint32_t friend_number, proto::AvEvents &taken)
+{
+  auto found = events.video_mailboxes.find (friend_number);
+  if (found == events.video_mailboxes.end ())
+    return false;
+  return found->second.take (events.frames, taken);
+}
+
+/*
+ * Class:     im_tox_tox4j_impl_ToxAvJni
+ * Method:    toxavTakeVideoFrame
+ * Signature: (II)[B
+ */
+TOX_METHOD (jbyteArray, TakeVideoFrame,
+  jint instanceNumber, jint friendNumber)
+{
+  return instances.with_instance (env, instanceNumber,
+    [=] (ToxAV *av, Events &events) -> jbyteArray
+      {
+        assert (av != nullptr);
+        proto::AvEvents taken;
+        if (!toxav_take_video_frame (events, friendNumber, taken))
+          return nullptr;
+
+        std::vector<char> buffer (taken.ByteSize ());
+        taken.SerializeToArray (buffer.data (), buffer.size ());
+        return toJavaArray (env, buffer);
+      }
+  );
+}
+
+void
+toxav_set_audio_receive_format (Events &events, uint32_t sampling_rate, uint8_t channels)
+{
+  events.audio_sampling_rate = sampling_rate;
+  events.audio_channels = channels;
+  events.receive_resamplers.clear ();
+}
+
+/**
+ * Whether audio received at any Opus rate can be resampled to this rate.
+ */
+static bool
+resamplable_from_opus (jint samplingRate)
+{
+  for (uint32_t opus_rate : { 8000, 12000, 16000, 24000, 48000 })
+    if (!resampler::polyphase::supported (opus_rate, samplingRate))
+      return false;
+  return true;
+}
+
+/*
+ * Class:     im_tox_tox4j_impl_ToxAvJni
+ * Method:    toxavSetAudioReceiveFormat
+ * Signature: (III)V
+ */
+TOX_METHOD (void, SetAudioReceiveFormat,
+  jint instanceNumber, jint samplingRate, jint channels)
+{
+  bool const disabled = samplingRate == 0 && channels == 0;
+  if (!disabled && (!resamplable_from_opus (samplingRate) || channels < 1 || channels > 2))
+    return throw_illegal_argument_exception (env, instanceNumber, "Invalid audio receive format");
+
+  return instances.with_instance (env, instanceNumber,
+    [=] (ToxAV *av, Events &events)
+      {
+        assert (av != nullptr);
+        toxav_set_audio_receive_format (events, samplingRate, channels);
+      }
+  );
+}
+
+void
+toxav_set_voice_activity_detection (Events &events, int threshold_dbfs, uint32_t hangover_ms, bool send, bool receive)
+{
+  for (VoiceActivity *voice : { &events.send_voice, &events.receive_voice })
+    {
+      voice->enabled = voice == &events.send_voice ? send : receive;
+      voice->threshold_dbfs = threshold_dbfs;
+      voice->hangover_ms = hangover_ms;
+      voice->friends.clear ();
+    }
+}
+
+/*
+ * Class:     im_tox_tox4j_impl_ToxAvJni
+ * Method:    toxavSetVoiceActivityDetection
+ * Signature: (IIIZZ)V
+ */
+TOX_METHOD (void, SetVoiceActivityDetection,
+  jint instanceNumber, jint thresholdDbfs, jint hangoverMs, jboolean send, jboolean receive)
+{
+  if (thresholdDbfs > 0 || thresholdDbfs < -96 || hangoverMs < 0)
+    return throw_illegal_argument_exception (env, instanceNumber, "Invalid voice activity detection settings");
+
+  return instances.with_instance (env, instanceNumber,
+    [=] (ToxAV *av, Events &events)
+      {
+        assert (av != nullptr);
+        toxav_set_voice_activity_detection (events, thresholdDbfs, hangoverMs, send, receive);
+      }
+  );
+}
+
+void
+toxav_set_video_dedup (Events &events, bool enabled, std::chrono::steady_clock::duration keep_alive)
+{
+  events.video_dedup.enabled = enabled;
+  events.video_dedup.keep_alive = keep_alive;
+  events.video_dedup.friends.clear ();
+}
+
+/*
+ * Class:     im_tox_tox4j_impl_ToxAvJni
+ * Method:    toxavSetVideoDedup
+ * Signature: (IZI)V
+ */
+TOX_METHOD (void, SetVideoDedup,
+  jint instanceNumber, jboolean enabled, jint keepAliveMs)
+{
+  if (keepAliveMs < 0)
+    return throw_illegal_argument_exception (env, instanceNumber, "Invalid keep-alive interval");
+
+  return instances.with_instance (env, instanceNumber,
+    [=] (ToxAV *av, Events &events)
+      {
+        assert (av != nullptr);
+        toxav_set_video_dedup (events, enabled, std::chrono::milliseconds (keepAliveMs));
+      }
+  );
+}
+
+void
+toxav_set_video_pacing (Events &events, int32_t instance_number, ToxAV *av, uint32_t friend_number, uint32_t max_fps, std::size_t depth, uint32_t bit_rate)
+{
+  if (!events.video_pacer)
+    {
+      if (max_fps == 0)
+        return;
+      events.video_pacer.reset (new VideoPacer (instance_number, av));
+    }
+  events.video_pacer->configure (friend_number, max_fps, depth, bit_rate);
+}
+
+/*
+ * Class:     im_tox_tox4j_impl_ToxAvJni
+ * Method:    toxavSetVideoPacing
+ * Signature: (IIIII)V
+ */
+TOX_METHOD (void, SetVideoPacing,
+  jint instanceNumber, jint friendNumber, jint maxFps, jint queueDepth, jint videoBitRate)
+{
+  if (maxFps < 0 || maxFps > 1000 || (maxFps != 0 && queueDepth < 1) || videoBitRate < 0)
+    return throw_illegal_argument_exception (env, instanceNumber, "Invalid video pacing settings");
+
+  return instances.with_instance (env, instanceNumber,
+    [=] (ToxAV *av, Events &events)
+      {
+        toxav_set_video_pacing (events, instanceNumber, av, friendNumber, maxFps, queueDepth, videoBitRate);
+      }
+  );
+}
+
+void
+toxav_set_bit_rate_control (Events &events, uint32_t friend_number, BitRateController::Range audio, BitRateController::Range video, std::chrono::steady_clock::duration hold)
+{
+  events.bit_rate_control.erase (friend_number);
+  if (audio.max != 0 || video.max != 0)
+    events.bit_rate_control.emplace (friend_number, BitRateController (audio, video, hold));
+}
+
+/*
+ * Class:     im_tox_tox4j_impl_ToxAvJni
+ * Method:    toxavSetBitRateControl
+ * Signature: (IIIIIII)V
+ */
+TOX_METHOD (void, SetBitRateControl,
+  jint instanceNumber, jint friendNumber, jint audioMin, jint audioMax, jint videoMin, jint videoMax, jint holdMs)
+{
+  if (audioMin < 0 || audioMin > audioMax || videoMin < 0 || videoMin > videoMax || holdMs < 0)
+    return throw_illegal_argument_exception (env, instanceNumber, "Invalid bit rate control settings");
+
+  return instances.with_instance (env, instanceNumber,
+    [=] (ToxAV *av, Events &events)
+      {
+        assert (av != nullptr);
+        toxav_set_bit_rate_control (events, friendNumber,
+          BitRateController::Range { uint32_t (audioMin), uint32_t (audioMax) },
+          BitRateController::Range { uint32_t (videoMin), uint32_t (videoMax) },
+          std::chrono::milliseconds (holdMs));
+      }
+  );
+}
+
+bool
+toxav_video_enqueue_frame (Events &events, uint32_t friend_number, int64_t capture_ms, uint16_t width, uint16_t height, uint8_t const *y, uint8_t const *u, uint8_t const *v)
+{
+  return events.video_pacer
+      && events.video_pacer->enqueue (friend_number, capture_ms, width, height, y, u, v);
+}
+
+/*
+ * Class:     im_tox_tox4j_impl_ToxAvJni
+ * Method:    toxavVideoEnqueueFrame
+ * Signature: (IIJII[B[B[B)V
+ */
+TOX_METHOD (void, VideoEnqueueFrame,
+  jint instanceNumber, jint friendNumber, jlong captureTimeMs, jint width, jint height, jbyteArray y, jbyteArray u, jbyteArray v)
+{
+  if (width <= 0 || height <= 0 || width > UINT16_MAX || height > UINT16_MAX)
+    return throw_tox_exception<ToxAV> (env, TOXAV_ERR_SEND_FRAME_INVALID);
+
+  size_t ySize = size_t (width) * height;
+  size_t uvSize = size_t (width / 2) * (height / 2);
+
+  auto yData = fromJavaArray (env, y);
+  auto uData = fromJavaArray (env, u);
+  auto vData = fromJavaArray (env, v);
+  if (yData.size () != ySize ||
+      uData.size () != uvSize ||
+      vData.size () != uvSize)
+    return throw_tox_exception<ToxAV> (env, TOXAV_ERR_SEND_FRAME_INVALID);
+
+  return instances.with_instance (env, instanceNumber,
+    [&] (ToxAV *av, Events &events)
+      {
+        assert (av != nullptr);
+        if (!toxav_video_enqueue_frame (events, friendNumber, captureTimeMs, width, height, yData.data (), uData.data (), vData.data ()))
+          return throw_illegal_argument_exception (env, instanceNumber, "Video pacing is not set up for this friend");
+        events.stats[friendNumber].sent_resolution.update (width, height);
+      }
+  );
+}
+
+static void
+set_counters (proto::SendCounters *counters, SendStats const &stats)
+{
+  counters->set_frames (stats.frames);
+  counters->set_bytes (stats.bytes);
+  counters->set_send_nanos (std::chrono::duration_cast<std::chrono::nanoseconds> (stats.send_time).count ());
+  counters->set_max_send_nanos (std::chrono::duration_cast<std::chrono::nanoseconds> (stats.max_send_time).count ());
+  for (auto const &failure : stats.failures)
+    {
+      ErrorHandling const result = handle_error_enum<TOXAV_ERR_SEND_FRAME> (failure.first);
+      char const *name = result.result == ErrorHandling::FAILURE ? result.error : "UNKNOWN";
+      (*counters->mutable_failures ())[name] += failure.second;
+    }
+}
+
+static void
+set_counters (proto::ReceiveCounters *counters, ReceiveStats const &stats)
+{
+  counters->set_frames (stats.frames);
+  counters->set_bytes (stats.bytes);
+  counters->set_interval_ms (stats.interval_ms);
+  counters->set_arrival_jitter_ms (stats.arrival_jitter_ms);
+}
+
+void
+toxav_prune_stats (Tox const *tox, Events &events)
+{
+  for (auto it = events.stats.begin (); it != events.stats.end (); )
+    {
+      if (tox_friend_exists (tox, it->first))
+        ++it;
+      else
+        it = events.stats.erase (it);
+    }
+}
+
+proto::AvStats
+toxav_get_stats (ToxAV *av, Events &events)
+{
+  if (events.video_pacer)
+    events.video_pacer->take_stats (events.stats);
+  toxav_prune_stats (toxav_get_tox (av), events);
+
+  proto::AvStats snapshot;
+  for (auto const &entry : events.stats)
+    {
+      FriendStats const &stats = entry.second;
+      proto::FriendStats *friend_stats = snapshot.add_friends ();
+      friend_stats->set_friend_number (entry.first);
+      set_counters (friend_stats->mutable_audio_sent (), stats.audio_sent);
+      set_counters (friend_stats->mutable_video_sent (), stats.video_sent);
+      set_counters (friend_stats->mutable_audio_received (), stats.audio_received);
+      set_counters (friend_stats->mutable_video_received (), stats.video_received);
+      friend_stats->set_sent_resolution_changes (stats.sent_resolution.changes);
+      friend_stats->set_received_resolution_changes (stats.received_resolution.changes);
+      friend_stats->set_video_frames_skipped (events.video_dedup.skipped (entry.first));
+    }
+  return snapshot;
+}
+
+/*
+ * Class:     im_tox_tox4j_impl_ToxAvJni
+ * Method:    toxavGetStats
+ * Signature: (I)[B
+ */
+TOX_METHOD (jbyteArray, GetStats,
+  jint instanceNumber)
+{
+  return instances.with_instance (env, instanceNumber,
+    [=] (ToxAV *av, Events &events) -> jbyteArray
+      {
+        assert (av != nullptr);
+        proto::AvStats const snapshot = toxav_get_stats (av, events);
 
+        std::vector<char> buffer (snapshot.ByteSize ());
+        snapshot.SerializeToArray (buffer.data (), buffer.size ());
         return toJavaArray (env, buffer);
       }
   );
 }
 
+uint64_t
+toxav_get_video_frames_skipped (Events const &events, uint32_t friend_number)
+{
+  return events.video_dedup.skipped (friend_number);
+}
+
+/*
+ * Class:     im_tox_tox4j_impl_ToxAvJni
+ * Method:    toxavGetVideoFramesSkipped
+ * Signature: (II)J
+ */
+TOX_METHOD (jlong, GetVideoFramesSkipped,
+  jint instanceNumber, jint friendNumber)
+{
+  return instances.with_instance (env, instanceNumber,
+    [=] (ToxAV *av, Events &events) -> jlong
+      {
+        assert (av != nullptr);
+        return toxav_get_video_frames_skipped (events, friendNumber);
+      }
+  );
+}
+
+void
+toxav_set_audio_mixer (Events &events, int32_t mixer_number, std::vector<uint32_t> const &friend_numbers, std::size_t sample_count, uint8_t channels, uint32_t sampling_rate, std::size_t jitter_frames)
+{
+  if (friend_numbers.empty ())
+    {
+      events.mixers.erase (mixer_number);
+      return;
+    }
+
+  auto found = events.mixers.find (mixer_number);
+  if (found != events.mixers.end ()
+      && (found->second.sample_count != sample_count
+          || found->second.channels != channels
+          || found->second.sampling_rate != sampling_rate
+          || found->second.jitter_frames != jitter_frames))
+    {
+      events.mixers.erase (found);
+      found = events.mixers.end ();
+    }
+
+  if (found == events.mixers.end ())
+    found = events.mixers.emplace (mixer_number, AudioMixer (sample_count, channels, sampling_rate, jitter_frames)).first;
+  found->second.set_participants (friend_numbers);
+}
+
+/*
+ * Class:     im_tox_tox4j_impl_ToxAvJni
+ * Method:    toxavSetAudioMixer
+ * Signature: (II[IIIII)V
+ */
+TOX_METHOD (void, SetAudioMixer,
+  jint instanceNumber, jint mixerNumber, jintArray friendNumbers, jint sampleCount, jint channels, jint samplingRate, jint jitterFrames)
+{
+  if (sampleCount <= 0 || channels < 1 || channels > 2 || !resamplable_from_opus (samplingRate) || jitterFrames < 1
+      || jlong (sampleCount) * 1000 > jlong (samplingRate) * 120)
+    return throw_illegal_argument_exception (env, instanceNumber, "Invalid audio mixer format");
+
+  auto friendArray = fromJavaArray (env, friendNumbers);
+  std::vector<uint32_t> friends (friendArray.begin (), friendArray.end ());
+  std::vector<uint32_t> sorted (friends);
+  std::sort (sorted.begin (), sorted.end ());
+  if (std::adjacent_find (sorted.begin (), sorted.end ()) != sorted.end ())
+    return throw_illegal_argument_exception (env, instanceNumber, "Duplicate friend in audio mixer");
+
+  return instances.with_instance (env, instanceNumber,
+    [&] (ToxAV *av, Events &events)
+      {
+        assert (av != nullptr);
+        for (auto const &mixer : events.mixers)
+          if (mixer.first != mixerNumber)
+            for (auto const &participant : mixer.second.participants)
+              if (std::find (friends.begin (), friends.end (), participant.friend_number) != friends.end ())
+                return throw_illegal_argument_exception (env, instanceNumber, "Friend is already in another audio mixer");
+
+        toxav_set_audio_mixer (events, mixerNumber, friends, sampleCount, channels, samplingRate, jitterFrames);
+      }
+  );
+}
+
 /*
  * Class:     im_tox_tox4j_impl_ToxAvJni
  * Method:    toxavCall
@@ -96,6 +809,84 @@ TOX_METHOD (void, BitRateSet,
   );
 }
 
+static bool
+opus_sampling_rate (jint samplingRate)
+{
+  switch (samplingRate)
+    {
+    case 8000:
+    case 12000:
+    case 16000:
+    case 24000:
+    case 48000:
+      return true;
+    }
+  return false;
+}
+
+bool
+toxav_audio_send_frame_resampled (ToxAV *av, uint32_t friend_number, int16_t const *pcm, size_t sample_count, uint8_t channels, uint32_t sampling_rate, TOXAV_ERR_SEND_FRAME *error)
+{
+  return toxav_audio_send_frame (av, friend_number, pcm, sample_count, channels, sampling_rate, error);
+}
+
+/**
+ * Send an audio frame, unless voice activity detection finds it silent. A
+ * skipped frame counts as sent.
+ */
+template<typename SendFunc, typename Pcm>
+static void
+send_voice (JNIEnv *env, jint instanceNumber, SendFunc send_func,
+            jint friendNumber, Pcm &pcmData, jint sampleCount, jint channels, jint samplingRate)
+{
+  instances.with_instance (env, instanceNumber,
+    [&] (ToxAV *av, Events &events)
+      {
+        if (!events.send_voice.voice (friendNumber, pcmData.data (), sampleCount, channels, samplingRate))
+          return;
+
+        TOXAV_ERR_SEND_FRAME const error = counted_send (env, instanceNumber, av, events,
+          &FriendStats::audio_sent, pcm_bytes (sampleCount, channels),
+          send_func, friendNumber, pcmData, sampleCount, channels, samplingRate
+        );
+        if (error != TOXAV_ERR_SEND_FRAME_OK)
+          throw_tox_exception<ToxAV> (env, error);
+      }
+  );
+}
+
+/**
+ * Convert a frame to 48 kHz and send all complete frames of the same
+ * duration that are queued for the friend.
+ */
+static void
+send_resampled (JNIEnv *env, jint instanceNumber, ToxAV *av, Events &events,
+                uint32_t friend_number, int16_t const *pcm, std::size_t sample_count, uint8_t channels, uint32_t sampling_rate)
+{
+  uint32_t const output_rate = 48000;
+  std::size_t const frame_samples = (sample_count * output_rate + sampling_rate / 2) / sampling_rate;
+  std::size_t const frame_size = frame_samples * channels;
+
+  ResampledSend &send = events.resampled_send;
+  std::vector<int16_t> &queue = send.queues[friend_number];
+  resampler_for (send.resamplers, friend_number, sampling_rate, channels, output_rate, channels)
+    .process (pcm, sample_count, queue);
+
+  std::size_t sent = 0;
+  while (frame_size != 0 && queue.size () - sent >= frame_size && !env->ExceptionCheck ())
+    {
+      int16_t const *frame = queue.data () + sent;
+      TOXAV_ERR_SEND_FRAME const error = counted_send (env, instanceNumber, av, events,
+        &FriendStats::audio_sent, frame_size * sizeof (int16_t),
+        toxav_audio_send_frame_resampled, friend_number, frame, frame_samples, channels, output_rate
+      );
+      if (error != TOXAV_ERR_SEND_FRAME_OK)
+        throw_tox_exception<ToxAV> (env, error);
+      sent += frame_size;
+    }
+  queue.erase (queue.begin (), queue.begin () + sent);
+}
+
 /*
  * Class:     im_tox_tox4j_impl_ToxAvJni
  * Method:    toxavAudioSendFrame
@@ -113,11 +904,220 @@ TOX_METHOD (void, AudioSendFrame,
   if (pcmData.size () != size_t (sampleCount * channels))
     return throw_tox_exception<ToxAV> (env, TOXAV_ERR_SEND_FRAME_INVALID);
 
-  return instances.with_instance_ign (env, instanceNumber,
+  if (!opus_sampling_rate (samplingRate))
+    {
+      if (channels < 1 || channels > 2 || !resampler::polyphase::supported (samplingRate, 48000))
+        return throw_tox_exception<ToxAV> (env, TOXAV_ERR_SEND_FRAME_INVALID);
+      return instances.with_instance (env, instanceNumber,
+        [&] (ToxAV *av, Events &events)
+          {
+            if (!events.send_voice.voice (friendNumber, pcmData.data (), sampleCount, channels, samplingRate))
+              return;
+            send_resampled (env, instanceNumber, av, events,
+                            friendNumber, pcmData.data (), sampleCount, channels, samplingRate);
+          }
+      );
+    }
+
+  return send_voice (env, instanceNumber,
     toxav_audio_send_frame, friendNumber, pcmData, sampleCount, channels, samplingRate
   );
 }
 
+bool
+toxav_audio_send_frame_direct (ToxAV *av, uint32_t friend_number, int16_t const *pcm, size_t sample_count, uint8_t channels, uint32_t sampling_rate, TOXAV_ERR_SEND_FRAME *error)
+{
+  return toxav_audio_send_frame (av, friend_number, pcm, sample_count, channels, sampling_rate, error);
+}
+
+/*
+ * Class:     im_tox_tox4j_impl_ToxAvJni
+ * Method:    toxavAudioSendFrameDirect
+ * Signature: (IILjava/nio/ByteBuffer;IIII)V
+ */
+TOX_METHOD (void, AudioSendFrameDirect,
+  jint instanceNumber, jint friendNumber, jobject pcm, jint offset, jint sampleCount, jint channels, jint samplingRate)
+{
+  if (sampleCount < 0 || channels < 0 || channels > 255 || samplingRate < 0)
+    return throw_tox_exception<ToxAV> (env, TOXAV_ERR_SEND_FRAME_INVALID);
+
+  // The samples are read as native-endian shorts straight from the buffer.
+  auto pcmData = fromDirectBuffer<int16_t> (env, pcm, offset, jlong (sampleCount) * channels);
+  if (!pcmData)
+    return throw_illegal_argument_exception (env, instanceNumber, "Invalid direct buffer region");
+
+  return send_voice (env, instanceNumber,
+    toxav_audio_send_frame_direct, friendNumber, pcmData, sampleCount, channels, samplingRate
+  );
+}
+
+bool
+toxav_audio_send_frame_no_throw (ToxAV *av, uint32_t friend_number, int16_t const *pcm, size_t sample_count, uint8_t channels, uint32_t sampling_rate, TOXAV_ERR_SEND_FRAME *error)
+{
+  return toxav_audio_send_frame (av, friend_number, pcm, sample_count, channels, sampling_rate, error);
+}
+
+/*
+ * Class:     im_tox_tox4j_impl_ToxAvJni
+ * Method:    toxavAudioSendFrameNoThrow
+ * Signature: (II[SIII)J
+ */
+TOX_METHOD (jlong, AudioSendFrameNoThrow,
+  jint instanceNumber, jint friendNumber, jshortArray pcm, jint sampleCount, jint channels, jint samplingRate)
+{
+  tox4j_assert (sampleCount >= 0);
+  tox4j_assert (channels >= 0);
+  tox4j_assert (channels <= 255);
+  tox4j_assert (samplingRate >= 0);
+
+  auto pcmData = fromJavaArray (env, pcm);
+  if (pcmData.size () != size_t (sampleCount * channels))
+    return error_code_result<ToxAV> (env, TOXAV_ERR_SEND_FRAME_INVALID, "INVALID");
+
+  return instances.with_instance (env, instanceNumber,
+    [&] (ToxAV *av, Events &events) -> jlong
+      {
+        if (!events.send_voice.voice (friendNumber, pcmData.data (), sampleCount, channels, samplingRate))
+          return 0;
+
+        return send_result_code (env, counted_send (env, instanceNumber, av, events,
+          &FriendStats::audio_sent, pcm_bytes (sampleCount, channels),
+          toxav_audio_send_frame_no_throw, friendNumber, pcmData, sampleCount, channels, samplingRate
+        ));
+      }
+  );
+}
+
+/**
+ * Send one frame to each friend in turn under a single instance lock. The
+ * result holds a send_result_code per friend, so one friend's failure
+ * does not stop the others from getting the frame. Friends for whom
+ * should_send returns false are skipped with a success result, and sent is
+ * called for those who got the frame.
+ */
+template<typename ShouldSend, typename Sent, typename SendFunc, typename ...Args>
+static jintArray
+send_frame_many (JNIEnv *env, jint instanceNumber, jintArray friendNumbers, ShouldSend should_send, Sent sent,
+                 SendStats FriendStats::*stats, std::size_t bytes, SendFunc send_func, Args &...args)
+{
+  auto friends = fromJavaArray (env, friendNumbers);
+  std::vector<jint> codes (friends.size ());
+
+  instances.with_instance (env, instanceNumber,
+    [&] (ToxAV *av, Events &events)
+      {
+        for (std::size_t i = 0; i < friends.size () && !env->ExceptionCheck (); i++)
+          {
+            uint32_t const friend_number = friends.data ()[i];
+            if (!should_send (events, friend_number))
+              continue;
+
+            TOXAV_ERR_SEND_FRAME const error = counted_send (env, instanceNumber, av, events,
+              stats, bytes, send_func, friend_number, args...
+            );
+            codes[i] = send_result_code (env, error);
+            if (error == TOXAV_ERR_SEND_FRAME_OK)
+              sent (events, friend_number);
+          }
+      }
+  );
+
+  if (env->ExceptionCheck ())
+    return nullptr;
+  return toJavaArray (env, codes);
+}
+
+bool
+toxav_audio_send_frame_many (ToxAV *av, uint32_t friend_number, int16_t const *pcm, size_t sample_count, uint8_t channels, uint32_t sampling_rate, TOXAV_ERR_SEND_FRAME *error)
+{
+  return toxav_audio_send_frame (av, friend_number, pcm, sample_count, channels, sampling_rate, error);
+}
+
+/*
+ * Class:     im_tox_tox4j_impl_ToxAvJni
+ * Method:    toxavAudioSendFrameMany
+ * Signature: (I[I[SIII)[I
+ */
+TOX_METHOD (jintArray, AudioSendFrameMany,
+  jint instanceNumber, jintArray friendNumbers, jshortArray pcm, jint sampleCount, jint channels, jint samplingRate)
+{
+  tox4j_assert (sampleCount >= 0);
+  tox4j_assert (channels >= 0);
+  tox4j_assert (channels <= 255);
+  tox4j_assert (samplingRate >= 0);
+
+  // The samples are read from Java once, however many friends receive them.
+  auto pcmData = fromJavaArray (env, pcm);
+  if (pcmData.size () != size_t (sampleCount * channels))
+    {
+      std::vector<jint> codes (env->GetArrayLength (friendNumbers),
+        jint (error_code_result<ToxAV> (env, TOXAV_ERR_SEND_FRAME_INVALID, "INVALID")));
+      return toJavaArray (env, codes);
+    }
+
+  auto const voice = [&] (Events &events, uint32_t friend_number)
+    {
+      return events.send_voice.voice (friend_number, pcmData.data (), sampleCount, channels, samplingRate);
+    };
+
+  return send_frame_many (env, instanceNumber, friendNumbers, voice,
+    [] (Events &, uint32_t) { },
+    &FriendStats::audio_sent, pcm_bytes (sampleCount, channels),
+    toxav_audio_send_frame_many, pcmData, sampleCount, channels, samplingRate
+  );
+}
+
+static uint8_t const *
+plane_data (uint8_t const *plane)
+{
+  return plane;
+}
+
+template<typename Plane>
+static uint8_t const *
+plane_data (Plane const &plane)
+{
+  return plane.data ();
+}
+
+/**
+ * The digest of a frame for video dedup, or 0 if dedup is disabled, in
+ * which case no frame is compared.
+ */
+template<typename Plane>
+static uint64_t
+dedup_digest (Events &events, jint width, jint height, Plane const &yData, Plane const &uData, Plane const &vData)
+{
+  if (!events.video_dedup.enabled)
+    return 0;
+  return VideoDedup::digest (width, height, plane_data (yData), plane_data (uData), plane_data (vData));
+}
+
+/**
+ * Send a video frame, unless video dedup finds it unchanged since the last
+ * frame sent to the friend. A skipped frame counts as sent.
+ */
+template<typename SendFunc, typename Plane>
+static void
+send_changed (JNIEnv *env, jint instanceNumber, ToxAV *av, Events &events, SendFunc send_func,
+              jint friendNumber, jint width, jint height, Plane &yData, Plane &uData, Plane &vData)
+{
+  auto const now = std::chrono::steady_clock::now ();
+  uint64_t const digest = dedup_digest (events, width, height, yData, uData, vData);
+  if (events.video_dedup.unchanged (friendNumber, digest, now))
+    return;
+
+  TOXAV_ERR_SEND_FRAME const error = counted_send (env, instanceNumber, av, events,
+    &FriendStats::video_sent, i420_bytes (width, height),
+    send_func, friendNumber, width, height, yData, uData, vData
+  );
+  if (error != TOXAV_ERR_SEND_FRAME_OK)
+    return throw_tox_exception<ToxAV> (env, error);
+
+  events.video_dedup.sent (friendNumber, digest, now);
+  events.stats[friendNumber].sent_resolution.update (width, height);
+}
+
 /*
  * Class:     im_tox_tox4j_impl_ToxAvJni
  * Method:    toxavVideoSendFrame
@@ -126,18 +1126,214 @@ TOX_METHOD (void, AudioSendFrame,
 TOX_METHOD (void, VideoSendFrame,
   jint instanceNumber, jint friendNumber, jint width, jint height, jbyteArray y, jbyteArray u, jbyteArray v)
 {
-  size_t ySize = width * height;
-  size_t uvSize = (width / 2) * (height / 2);
+  size_t ySize = size_t (width) * height;
+  size_t uvSize = size_t (width / 2) * (height / 2);
 
   auto yData = fromJavaArray (env, y);
   auto uData = fromJavaArray (env, u);
   auto vData = fromJavaArray (env, v);
-  if (yData.size () != ySize ||
+  if (width <= 0 || height <= 0 || width > UINT16_MAX || height > UINT16_MAX ||
+      yData.size () != ySize ||
       uData.size () != uvSize ||
       vData.size () != uvSize)
     return throw_tox_exception<ToxAV> (env, TOXAV_ERR_SEND_FRAME_INVALID);
 
-  return instances.with_instance_ign (env, instanceNumber,
-    toxav_video_send_frame, friendNumber, width, height, yData, uData, vData
+  return instances.with_instance (env, instanceNumber,
+    [&] (ToxAV *av, Events &events)
+      {
+        send_changed (env, instanceNumber, av, events,
+          toxav_video_send_frame, friendNumber, width, height, yData, uData, vData
+        );
+      }
+  );
+}
+
+bool
+toxav_video_send_frame_many (ToxAV *av, uint32_t friend_number, uint16_t width, uint16_t height, uint8_t const *y, uint8_t const *u, uint8_t const *v, TOXAV_ERR_SEND_FRAME *error)
+{
+  return toxav_video_send_frame (av, friend_number, width, height, y, u, v, error);
+}
+
+/*
+ * Class:     im_tox_tox4j_impl_ToxAvJni
+ * Method:    toxavVideoSendFrameMany
+ * Signature: (I[III[B[B[B)[I
+ */
+TOX_METHOD (jintArray, VideoSendFrameMany,
+  jint instanceNumber, jintArray friendNumbers, jint width, jint height, jbyteArray y, jbyteArray u, jbyteArray v)
+{
+  size_t ySize = size_t (width) * height;
+  size_t uvSize = size_t (width / 2) * (height / 2);
+
+  auto yData = fromJavaArray (env, y);
+  auto uData = fromJavaArray (env, u);
+  auto vData = fromJavaArray (env, v);
+  if (width <= 0 || height <= 0 || width > UINT16_MAX || height > UINT16_MAX ||
+      yData.size () != ySize ||
+      uData.size () != uvSize ||
+      vData.size () != uvSize)
+    {
+      std::vector<jint> codes (env->GetArrayLength (friendNumbers),
+        jint (error_code_result<ToxAV> (env, TOXAV_ERR_SEND_FRAME_INVALID, "INVALID")));
+      return toJavaArray (env, codes);
+    }
+
+  // The frame is hashed once, the first time a friend's dedup needs it.
+  auto const now = std::chrono::steady_clock::now ();
+  uint64_t digest = 0;
+  bool hashed = false;
+  auto const changed = [&] (Events &events, uint32_t friend_number)
+    {
+      if (!hashed)
+        {
+          digest = dedup_digest (events, width, height, yData, uData, vData);
+          hashed = true;
+        }
+      return !events.video_dedup.unchanged (friend_number, digest, now);
+    };
+  auto const sent = [&] (Events &events, uint32_t friend_number)
+    {
+      events.video_dedup.sent (friend_number, digest, now);
+      events.stats[friend_number].sent_resolution.update (width, height);
+    };
+
+  return send_frame_many (env, instanceNumber, friendNumbers, changed, sent,
+    &FriendStats::video_sent, i420_bytes (width, height),
+    toxav_video_send_frame_many, width, height, yData, uData, vData
+  );
+}
+
+bool
+toxav_video_send_frame_direct (ToxAV *av, uint32_t friend_number, uint16_t width, uint16_t height, uint8_t const *y, uint8_t const *u, uint8_t const *v, TOXAV_ERR_SEND_FRAME *error)
+{
+  return toxav_video_send_frame (av, friend_number, width, height, y, u, v, error);
+}
+
+/*
+ * Class:     im_tox_tox4j_impl_ToxAvJni
+ * Method:    toxavVideoSendFrameDirect
+ * Signature: (IIIILjava/nio/ByteBuffer;I)V
+ */
+TOX_METHOD (void, VideoSendFrameDirect,
+  jint instanceNumber, jint friendNumber, jint width, jint height, jobject yuv, jint offset)
+{
+  if (width <= 0 || height <= 0 || width > UINT16_MAX || height > UINT16_MAX)
+    return throw_tox_exception<ToxAV> (env, TOXAV_ERR_SEND_FRAME_INVALID);
+
+  jlong ySize = jlong (width) * height;
+  jlong uvSize = jlong (width / 2) * (height / 2);
+
+  // The three planes are contiguous in the buffer, in I420 order.
+  auto yData = fromDirectBuffer<uint8_t> (env, yuv, offset, ySize);
+  auto uData = fromDirectBuffer<uint8_t> (env, yuv, offset + ySize, uvSize);
+  auto vData = fromDirectBuffer<uint8_t> (env, yuv, offset + ySize + uvSize, uvSize);
+  if (!yData || !uData || !vData)
+    return throw_illegal_argument_exception (env, instanceNumber, "Invalid direct buffer region");
+
+  return instances.with_instance (env, instanceNumber,
+    [&] (ToxAV *av, Events &events)
+      {
+        send_changed (env, instanceNumber, av, events,
+          toxav_video_send_frame_direct, friendNumber, width, height, yData, uData, vData
+        );
+      }
+  );
+}
+
+bool
+toxav_video_send_frame_paced (ToxAV *av, uint32_t friend_number, uint16_t width, uint16_t height, uint8_t const *y, uint8_t const *u, uint8_t const *v, TOXAV_ERR_SEND_FRAME *error)
+{
+  return toxav_video_send_frame (av, friend_number, width, height, y, u, v, error);
+}
+
+bool
+toxav_video_send_frame_rgba (ToxAV *av, uint32_t friend_number, uint16_t width, uint16_t height, uint8_t const *y, uint8_t const *u, uint8_t const *v, TOXAV_ERR_SEND_FRAME *error)
+{
+  return toxav_video_send_frame (av, friend_number, width, height, y, u, v, error);
+}
+
+/*
+ * Class:     im_tox_tox4j_impl_ToxAvJni
+ * Method:    toxavVideoSendFrameRgba
+ * Signature: (IIIILjava/nio/ByteBuffer;I)V
+ */
+TOX_METHOD (void, VideoSendFrameRgba,
+  jint instanceNumber, jint friendNumber, jint width, jint height, jobject rgba, jint stride)
+{
+  if (width <= 0 || height <= 0 || width > UINT16_MAX || height > UINT16_MAX || stride < jlong (width) * 4)
+    return throw_tox_exception<ToxAV> (env, TOXAV_ERR_SEND_FRAME_INVALID);
+
+  // The last row does not need to be padded to the full stride.
+  auto pixels = fromDirectBuffer<uint8_t> (env, rgba, 0, jlong (stride) * (height - 1) + jlong (width) * 4);
+  if (!pixels)
+    return throw_illegal_argument_exception (env, instanceNumber, "Invalid direct buffer region");
+
+  return instances.with_instance (env, instanceNumber,
+    [&] (ToxAV *av, Events &events)
+      {
+        std::size_t const ySize = std::size_t (width) * height;
+        std::size_t const uvSize = std::size_t (width / 2) * (height / 2);
+        events.send_frame.resize (ySize + uvSize * 2);
+
+        uint8_t *y = events.send_frame.data ();
+        uint8_t *u = y + ySize;
+        uint8_t *v = u + uvSize;
+        yuv::pixels_to_i420 (y, u, v, pixels.data (), stride, width, height, yuv::pixel_order::RGBA);
+
+        uint8_t const *yData = y;
+        uint8_t const *uData = u;
+        uint8_t const *vData = v;
+        send_changed (env, instanceNumber, av, events,
+          toxav_video_send_frame_rgba, friendNumber, width, height, yData, uData, vData
+        );
+      }
+  );
+}
+
+bool
+toxav_video_send_frame_no_throw (ToxAV *av, uint32_t friend_number, uint16_t width, uint16_t height, uint8_t const *y, uint8_t const *u, uint8_t const *v, TOXAV_ERR_SEND_FRAME *error)
+{
+  return toxav_video_send_frame (av, friend_number, width, height, y, u, v, error);
+}
+
+/*
+ * Class:     im_tox_tox4j_impl_ToxAvJni
+ * Method:    toxavVideoSendFrameNoThrow
+ * Signature: (IIII[B[B[B)J
+ */
+TOX_METHOD (jlong, VideoSendFrameNoThrow,
+  jint instanceNumber, jint friendNumber, jint width, jint height, jbyteArray y, jbyteArray u, jbyteArray v)
+{
+  size_t ySize = size_t (width) * height;
+  size_t uvSize = size_t (width / 2) * (height / 2);
+
+  auto yData = fromJavaArray (env, y);
+  auto uData = fromJavaArray (env, u);
+  auto vData = fromJavaArray (env, v);
+  if (width <= 0 || height <= 0 || width > UINT16_MAX || height > UINT16_MAX ||
+      yData.size () != ySize ||
+      uData.size () != uvSize ||
+      vData.size () != uvSize)
+    return error_code_result<ToxAV> (env, TOXAV_ERR_SEND_FRAME_INVALID, "INVALID");
+
+  return instances.with_instance (env, instanceNumber,
+    [&] (ToxAV *av, Events &events) -> jlong
+      {
+        auto const now = std::chrono::steady_clock::now ();
+        uint64_t const digest = dedup_digest (events, width, height, yData, uData, vData);
+        if (events.video_dedup.unchanged (friendNumber, digest, now))
+          return 0;
+
+        TOXAV_ERR_SEND_FRAME const error = counted_send (env, instanceNumber, av, events,
+          &FriendStats::video_sent, i420_bytes (width, height),
+          toxav_video_send_frame_no_throw, friendNumber, width, height, yData, uData, vData
+        );
+        if (error == TOXAV_ERR_SEND_FRAME_OK)
+          {
+            events.video_dedup.sent (friendNumber, digest, now);
+            events.stats[friendNumber].sent_resolution.update (width, height);
+          }
+        return send_result_code (env, error);
+      }
   );
 }
@@ -83,3 +83,5 @@ HANDLE ("SendFrame", SEND_FRAME)
     }
   return unhandled ();
 }
+
+TOX_EXCEPTIONS (toxav_exceptions, EXCEPTION_CLASS (ANSWER), EXCEPTION_CLASS (BIT_RATE_SET), EXCEPTION_CLASS (CALL_CONTROL), EXCEPTION_CLASS (CALL), EXCEPTION_CLASS (NEW), EXCEPTION_CLASS (SEND_FRAME))
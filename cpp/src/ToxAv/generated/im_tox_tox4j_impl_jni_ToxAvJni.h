@@ -47,6 +47,118 @@ JNIEXPORT jint JNICALL Java_im_tox_tox4j_impl_jni_ToxAvJni_toxavIterationInterva
 JNIEXPORT jbyteArray JNICALL Java_im_tox_tox4j_impl_jni_ToxAvJni_toxavIterate
   (JNIEnv *, jclass, jint);
 
+/*
+ * Class:     im_tox_tox4j_impl_jni_ToxAvJni
+ * Method:    toxavSetVideoFramePool
+ * Signature: (I[Ljava/nio/ByteBuffer;)V
+ */
+JNIEXPORT void JNICALL Java_im_tox_tox4j_impl_jni_ToxAvJni_toxavSetVideoFramePool
+  (JNIEnv *, jclass, jint, jobjectArray);
+
+/*
+ * Class:     im_tox_tox4j_impl_jni_ToxAvJni
+ * Method:    toxavSetVideoFormat
+ * Signature: (II)V
+ */
+JNIEXPORT void JNICALL Java_im_tox_tox4j_impl_jni_ToxAvJni_toxavSetVideoFormat
+  (JNIEnv *, jclass, jint, jint);
+
+/*
+ * Class:     im_tox_tox4j_impl_jni_ToxAvJni
+ * Method:    toxavSetAudioMetering
+ * Signature: (II)V
+ */
+JNIEXPORT void JNICALL Java_im_tox_tox4j_impl_jni_ToxAvJni_toxavSetAudioMetering
+  (JNIEnv *, jclass, jint, jint);
+
+/*
+ * Class:     im_tox_tox4j_impl_jni_ToxAvJni
+ * Method:    toxavSetVideoReceiveOptions
+ * Signature: (IIIII)V
+ */
+JNIEXPORT void JNICALL Java_im_tox_tox4j_impl_jni_ToxAvJni_toxavSetVideoReceiveOptions
+  (JNIEnv *, jclass, jint, jint, jint, jint, jint);
+
+/*
+ * Class:     im_tox_tox4j_impl_jni_ToxAvJni
+ * Method:    toxavSetVideoMailbox
+ * Signature: (IIZ)V
+ */
+JNIEXPORT void JNICALL Java_im_tox_tox4j_impl_jni_ToxAvJni_toxavSetVideoMailbox
+  (JNIEnv *, jclass, jint, jint, jboolean);
+
+/*
+ * Class:     im_tox_tox4j_impl_jni_ToxAvJni
+ * Method:    toxavTakeVideoFrame
+ * Signature: (II)[B
+ */
+JNIEXPORT jbyteArray JNICALL Java_im_tox_tox4j_impl_jni_ToxAvJni_toxavTakeVideoFrame
+  (JNIEnv *, jclass, jint, jint);
+
+/*
+ * Class:     im_tox_tox4j_impl_jni_ToxAvJni
+ * Method:    toxavSetAudioReceiveFormat
+ * Signature: (III)V
+ */
+JNIEXPORT void JNICALL Java_im_tox_tox4j_impl_jni_ToxAvJni_toxavSetAudioReceiveFormat
+  (JNIEnv *, jclass, jint, jint, jint);
+
+/*
+ * Class:     im_tox_tox4j_impl_jni_ToxAvJni
+ * Method:    toxavSetVoiceActivityDetection
+ * Signature: (IIIZZ)V
+ */
+JNIEXPORT void JNICALL Java_im_tox_tox4j_impl_jni_ToxAvJni_toxavSetVoiceActivityDetection
+  (JNIEnv *, jclass, jint, jint, jint, jboolean, jboolean);
+
+/*
+ * Class:     im_tox_tox4j_impl_jni_ToxAvJni
+ * Method:    toxavSetVideoPacing
+ * Signature: (IIIII)V
+ */
+JNIEXPORT void JNICALL Java_im_tox_tox4j_impl_jni_ToxAvJni_toxavSetVideoPacing
+  (JNIEnv *, jclass, jint, jint, jint, jint, jint);
+
+/*
+ * Class:     im_tox_tox4j_impl_jni_ToxAvJni
+ * Method:    toxavSetBitRateControl
+ * Signature: (IIIIIII)V
+ */
+JNIEXPORT void JNICALL Java_im_tox_tox4j_impl_jni_ToxAvJni_toxavSetBitRateControl
+  (JNIEnv *, jclass, jint, jint, jint, jint, jint, jint, jint);
+
+/*
+ * Class:     im_tox_tox4j_impl_jni_ToxAvJni
+ * Method:    toxavSetVideoDedup
+ * Signature: (IZI)V
+ */
+JNIEXPORT void JNICALL Java_im_tox_tox4j_impl_jni_ToxAvJni_toxavSetVideoDedup
+  (JNIEnv *, jclass, jint, jboolean, jint);
+
+/*
+ * Class:     im_tox_tox4j_impl_jni_ToxAvJni
+ * Method:    toxavGetVideoFramesSkipped
+ * Signature: (II)J
+ */
+JNIEXPORT jlong JNICALL Java_im_tox_tox4j_impl_jni_ToxAvJni_toxavGetVideoFramesSkipped
+  (JNIEnv *, jclass, jint, jint);
+
+/*
+ * Class:     im_tox_tox4j_impl_jni_ToxAvJni
+ * Method:    toxavGetStats
+ * Signature: (I)[B
+ */
+JNIEXPORT jbyteArray JNICALL Java_im_tox_tox4j_impl_jni_ToxAvJni_toxavGetStats
+  (JNIEnv *, jclass, jint);
+
+/*
+ * Class:     im_tox_tox4j_impl_jni_ToxAvJni
+ * Method:    toxavSetAudioMixer
+ * Signature: (II[IIIII)V
+ */
+JNIEXPORT void JNICALL Java_im_tox_tox4j_impl_jni_ToxAvJni_toxavSetAudioMixer
+  (JNIEnv *, jclass, jint, jint, jintArray, jint, jint, jint, jint);
+
 /*
  * Class:     im_tox_tox4j_impl_jni_ToxAvJni
  * Method:    toxavCall
@@ -87,6 +199,30 @@ JNIEXPORT void JNICALL Java_im_tox_tox4j_impl_jni_ToxAvJni_toxavBitRateSet
 JNIEXPORT void JNICALL Java_im_tox_tox4j_impl_jni_ToxAvJni_toxavAudioSendFrame
   (JNIEnv *, jclass, jint, jint, jshortArray, jint, jint, jint);
 
+/*
+ * Class:     im_tox_tox4j_impl_jni_ToxAvJni
+ * Method:    toxavAudioSendFrameDirect
+ * Signature: (IILjava/nio/ByteBuffer;IIII)V
+ */
+JNIEXPORT void JNICALL Java_im_tox_tox4j_impl_jni_ToxAvJni_toxavAudioSendFrameDirect
+  (JNIEnv *, jclass, jint, jint, jobject, jint, jint, jint, jint);
+
+/*
+ * Class:     im_tox_tox4j_impl_jni_ToxAvJni
+ * Method:    toxavAudioSendFrameNoThrow
+ * Signature: (II[SIII)J
+ */
+JNIEXPORT jlong JNICALL Java_im_tox_tox4j_impl_jni_ToxAvJni_toxavAudioSendFrameNoThrow
+  (JNIEnv *, jclass, jint, jint, jshortArray, jint, jint, jint);
+
+/*
+ * Class:     im_tox_tox4j_impl_jni_ToxAvJni
+ * Method:    toxavAudioSendFrameMany
+ * Signature: (I[I[SIII)[I
+ */
+JNIEXPORT jintArray JNICALL Java_im_tox_tox4j_impl_jni_ToxAvJni_toxavAudioSendFrameMany
+  (JNIEnv *, jclass, jint, jintArray, jshortArray, jint, jint, jint);
+
 /*
  * Class:     im_tox_tox4j_impl_jni_ToxAvJni
  * Method:    toxavVideoSendFrame
@@ -95,6 +231,46 @@ JNIEXPORT void JNICALL Java_im_tox_tox4j_impl_jni_ToxAvJni_toxavAudioSendFrame
 JNIEXPORT void JNICALL Java_im_tox_tox4j_impl_jni_ToxAvJni_toxavVideoSendFrame
   (JNIEnv *, jclass, jint, jint, jint, jint, jbyteArray, jbyteArray, jbyteArray);
 
+/*
+ * Class:     im_tox_tox4j_impl_jni_ToxAvJni
+ * Method:    toxavVideoSendFrameDirect
+ * Signature: (IIIILjava/nio/ByteBuffer;I)V
+ */
+JNIEXPORT void JNICALL Java_im_tox_tox4j_impl_jni_ToxAvJni_toxavVideoSendFrameDirect
+  (JNIEnv *, jclass, jint, jint, jint, jint, jobject, jint);
+
+/*
+ * Class:     im_tox_tox4j_impl_jni_ToxAvJni
+ * Method:    toxavVideoSendFrameRgba
+ * Signature: (IIIILjava/nio/ByteBuffer;I)V
+ */
+JNIEXPORT void JNICALL Java_im_tox_tox4j_impl_jni_ToxAvJni_toxavVideoSendFrameRgba
+  (JNIEnv *, jclass, jint, jint, jint, jint, jobject, jint);
+
+/*
+ * Class:     im_tox_tox4j_impl_jni_ToxAvJni
+ * Method:    toxavVideoSendFrameNoThrow
+ * Signature: (IIII[B[B[B)J
+ */
+JNIEXPORT jlong JNICALL Java_im_tox_tox4j_impl_jni_ToxAvJni_toxavVideoSendFrameNoThrow
+  (JNIEnv *, jclass, jint, jint, jint, jint, jbyteArray, jbyteArray, jbyteArray);
+
+/*
+ * Class:     im_tox_tox4j_impl_jni_ToxAvJni
+ * Method:    toxavVideoSendFrameMany
+ * Signature: (I[III[B[B[B)[I
+ */
+JNIEXPORT jintArray JNICALL Java_im_tox_tox4j_impl_jni_ToxAvJni_toxavVideoSendFrameMany
+  (JNIEnv *, jclass, jint, jintArray, jint, jint, jbyteArray, jbyteArray, jbyteArray);
+
+/*
+ * Class:     im_tox_tox4j_impl_jni_ToxAvJni
+ * Method:    toxavVideoEnqueueFrame
+ * Signature: (IIJII[B[B[B)V
+ */
+JNIEXPORT void JNICALL Java_im_tox_tox4j_impl_jni_ToxAvJni_toxavVideoEnqueueFrame
+  (JNIEnv *, jclass, jint, jint, jlong, jint, jint, jbyteArray, jbyteArray, jbyteArray);
+
 /*
  * Class:     im_tox_tox4j_impl_jni_ToxAvJni
  * Method:    invokeAudioReceiveFrame
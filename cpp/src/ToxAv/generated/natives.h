@@ -3,6 +3,12 @@ JAVA_METHOD_REF (toxavAnswer)
 CXX_FUNCTION_REF (toxav_answer)
 JAVA_METHOD_REF (toxavAudioSendFrame)
 CXX_FUNCTION_REF (toxav_audio_send_frame)
+JAVA_METHOD_REF (toxavAudioSendFrameDirect)
+CXX_FUNCTION_REF (toxav_audio_send_frame_direct)
+JAVA_METHOD_REF (toxavAudioSendFrameMany)
+CXX_FUNCTION_REF (toxav_audio_send_frame_many)
+JAVA_METHOD_REF (toxavAudioSendFrameNoThrow)
+CXX_FUNCTION_REF (toxav_audio_send_frame_no_throw)
 JAVA_METHOD_REF (toxavBitRateSet)
 CXX_FUNCTION_REF (toxav_bit_rate_set)
 JAVA_METHOD_REF (toxavCall)
@@ -11,6 +17,10 @@ JAVA_METHOD_REF (toxavCallControl)
 CXX_FUNCTION_REF (toxav_call_control)
 JAVA_METHOD_REF (toxavFinalize)
 CXX_FUNCTION_REF (toxav_finalize)
+JAVA_METHOD_REF (toxavGetStats)
+CXX_FUNCTION_REF (toxav_get_stats)
+JAVA_METHOD_REF (toxavGetVideoFramesSkipped)
+CXX_FUNCTION_REF (toxav_get_video_frames_skipped)
 JAVA_METHOD_REF (toxavIterate)
 CXX_FUNCTION_REF (toxav_iterate)
 JAVA_METHOD_REF (toxavIterationInterval)
@@ -19,5 +29,39 @@ JAVA_METHOD_REF (toxavKill)
 CXX_FUNCTION_REF (toxav_kill)
 JAVA_METHOD_REF (toxavNew)
 CXX_FUNCTION_REF (toxav_new)
+JAVA_METHOD_REF (toxavSetAudioMetering)
+CXX_FUNCTION_REF (toxav_set_audio_metering)
+JAVA_METHOD_REF (toxavSetAudioMixer)
+CXX_FUNCTION_REF (toxav_set_audio_mixer)
+JAVA_METHOD_REF (toxavSetAudioReceiveFormat)
+CXX_FUNCTION_REF (toxav_set_audio_receive_format)
+JAVA_METHOD_REF (toxavSetBitRateControl)
+CXX_FUNCTION_REF (toxav_set_bit_rate_control)
+JAVA_METHOD_REF (toxavSetVideoDedup)
+CXX_FUNCTION_REF (toxav_set_video_dedup)
+JAVA_METHOD_REF (toxavSetVideoFormat)
+CXX_FUNCTION_REF (toxav_set_video_format)
+JAVA_METHOD_REF (toxavSetVideoFramePool)
+CXX_FUNCTION_REF (toxav_set_video_frame_pool)
+JAVA_METHOD_REF (toxavSetVideoMailbox)
+CXX_FUNCTION_REF (toxav_set_video_mailbox)
+JAVA_METHOD_REF (toxavSetVideoPacing)
+CXX_FUNCTION_REF (toxav_set_video_pacing)
+JAVA_METHOD_REF (toxavSetVideoReceiveOptions)
+CXX_FUNCTION_REF (toxav_set_video_receive_options)
+JAVA_METHOD_REF (toxavSetVoiceActivityDetection)
+CXX_FUNCTION_REF (toxav_set_voice_activity_detection)
+JAVA_METHOD_REF (toxavTakeVideoFrame)
+CXX_FUNCTION_REF (toxav_take_video_frame)
+JAVA_METHOD_REF (toxavVideoEnqueueFrame)
+CXX_FUNCTION_REF (toxav_video_enqueue_frame)
 JAVA_METHOD_REF (toxavVideoSendFrame)
 CXX_FUNCTION_REF (toxav_video_send_frame)
+JAVA_METHOD_REF (toxavVideoSendFrameDirect)
+CXX_FUNCTION_REF (toxav_video_send_frame_direct)
+JAVA_METHOD_REF (toxavVideoSendFrameMany)
+CXX_FUNCTION_REF (toxav_video_send_frame_many)
+JAVA_METHOD_REF (toxavVideoSendFrameNoThrow)
+CXX_FUNCTION_REF (toxav_video_send_frame_no_throw)
+JAVA_METHOD_REF (toxavVideoSendFrameRgba)
+CXX_FUNCTION_REF (toxav_video_send_frame_rgba)
@@ -0,0 +1,39 @@
+// im.tox.tox4j.impl.jni.ToxAvJni
+JNI_NATIVE (invokeAudioReceiveFrame, "(II[SII)V")
+JNI_NATIVE (invokeBitRateStatus, "(IIII)V")
+JNI_NATIVE (invokeCall, "(IIZZ)V")
+JNI_NATIVE (invokeCallState, "(III)V")
+JNI_NATIVE (invokeVideoReceiveFrame, "(IIII[B[B[BIII)V")
+JNI_NATIVE (toxavAnswer, "(IIII)V")
+JNI_NATIVE (toxavAudioSendFrame, "(II[SIII)V")
+JNI_NATIVE (toxavAudioSendFrameDirect, "(IILjava/nio/ByteBuffer;IIII)V")
+JNI_NATIVE (toxavAudioSendFrameMany, "(I[I[SIII)[I")
+JNI_NATIVE (toxavAudioSendFrameNoThrow, "(II[SIII)J")
+JNI_NATIVE (toxavBitRateSet, "(IIII)V")
+JNI_NATIVE (toxavCall, "(IIII)V")
+JNI_NATIVE (toxavCallControl, "(III)V")
+JNI_NATIVE (toxavFinalize, "(I)V")
+JNI_NATIVE (toxavGetStats, "(I)[B")
+JNI_NATIVE (toxavGetVideoFramesSkipped, "(II)J")
+JNI_NATIVE (toxavIterate, "(I)[B")
+JNI_NATIVE (toxavIterationInterval, "(I)I")
+JNI_NATIVE (toxavKill, "(I)V")
+JNI_NATIVE (toxavNew, "(I)I")
+JNI_NATIVE (toxavSetAudioMetering, "(II)V")
+JNI_NATIVE (toxavSetAudioMixer, "(II[IIIII)V")
+JNI_NATIVE (toxavSetAudioReceiveFormat, "(III)V")
+JNI_NATIVE (toxavSetBitRateControl, "(IIIIIII)V")
+JNI_NATIVE (toxavSetVideoDedup, "(IZI)V")
+JNI_NATIVE (toxavSetVideoFormat, "(II)V")
+JNI_NATIVE (toxavSetVideoFramePool, "(I[Ljava/nio/ByteBuffer;)V")
+JNI_NATIVE (toxavSetVideoMailbox, "(IIZ)V")
+JNI_NATIVE (toxavSetVideoPacing, "(IIIII)V")
+JNI_NATIVE (toxavSetVideoReceiveOptions, "(IIIII)V")
+JNI_NATIVE (toxavSetVoiceActivityDetection, "(IIIZZ)V")
+JNI_NATIVE (toxavTakeVideoFrame, "(II)[B")
+JNI_NATIVE (toxavVideoEnqueueFrame, "(IIJII[B[B[B)V")
+JNI_NATIVE (toxavVideoSendFrame, "(IIII[B[B[B)V")
+JNI_NATIVE (toxavVideoSendFrameDirect, "(IIIILjava/nio/ByteBuffer;I)V")
+JNI_NATIVE (toxavVideoSendFrameMany, "(I[III[B[B[B)[I")
+JNI_NATIVE (toxavVideoSendFrameNoThrow, "(IIII[B[B[B)J")
+JNI_NATIVE (toxavVideoSendFrameRgba, "(IIIILjava/nio/ByteBuffer;I)V")
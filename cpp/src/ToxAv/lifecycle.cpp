@@ -1,13 +1,19 @@
 #include "ToxAv.h"
 #include "../ToxCore/ToxCore.h"
 
+#include "util/yuv.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
 using namespace av;
 
 
 static void
 tox4j_call_cb (uint32_t friend_number, bool audio_enabled, bool video_enabled, Events *events)
 {
-  auto msg = events->add_call ();
+  auto msg = events->pending.add_call ();
   msg->set_friend_number (friend_number);
   msg->set_audio_enabled (audio_enabled);
   msg->set_video_enabled (video_enabled);
@@ -17,7 +23,7 @@ tox4j_call_cb (uint32_t friend_number, bool audio_enabled, bool video_enabled, E
 static void
 tox4j_call_state_cb (uint32_t friend_number, uint32_t state, Events *events)
 {
-  auto msg = events->add_call_state ();
+  auto msg = events->pending.add_call_state ();
   msg->set_friend_number (friend_number);
 
   using proto::CallState;
@@ -31,6 +37,17 @@ tox4j_call_state_cb (uint32_t friend_number, uint32_t state, Events *events)
   call_state_case (ACCEPTING_A);
   call_state_case (ACCEPTING_V);
 #undef call_state_case
+
+  // The next call starts over from the rates toxav reports for it.
+  if (state & (TOXAV_FRIEND_CALL_STATE_FINISHED | TOXAV_FRIEND_CALL_STATE_ERROR))
+    {
+      auto controller = events->bit_rate_control.find (friend_number);
+      if (controller != events->bit_rate_control.end ())
+        {
+          BitRateController &ended = controller->second;
+          ended = BitRateController (ended.audio, ended.video, ended.hold);
+        }
+    }
 }
 
 
@@ -40,10 +57,27 @@ tox4j_bit_rate_status_cb (uint32_t friend_number,
                           uint32_t video_bit_rate,
                           Events *events)
 {
-  auto msg = events->add_bit_rate_status ();
+  auto msg = events->pending.add_bit_rate_status ();
   msg->set_friend_number (friend_number);
   msg->set_audio_bit_rate (audio_bit_rate);
   msg->set_video_bit_rate (video_bit_rate);
+
+  if (events->video_pacer)
+    events->video_pacer->bit_rate_status (friend_number, video_bit_rate);
+
+  auto controller = events->bit_rate_control.find (friend_number);
+  if (controller != events->bit_rate_control.end ())
+    controller->second.suggest (audio_bit_rate, video_bit_rate);
+}
+
+
+static void
+set_levels (proto::AudioLevels *levels, int16_t const *pcm, std::size_t count)
+{
+  if (count == 0)
+    return;
+  levels->set_peak (vad::peak (pcm, count));
+  levels->set_rms (std::sqrt (double (vad::sum_of_squares (pcm, count)) / count));
 }
 
 
@@ -55,16 +89,87 @@ tox4j_audio_receive_frame_cb (uint32_t friend_number,
                               uint32_t sampling_rate,
                               Events *events)
 {
-  auto msg = events->add_audio_receive_frame ();
+  events->stats[friend_number].audio_received.record (sample_count * channels * sizeof (int16_t), std::chrono::steady_clock::now ());
+
+  for (auto &mixer : events->mixers)
+    if (mixer.second.receive (friend_number, pcm, sample_count, channels, sampling_rate))
+      return;
+
+  if (events->audio_sampling_rate != 0
+      && (sampling_rate != events->audio_sampling_rate || channels != events->audio_channels))
+    {
+      events->resampled.clear ();
+      resampler_for (events->receive_resamplers, friend_number, sampling_rate, channels,
+                     events->audio_sampling_rate, events->audio_channels)
+        .process (pcm, sample_count, events->resampled);
+
+      pcm = events->resampled.data ();
+      channels = events->audio_channels;
+      sampling_rate = events->audio_sampling_rate;
+      sample_count = events->resampled.size () / channels;
+    }
+
+  if (!events->receive_voice.voice (friend_number, pcm, sample_count, channels, sampling_rate))
+    {
+      auto silence = events->pending.add_audio_receive_silence ();
+      silence->set_friend_number (friend_number);
+      silence->set_sample_count (sample_count);
+      silence->set_channels (channels);
+      silence->set_sampling_rate (sampling_rate);
+      return;
+    }
+
+  std::size_t const count = sample_count * channels;
+  if (events->audio_metering == proto::LEVELS_ONLY)
+    {
+      auto msg = events->pending.add_audio_receive_levels ();
+      msg->set_friend_number (friend_number);
+      set_levels (msg->mutable_levels (), pcm, count);
+      return;
+    }
+
+  auto msg = events->pending.add_audio_receive_frame ();
   msg->set_friend_number (friend_number);
+  if (events->audio_metering == proto::LEVELS)
+    set_levels (msg->mutable_levels (), pcm, count);
 
-  to_bytes (pcm, pcm + sample_count * channels, *msg->mutable_pcm ());
+  // The samples are consumed by Java in the same process, so they are copied
+  // in native byte order instead of being converted one by one.
+  msg->set_pcm (pcm, count * sizeof *pcm);
 
   msg->set_channels (channels);
   msg->set_sampling_rate (sampling_rate);
 }
 
 
+/**
+ * Copy a plane into a packed, top-down destination. Row i of the source
+ * starts at plane + i * stride, also for negative (bottom-up) strides. Rows
+ * are copied with memcpy, which uses the widest vector moves the target
+ * supports, and an unpadded plane is copied in one call.
+ */
+static void
+copy_plane (uint8_t *dest, uint8_t const *plane, uint16_t width, uint16_t height, int32_t stride)
+{
+  if (stride == width)
+    {
+      std::memcpy (dest, plane, std::size_t (width) * height);
+      return;
+    }
+
+  for (uint16_t row = 0; row < height; row++)
+    std::memcpy (dest + std::size_t (row) * width, plane + std::ptrdiff_t (row) * stride, width);
+}
+
+
+static uint8_t *
+plane_buffer (std::string *plane, std::size_t size)
+{
+  plane->resize (size);
+  return reinterpret_cast<uint8_t *> (&(*plane)[0]);
+}
+
+
 static void
 tox4j_video_receive_frame_cb (uint32_t friend_number,
                               uint16_t width, uint16_t height,
@@ -72,20 +177,101 @@ tox4j_video_receive_frame_cb (uint32_t friend_number,
                               int32_t ystride, int32_t ustride, int32_t vstride,
                               Events *events)
 {
-  assert (ystride < 0 == ustride < 0);
-  assert (ystride < 0 == vstride < 0);
+  FriendStats &stats = events->stats[friend_number];
+  stats.video_received.record (std::size_t (width) * height + std::size_t (width / 2) * (height / 2) * 2,
+                               std::chrono::steady_clock::now ());
+  stats.received_resolution.update (width, height);
+
+  bool mailbox = false;
+  auto limits = events->friend_video.find (friend_number);
+  if (limits != events->friend_video.end ())
+    {
+      FriendVideo &video = limits->second;
+      mailbox = video.mailbox;
+      if (!video.accept_frame (std::chrono::steady_clock::now ()))
+        return;
+
+      uint16_t scaled_width, scaled_height;
+      video.scaled_size (width, height, scaled_width, scaled_height);
+      if (scaled_width != width || scaled_height != height)
+        {
+          std::size_t const y_size = std::size_t (scaled_width) * scaled_height;
+          std::size_t const uv_size = std::size_t (scaled_width / 2) * (scaled_height / 2);
+          events->scaled_frame.resize (y_size + uv_size * 2);
+
+          uint8_t *scaled = events->scaled_frame.data ();
+          yuv::scale_plane (scaled                    , scaled_width    , scaled_height    , y, ystride, width    , height    );
+          yuv::scale_plane (scaled + y_size           , scaled_width / 2, scaled_height / 2, u, ustride, width / 2, height / 2);
+          yuv::scale_plane (scaled + y_size + uv_size , scaled_width / 2, scaled_height / 2, v, vstride, width / 2, height / 2);
+
+          y = scaled;
+          u = scaled + y_size;
+          v = scaled + y_size + uv_size;
+          ystride = width = scaled_width;
+          ustride = vstride = scaled_width / 2;
+          height = scaled_height;
+        }
+    }
+
+  // In mailbox mode, the frame waits for Java to take it, replacing the one
+  // still waiting, and its frame pool slot is held until then.
+  proto::VideoReceiveFrame *msg = mailbox
+    ? &events->video_mailboxes[friend_number].put (events->frames)
+    : events->pending.add_video_receive_frame ();
 
-  auto msg = events->add_video_receive_frame ();
   msg->set_friend_number (friend_number);
   msg->set_width (width);
   msg->set_height (height);
 
-  msg->set_y (y, std::max<std::size_t> (width    , std::abs (ystride)) * height);
-  msg->set_u (u, std::max<std::size_t> (width / 2, std::abs (ustride)) * (height / 2));
-  msg->set_v (v, std::max<std::size_t> (width / 2, std::abs (vstride)) * (height / 2));
-  msg->set_y_stride (ystride);
-  msg->set_u_stride (ustride);
-  msg->set_v_stride (vstride);
+  if (events->video_format != proto::I420)
+    {
+      std::size_t const size = std::size_t (width) * height * 4;
+      uint8_t *dest;
+      if (std::size_t slot = events->frames.acquire (size))
+        {
+          dest = events->frames.slots[slot - 1].data;
+          msg->set_frame_slot (slot);
+          if (mailbox)
+            events->frames.hold (slot);
+        }
+      else
+        dest = plane_buffer (msg->mutable_y (), size);
+
+      yuv::i420_to_pixels (dest, y, ystride, u, ustride, v, vstride, width, height,
+                           events->video_format == proto::RGBA ? yuv::pixel_order::RGBA : yuv::pixel_order::ARGB);
+      msg->set_format (events->video_format);
+      msg->set_y_stride (width * 4);
+      return;
+    }
+
+  std::size_t const y_size = std::size_t (width) * height;
+  std::size_t const uv_size = std::size_t (width / 2) * (height / 2);
+
+  // Java always receives packed, top-down planes, either in a registered
+  // frame pool buffer or in the message itself.
+  uint8_t *y_dest, *u_dest, *v_dest;
+  if (std::size_t slot = events->frames.acquire (y_size + uv_size * 2))
+    {
+      y_dest = events->frames.slots[slot - 1].data;
+      u_dest = y_dest + y_size;
+      v_dest = u_dest + uv_size;
+      msg->set_frame_slot (slot);
+      if (mailbox)
+        events->frames.hold (slot);
+    }
+  else
+    {
+      y_dest = plane_buffer (msg->mutable_y (), y_size);
+      u_dest = plane_buffer (msg->mutable_u (), uv_size);
+      v_dest = plane_buffer (msg->mutable_v (), uv_size);
+    }
+
+  copy_plane (y_dest, y, width    , height    , ystride);
+  copy_plane (u_dest, u, width / 2, height / 2, ustride);
+  copy_plane (v_dest, v, width / 2, height / 2, vstride);
+  msg->set_y_stride (width);
+  msg->set_u_stride (width / 2);
+  msg->set_v_stride (width / 2);
 }
 
 
@@ -99,22 +285,25 @@ toxav_new_unique (Tox *tox, TOXAV_ERR_NEW *error)
 static void
 toxav_finalize ()
 {
-  assert (!"This function is only here for register_funcs and should never be called.");
+  assert (!"This function is only here for the function name table and should never be called.");
 }
 
 
-REGISTER_FUNCS (
+FUNC_NAMES (toxav_func_names,
 #define JAVA_METHOD_REF(x)
-#define CXX_FUNCTION_REF(func)  REGISTER_FUNC (func),
+#define CXX_FUNCTION_REF(func)  FUNC_NAME (func),
 #include "generated/natives.h"
 #undef CXX_FUNCTION_REF
 #undef JAVA_METHOD_REF
 
-#define CALLBACK(NAME)          REGISTER_FUNC (tox4j_##NAME##_cb),
+#define CALLBACK(NAME)          FUNC_NAME (tox4j_##NAME##_cb),
 #include "tox/generated/av.h"
 #undef CALLBACK
 
-  REGISTER_FUNC (toxav_new_unique)
+  FUNC_NAME (toxav_audio_send_frame_mixed),
+  FUNC_NAME (toxav_audio_send_frame_resampled),
+  FUNC_NAME (toxav_video_send_frame_paced),
+  FUNC_NAME (toxav_new_unique)
 );
 
 
@@ -247,6 +436,19 @@ JNIEXPORT void JNICALL Java_im_tox_tox4j_impl_jni_ToxAvJni_invokeCallState
   );
 }
 
+/**
+ * The Java arrays hold the rows in memory order, so for a negative stride the
+ * first row, which toxav passes to the callback, is the last one in memory.
+ */
+template<typename T>
+static T const *
+first_row (T const *data, jint rows, jint stride)
+{
+  if (stride >= 0 || rows == 0)
+    return data;
+  return data - std::ptrdiff_t (stride) * (rows - 1);
+}
+
 /*
  * Class:     im_tox_tox4j_impl_jni_ToxAvJni
  * Method:    invokeVideoReceiveFrame
@@ -265,7 +467,11 @@ JNIEXPORT void JNICALL Java_im_tox_tox4j_impl_jni_ToxAvJni_invokeVideoReceiveFra
         tox4j_assert (yData.size () == std::max<std::size_t> (width    , std::abs (yStride)) * height);
         tox4j_assert (uData.size () == std::max<std::size_t> (width / 2, std::abs (uStride)) * (height / 2));
         tox4j_assert (vData.size () == std::max<std::size_t> (width / 2, std::abs (vStride)) * (height / 2));
-        tox4j_video_receive_frame_cb (friendNumber, width, height, yData.data (), uData.data (), vData.data (), yStride, uStride, vStride, &events);
+        tox4j_video_receive_frame_cb (friendNumber, width, height,
+                                      first_row (yData.data (), height    , yStride),
+                                      first_row (uData.data (), height / 2, uStride),
+                                      first_row (vData.data (), height / 2, vStride),
+                                      yStride, uStride, vStride, &events);
       }
   );
 }
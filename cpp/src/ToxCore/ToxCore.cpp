@@ -21,6 +21,19 @@ reference_symbols_core ()
 #undef JAVA_METHOD_REF
 }
 
+
+bool
+register_natives_core (JNIEnv *env)
+{
+  static JNINativeMethod const methods[] = {
+#define JNI_NATIVE(NAME, SIGNATURE) JNI_NATIVE_METHOD (NAME, SIGNATURE),
+#include "generated/registrations.h"
+#undef JNI_NATIVE
+  };
+
+  return register_natives (env, JAVA_CLASS_NAME, methods);
+}
+
 #define TOX_MAX_HOSTNAME_LENGTH 255
 #define TOX_DEFAULT_PROXY_PORT  8080
 #define TOX_DEFAULT_TCP_PORT    0
@@ -14,6 +14,7 @@
 #define SUBSYSTEM TOX
 #define CLASS     ToxCore
 #define PREFIX    tox
+#define OBJECT    Tox
 #endif
 
 namespace core
@@ -26,6 +27,22 @@ namespace core
 }
 
 
+/*
+ * The toxcore functions called by the direct ByteBuffer and non-throwing
+ * variants of the send methods. They only forward to the real function, but
+ * having their own address means the call log can tell the variants apart.
+ */
+uint32_t tox_friend_send_message_direct (Tox *tox, uint32_t friend_number, TOX_MESSAGE_TYPE type, uint8_t const *message, size_t length, TOX_ERR_FRIEND_SEND_MESSAGE *error);
+bool tox_friend_send_lossy_packet_direct (Tox *tox, uint32_t friend_number, uint8_t const *data, size_t length, TOX_ERR_FRIEND_CUSTOM_PACKET *error);
+bool tox_friend_send_lossless_packet_direct (Tox *tox, uint32_t friend_number, uint8_t const *data, size_t length, TOX_ERR_FRIEND_CUSTOM_PACKET *error);
+bool tox_file_send_chunk_direct (Tox *tox, uint32_t friend_number, uint32_t file_number, uint64_t position, uint8_t const *data, size_t length, TOX_ERR_FILE_SEND_CHUNK *error);
+
+uint32_t tox_friend_send_message_no_throw (Tox *tox, uint32_t friend_number, TOX_MESSAGE_TYPE type, uint8_t const *message, size_t length, TOX_ERR_FRIEND_SEND_MESSAGE *error);
+bool tox_friend_send_lossy_packet_no_throw (Tox *tox, uint32_t friend_number, uint8_t const *data, size_t length, TOX_ERR_FRIEND_CUSTOM_PACKET *error);
+bool tox_friend_send_lossless_packet_no_throw (Tox *tox, uint32_t friend_number, uint8_t const *data, size_t length, TOX_ERR_FRIEND_CUSTOM_PACKET *error);
+bool tox_file_send_chunk_no_throw (Tox *tox, uint32_t friend_number, uint32_t file_number, uint64_t position, uint8_t const *data, size_t length, TOX_ERR_FILE_SEND_CHUNK *error);
+
+
 template<typename T, size_t get_size (Tox const *), void get_data (Tox const *, T *)>
 struct get_vector
 {
@@ -18,7 +18,7 @@ toxBootstrapLike (bool function (Tox *tox,
   tox4j_assert (port >= 0);
   tox4j_assert (port <= 65535);
 
-  auto public_key = fromJavaArray (env, publicKey);
+  auto public_key = fromJavaArray<TOX_PUBLIC_KEY_SIZE> (env, publicKey);
   tox4j_assert (!publicKey || public_key.size () == TOX_PUBLIC_KEY_SIZE);
 
   return instances.with_instance_ign (env, instanceNumber,
@@ -17,6 +17,49 @@ TOX_METHOD (void, FriendSendLossyPacket,
   );
 }
 
+bool
+tox_friend_send_lossy_packet_direct (Tox *tox, uint32_t friend_number, uint8_t const *data, size_t length, TOX_ERR_FRIEND_CUSTOM_PACKET *error)
+{
+  return tox_friend_send_lossy_packet (tox, friend_number, data, length, error);
+}
+
+/*
+ * Class:     im_tox_tox4j_impl_ToxCoreJni
+ * Method:    toxFriendSendLossyPacketDirect
+ * Signature: (IILjava/nio/ByteBuffer;II)V
+ */
+TOX_METHOD (void, FriendSendLossyPacketDirect,
+  jint instanceNumber, jint friendNumber, jobject packet, jint offset, jint length)
+{
+  auto packetData = fromDirectBuffer<uint8_t> (env, packet, offset, length);
+  if (!packetData)
+    return throw_illegal_argument_exception (env, instanceNumber, "Invalid direct buffer region");
+
+  return instances.with_instance_ign (env, instanceNumber,
+    tox_friend_send_lossy_packet_direct, friendNumber, packetData, packetData.size ()
+  );
+}
+
+bool
+tox_friend_send_lossy_packet_no_throw (Tox *tox, uint32_t friend_number, uint8_t const *data, size_t length, TOX_ERR_FRIEND_CUSTOM_PACKET *error)
+{
+  return tox_friend_send_lossy_packet (tox, friend_number, data, length, error);
+}
+
+/*
+ * Class:     im_tox_tox4j_impl_ToxCoreJni
+ * Method:    toxFriendSendLossyPacketNoThrow
+ * Signature: (II[B)J
+ */
+TOX_METHOD (jlong, FriendSendLossyPacketNoThrow,
+  jint instanceNumber, jint friendNumber, jbyteArray packet)
+{
+  auto packetData = fromJavaArray (env, packet);
+  return instances.with_instance_code (env, instanceNumber,
+    tox_friend_send_lossy_packet_no_throw, friendNumber, packetData.data (), packetData.size ()
+  );
+}
+
 /*
  * Class:     im_tox_tox4j_impl_ToxCoreJni
  * Method:    toxFriendSendLosslessPacket
@@ -30,3 +73,46 @@ TOX_METHOD (void, FriendSendLosslessPacket,
     tox_friend_send_lossless_packet, friendNumber, packetData.data (), packetData.size ()
   );
 }
+
+bool
+tox_friend_send_lossless_packet_direct (Tox *tox, uint32_t friend_number, uint8_t const *data, size_t length, TOX_ERR_FRIEND_CUSTOM_PACKET *error)
+{
+  return tox_friend_send_lossless_packet (tox, friend_number, data, length, error);
+}
+
+/*
+ * Class:     im_tox_tox4j_impl_ToxCoreJni
+ * Method:    toxFriendSendLosslessPacketDirect
+ * Signature: (IILjava/nio/ByteBuffer;II)V
+ */
+TOX_METHOD (void, FriendSendLosslessPacketDirect,
+  jint instanceNumber, jint friendNumber, jobject packet, jint offset, jint length)
+{
+  auto packetData = fromDirectBuffer<uint8_t> (env, packet, offset, length);
+  if (!packetData)
+    return throw_illegal_argument_exception (env, instanceNumber, "Invalid direct buffer region");
+
+  return instances.with_instance_ign (env, instanceNumber,
+    tox_friend_send_lossless_packet_direct, friendNumber, packetData, packetData.size ()
+  );
+}
+
+bool
+tox_friend_send_lossless_packet_no_throw (Tox *tox, uint32_t friend_number, uint8_t const *data, size_t length, TOX_ERR_FRIEND_CUSTOM_PACKET *error)
+{
+  return tox_friend_send_lossless_packet (tox, friend_number, data, length, error);
+}
+
+/*
+ * Class:     im_tox_tox4j_impl_ToxCoreJni
+ * Method:    toxFriendSendLosslessPacketNoThrow
+ * Signature: (II[B)J
+ */
+TOX_METHOD (jlong, FriendSendLosslessPacketNoThrow,
+  jint instanceNumber, jint friendNumber, jbyteArray packet)
+{
+  auto packetData = fromJavaArray (env, packet);
+  return instances.with_instance_code (env, instanceNumber,
+    tox_friend_send_lossless_packet_no_throw, friendNumber, packetData.data (), packetData.size ()
+  );
+}
@@ -131,5 +131,53 @@ JNIEXPORT void JNICALL Java_im_tox_tox4j_impl_jni_ToxCoreJni_tox4jSetLogFilter
       filter_strings.push_back (filter.to_string ());
     }
 
-  jni_log.filter (std::move (filter_strings));
+  jni_log.filter (filter_strings);
+}
+
+/*
+ * Class:     im_tox_tox4j_impl_jni_ToxCoreJni
+ * Method:    tox4jSetLogFile
+ * Signature: (Ljava/lang/String;J)Z
+ */
+JNIEXPORT jboolean JNICALL Java_im_tox_tox4j_impl_jni_ToxCoreJni_tox4jSetLogFile
+  (JNIEnv *env, jclass, jstring path, jlong segmentSize)
+{
+  if (path == nullptr)
+    return jni_log.stream ("", 0);
+
+  UTFChars pathChars (env, path);
+  return jni_log.stream (pathChars.to_string (), segmentSize);
+}
+
+/*
+ * Class:     im_tox_tox4j_impl_jni_ToxCoreJni
+ * Method:    tox4jSetLatencyAggregation
+ * Signature: (Z)V
+ */
+JNIEXPORT void JNICALL Java_im_tox_tox4j_impl_jni_ToxCoreJni_tox4jSetLatencyAggregation
+  (JNIEnv *, jclass, jboolean enabled)
+{
+  jni_log.aggregate (enabled);
+}
+
+/*
+ * Class:     im_tox_tox4j_impl_jni_ToxCoreJni
+ * Method:    tox4jGetLatencyAggregation
+ * Signature: ()Z
+ */
+JNIEXPORT jboolean JNICALL Java_im_tox_tox4j_impl_jni_ToxCoreJni_tox4jGetLatencyAggregation
+  (JNIEnv *, jclass)
+{
+  return jni_log.aggregate ();
+}
+
+/*
+ * Class:     im_tox_tox4j_impl_jni_ToxCoreJni
+ * Method:    tox4jLastLatencyStats
+ * Signature: ()[B
+ */
+JNIEXPORT jbyteArray JNICALL Java_im_tox_tox4j_impl_jni_ToxCoreJni_tox4jLastLatencyStats
+  (JNIEnv *env, jclass)
+{
+  return toJavaArray (env, jni_log.latency_stats ());
 }
@@ -37,7 +37,7 @@ TOX_METHOD (void, FileSeek,
 TOX_METHOD (jint, FileSend,
   jint instanceNumber, jint friendNumber, jint kind, jlong fileSize, jbyteArray fileId, jbyteArray filename)
 {
-  auto fileIdData = fromJavaArray (env, fileId);
+  auto fileIdData = fromJavaArray<TOX_FILE_ID_LENGTH> (env, fileId);
   auto filenameData = fromJavaArray (env, filename);
 
   // In Java, we only have 63 bit positive file sizes, so all negative values
@@ -65,6 +65,49 @@ TOX_METHOD (void, FileSendChunk,
   );
 }
 
+bool
+tox_file_send_chunk_direct (Tox *tox, uint32_t friend_number, uint32_t file_number, uint64_t position, uint8_t const *data, size_t length, TOX_ERR_FILE_SEND_CHUNK *error)
+{
+  return tox_file_send_chunk (tox, friend_number, file_number, position, data, length, error);
+}
+
+/*
+ * Class:     im_tox_tox4j_impl_ToxCoreJni
+ * Method:    toxFileSendChunkDirect
+ * Signature: (IIIJLjava/nio/ByteBuffer;II)V
+ */
+TOX_METHOD (void, FileSendChunkDirect,
+  jint instanceNumber, jint friendNumber, jint fileNumber, jlong position, jobject chunk, jint offset, jint length)
+{
+  auto chunkData = fromDirectBuffer<uint8_t> (env, chunk, offset, length);
+  if (!chunkData)
+    return throw_illegal_argument_exception (env, instanceNumber, "Invalid direct buffer region");
+
+  return instances.with_instance_ign (env, instanceNumber,
+    tox_file_send_chunk_direct, friendNumber, fileNumber, position, chunkData, chunkData.size ()
+  );
+}
+
+bool
+tox_file_send_chunk_no_throw (Tox *tox, uint32_t friend_number, uint32_t file_number, uint64_t position, uint8_t const *data, size_t length, TOX_ERR_FILE_SEND_CHUNK *error)
+{
+  return tox_file_send_chunk (tox, friend_number, file_number, position, data, length, error);
+}
+
+/*
+ * Class:     im_tox_tox4j_impl_ToxCoreJni
+ * Method:    toxFileSendChunkNoThrow
+ * Signature: (IIIJ[B)J
+ */
+TOX_METHOD (jlong, FileSendChunkNoThrow,
+  jint instanceNumber, jint friendNumber, jint fileNumber, jlong position, jbyteArray chunk)
+{
+  auto chunkData = fromJavaArray (env, chunk);
+  return instances.with_instance_code (env, instanceNumber,
+    tox_file_send_chunk_no_throw, friendNumber, fileNumber, position, chunkData.data (), chunkData.size ()
+  );
+}
+
 /*
  * Class:     im_tox_tox4j_impl_ToxCoreJni
  * Method:    toxFileGetFileId
@@ -12,7 +12,7 @@ TOX_METHOD (jint, FriendAdd,
   jint instanceNumber, jbyteArray address, jbyteArray message)
 {
   auto messageData = fromJavaArray (env, message);
-  auto addressData = fromJavaArray (env, address);
+  auto addressData = fromJavaArray<TOX_ADDRESS_SIZE> (env, address);
   tox4j_assert (!address || addressData.size () == TOX_ADDRESS_SIZE);
   return instances.with_instance_err (env, instanceNumber,
     identity,
@@ -28,7 +28,7 @@ TOX_METHOD (jint, FriendAdd,
 TOX_METHOD (jint, FriendAddNorequest,
   jint instanceNumber, jbyteArray publicKey)
 {
-  auto public_key = fromJavaArray (env, publicKey);
+  auto public_key = fromJavaArray<TOX_PUBLIC_KEY_SIZE> (env, publicKey);
   tox4j_assert (!publicKey || public_key.size () == TOX_PUBLIC_KEY_SIZE);
   return instances.with_instance_err (env, instanceNumber,
     identity,
@@ -57,7 +57,7 @@ TOX_METHOD (void, FriendDelete,
 TOX_METHOD (jint, FriendByPublicKey,
   jint instanceNumber, jbyteArray publicKey)
 {
-  auto public_key = fromJavaArray (env, publicKey);
+  auto public_key = fromJavaArray<TOX_PUBLIC_KEY_SIZE> (env, publicKey);
   tox4j_assert (!publicKey || public_key.size () == TOX_PUBLIC_KEY_SIZE);
   return instances.with_instance_err (env, instanceNumber,
     identity,
@@ -213,3 +213,5 @@ HANDLE ("SetTyping", SET_TYPING)
     }
   return unhandled ();
 }
+
+TOX_EXCEPTIONS (tox_exceptions, EXCEPTION_CLASS (BOOTSTRAP), EXCEPTION_CLASS (FILE_CONTROL), EXCEPTION_CLASS (FILE_GET), EXCEPTION_CLASS (FILE_SEEK), EXCEPTION_CLASS (FILE_SEND_CHUNK), EXCEPTION_CLASS (FILE_SEND), EXCEPTION_CLASS (FRIEND_ADD), EXCEPTION_CLASS (FRIEND_BY_PUBLIC_KEY), EXCEPTION_CLASS (FRIEND_CUSTOM_PACKET), EXCEPTION_CLASS (FRIEND_DELETE), EXCEPTION_CLASS (FRIEND_GET_PUBLIC_KEY), EXCEPTION_CLASS (FRIEND_SEND_MESSAGE), EXCEPTION_CLASS (GET_PORT), EXCEPTION_CLASS (NEW), EXCEPTION_CLASS (SET_INFO), EXCEPTION_CLASS (SET_TYPING))
@@ -255,6 +255,22 @@ JNIEXPORT void JNICALL Java_im_tox_tox4j_impl_jni_ToxCoreJni_toxSelfSetTyping
 JNIEXPORT jint JNICALL Java_im_tox_tox4j_impl_jni_ToxCoreJni_toxFriendSendMessage
   (JNIEnv *, jclass, jint, jint, jint, jint, jbyteArray);
 
+/*
+ * Class:     im_tox_tox4j_impl_jni_ToxCoreJni
+ * Method:    toxFriendSendMessageDirect
+ * Signature: (IIIILjava/nio/ByteBuffer;II)I
+ */
+JNIEXPORT jint JNICALL Java_im_tox_tox4j_impl_jni_ToxCoreJni_toxFriendSendMessageDirect
+  (JNIEnv *, jclass, jint, jint, jint, jint, jobject, jint, jint);
+
+/*
+ * Class:     im_tox_tox4j_impl_jni_ToxCoreJni
+ * Method:    toxFriendSendMessageNoThrow
+ * Signature: (IIII[B)J
+ */
+JNIEXPORT jlong JNICALL Java_im_tox_tox4j_impl_jni_ToxCoreJni_toxFriendSendMessageNoThrow
+  (JNIEnv *, jclass, jint, jint, jint, jint, jbyteArray);
+
 /*
  * Class:     im_tox_tox4j_impl_jni_ToxCoreJni
  * Method:    toxFileControl
@@ -287,6 +303,22 @@ JNIEXPORT jint JNICALL Java_im_tox_tox4j_impl_jni_ToxCoreJni_toxFileSend
 JNIEXPORT void JNICALL Java_im_tox_tox4j_impl_jni_ToxCoreJni_toxFileSendChunk
   (JNIEnv *, jclass, jint, jint, jint, jlong, jbyteArray);
 
+/*
+ * Class:     im_tox_tox4j_impl_jni_ToxCoreJni
+ * Method:    toxFileSendChunkDirect
+ * Signature: (IIIJLjava/nio/ByteBuffer;II)V
+ */
+JNIEXPORT void JNICALL Java_im_tox_tox4j_impl_jni_ToxCoreJni_toxFileSendChunkDirect
+  (JNIEnv *, jclass, jint, jint, jint, jlong, jobject, jint, jint);
+
+/*
+ * Class:     im_tox_tox4j_impl_jni_ToxCoreJni
+ * Method:    toxFileSendChunkNoThrow
+ * Signature: (IIIJ[B)J
+ */
+JNIEXPORT jlong JNICALL Java_im_tox_tox4j_impl_jni_ToxCoreJni_toxFileSendChunkNoThrow
+  (JNIEnv *, jclass, jint, jint, jint, jlong, jbyteArray);
+
 /*
  * Class:     im_tox_tox4j_impl_jni_ToxCoreJni
  * Method:    toxFileGetFileId
@@ -303,6 +335,22 @@ JNIEXPORT jbyteArray JNICALL Java_im_tox_tox4j_impl_jni_ToxCoreJni_toxFileGetFil
 JNIEXPORT void JNICALL Java_im_tox_tox4j_impl_jni_ToxCoreJni_toxFriendSendLossyPacket
   (JNIEnv *, jclass, jint, jint, jbyteArray);
 
+/*
+ * Class:     im_tox_tox4j_impl_jni_ToxCoreJni
+ * Method:    toxFriendSendLossyPacketDirect
+ * Signature: (IILjava/nio/ByteBuffer;II)V
+ */
+JNIEXPORT void JNICALL Java_im_tox_tox4j_impl_jni_ToxCoreJni_toxFriendSendLossyPacketDirect
+  (JNIEnv *, jclass, jint, jint, jobject, jint, jint);
+
+/*
+ * Class:     im_tox_tox4j_impl_jni_ToxCoreJni
+ * Method:    toxFriendSendLossyPacketNoThrow
+ * Signature: (II[B)J
+ */
+JNIEXPORT jlong JNICALL Java_im_tox_tox4j_impl_jni_ToxCoreJni_toxFriendSendLossyPacketNoThrow
+  (JNIEnv *, jclass, jint, jint, jbyteArray);
+
 /*
  * Class:     im_tox_tox4j_impl_jni_ToxCoreJni
  * Method:    toxFriendSendLosslessPacket
@@ -311,6 +359,22 @@ JNIEXPORT void JNICALL Java_im_tox_tox4j_impl_jni_ToxCoreJni_toxFriendSendLossyP
 JNIEXPORT void JNICALL Java_im_tox_tox4j_impl_jni_ToxCoreJni_toxFriendSendLosslessPacket
   (JNIEnv *, jclass, jint, jint, jbyteArray);
 
+/*
+ * Class:     im_tox_tox4j_impl_jni_ToxCoreJni
+ * Method:    toxFriendSendLosslessPacketDirect
+ * Signature: (IILjava/nio/ByteBuffer;II)V
+ */
+JNIEXPORT void JNICALL Java_im_tox_tox4j_impl_jni_ToxCoreJni_toxFriendSendLosslessPacketDirect
+  (JNIEnv *, jclass, jint, jint, jobject, jint, jint);
+
+/*
+ * Class:     im_tox_tox4j_impl_jni_ToxCoreJni
+ * Method:    toxFriendSendLosslessPacketNoThrow
+ * Signature: (II[B)J
+ */
+JNIEXPORT jlong JNICALL Java_im_tox_tox4j_impl_jni_ToxCoreJni_toxFriendSendLosslessPacketNoThrow
+  (JNIEnv *, jclass, jint, jint, jbyteArray);
+
 /*
  * Class:     im_tox_tox4j_impl_jni_ToxCoreJni
  * Method:    invokeSelfConnectionStatus
@@ -471,6 +535,38 @@ JNIEXPORT jint JNICALL Java_im_tox_tox4j_impl_jni_ToxCoreJni_tox4jGetMaxLogSize
 JNIEXPORT void JNICALL Java_im_tox_tox4j_impl_jni_ToxCoreJni_tox4jSetLogFilter
   (JNIEnv *, jclass, jobjectArray);
 
+/*
+ * Class:     im_tox_tox4j_impl_jni_ToxCoreJni
+ * Method:    tox4jSetLogFile
+ * Signature: (Ljava/lang/String;J)Z
+ */
+JNIEXPORT jboolean JNICALL Java_im_tox_tox4j_impl_jni_ToxCoreJni_tox4jSetLogFile
+  (JNIEnv *, jclass, jstring, jlong);
+
+/*
+ * Class:     im_tox_tox4j_impl_jni_ToxCoreJni
+ * Method:    tox4jSetLatencyAggregation
+ * Signature: (Z)V
+ */
+JNIEXPORT void JNICALL Java_im_tox_tox4j_impl_jni_ToxCoreJni_tox4jSetLatencyAggregation
+  (JNIEnv *, jclass, jboolean);
+
+/*
+ * Class:     im_tox_tox4j_impl_jni_ToxCoreJni
+ * Method:    tox4jGetLatencyAggregation
+ * Signature: ()Z
+ */
+JNIEXPORT jboolean JNICALL Java_im_tox_tox4j_impl_jni_ToxCoreJni_tox4jGetLatencyAggregation
+  (JNIEnv *, jclass);
+
+/*
+ * Class:     im_tox_tox4j_impl_jni_ToxCoreJni
+ * Method:    tox4jLastLatencyStats
+ * Signature: ()[B
+ */
+JNIEXPORT jbyteArray JNICALL Java_im_tox_tox4j_impl_jni_ToxCoreJni_tox4jLastLatencyStats
+  (JNIEnv *, jclass);
+
 #ifdef __cplusplus
 }
 #endif
@@ -13,6 +13,10 @@ JAVA_METHOD_REF (toxFileSend)
 CXX_FUNCTION_REF (tox_file_send)
 JAVA_METHOD_REF (toxFileSendChunk)
 CXX_FUNCTION_REF (tox_file_send_chunk)
+JAVA_METHOD_REF (toxFileSendChunkDirect)
+CXX_FUNCTION_REF (tox_file_send_chunk_direct)
+JAVA_METHOD_REF (toxFileSendChunkNoThrow)
+CXX_FUNCTION_REF (tox_file_send_chunk_no_throw)
 JAVA_METHOD_REF (toxFinalize)
 CXX_FUNCTION_REF (tox_finalize)
 JAVA_METHOD_REF (toxFriendAdd)
@@ -29,10 +33,22 @@ JAVA_METHOD_REF (toxFriendGetPublicKey)
 CXX_FUNCTION_REF (tox_friend_get_public_key)
 JAVA_METHOD_REF (toxFriendSendLosslessPacket)
 CXX_FUNCTION_REF (tox_friend_send_lossless_packet)
+JAVA_METHOD_REF (toxFriendSendLosslessPacketDirect)
+CXX_FUNCTION_REF (tox_friend_send_lossless_packet_direct)
+JAVA_METHOD_REF (toxFriendSendLosslessPacketNoThrow)
+CXX_FUNCTION_REF (tox_friend_send_lossless_packet_no_throw)
 JAVA_METHOD_REF (toxFriendSendLossyPacket)
 CXX_FUNCTION_REF (tox_friend_send_lossy_packet)
+JAVA_METHOD_REF (toxFriendSendLossyPacketDirect)
+CXX_FUNCTION_REF (tox_friend_send_lossy_packet_direct)
+JAVA_METHOD_REF (toxFriendSendLossyPacketNoThrow)
+CXX_FUNCTION_REF (tox_friend_send_lossy_packet_no_throw)
 JAVA_METHOD_REF (toxFriendSendMessage)
 CXX_FUNCTION_REF (tox_friend_send_message)
+JAVA_METHOD_REF (toxFriendSendMessageDirect)
+CXX_FUNCTION_REF (tox_friend_send_message_direct)
+JAVA_METHOD_REF (toxFriendSendMessageNoThrow)
+CXX_FUNCTION_REF (tox_friend_send_message_no_throw)
 JAVA_METHOD_REF (toxGetSavedata)
 CXX_FUNCTION_REF (tox_get_savedata)
 JAVA_METHOD_REF (toxIterate)
@@ -0,0 +1,71 @@
+// im.tox.tox4j.impl.jni.ToxCoreJni
+JNI_NATIVE (invokeFileChunkRequest, "(IIIJI)V")
+JNI_NATIVE (invokeFileRecv, "(IIIIJ[B)V")
+JNI_NATIVE (invokeFileRecvChunk, "(IIIJ[B)V")
+JNI_NATIVE (invokeFileRecvControl, "(IIII)V")
+JNI_NATIVE (invokeFriendConnectionStatus, "(III)V")
+JNI_NATIVE (invokeFriendLosslessPacket, "(II[B)V")
+JNI_NATIVE (invokeFriendLossyPacket, "(II[B)V")
+JNI_NATIVE (invokeFriendMessage, "(IIII[B)V")
+JNI_NATIVE (invokeFriendName, "(II[B)V")
+JNI_NATIVE (invokeFriendReadReceipt, "(III)V")
+JNI_NATIVE (invokeFriendRequest, "(I[BI[B)V")
+JNI_NATIVE (invokeFriendStatus, "(III)V")
+JNI_NATIVE (invokeFriendStatusMessage, "(II[B)V")
+JNI_NATIVE (invokeFriendTyping, "(IIZ)V")
+JNI_NATIVE (invokeSelfConnectionStatus, "(II)V")
+JNI_NATIVE (tox4jGetCurrentLogSize, "()I")
+JNI_NATIVE (tox4jGetLatencyAggregation, "()Z")
+JNI_NATIVE (tox4jGetMaxLogSize, "()I")
+JNI_NATIVE (tox4jLastLatencyStats, "()[B")
+JNI_NATIVE (tox4jLastLog, "()[B")
+JNI_NATIVE (tox4jSetLatencyAggregation, "(Z)V")
+JNI_NATIVE (tox4jSetLogFile, "(Ljava/lang/String;J)Z")
+JNI_NATIVE (tox4jSetLogFilter, "([Ljava/lang/String;)V")
+JNI_NATIVE (tox4jSetMaxLogSize, "(I)V")
+JNI_NATIVE (toxAddTcpRelay, "(ILjava/lang/String;I[B)V")
+JNI_NATIVE (toxBootstrap, "(ILjava/lang/String;I[B)V")
+JNI_NATIVE (toxFileControl, "(IIII)V")
+JNI_NATIVE (toxFileGetFileId, "(III)[B")
+JNI_NATIVE (toxFileSeek, "(IIIJ)V")
+JNI_NATIVE (toxFileSend, "(IIIJ[B[B)I")
+JNI_NATIVE (toxFileSendChunk, "(IIIJ[B)V")
+JNI_NATIVE (toxFileSendChunkDirect, "(IIIJLjava/nio/ByteBuffer;II)V")
+JNI_NATIVE (toxFileSendChunkNoThrow, "(IIIJ[B)J")
+JNI_NATIVE (toxFinalize, "(I)V")
+JNI_NATIVE (toxFriendAdd, "(I[B[B)I")
+JNI_NATIVE (toxFriendAddNorequest, "(I[B)I")
+JNI_NATIVE (toxFriendByPublicKey, "(I[B)I")
+JNI_NATIVE (toxFriendDelete, "(II)V")
+JNI_NATIVE (toxFriendExists, "(II)Z")
+JNI_NATIVE (toxFriendGetPublicKey, "(II)[B")
+JNI_NATIVE (toxFriendSendLosslessPacket, "(II[B)V")
+JNI_NATIVE (toxFriendSendLosslessPacketDirect, "(IILjava/nio/ByteBuffer;II)V")
+JNI_NATIVE (toxFriendSendLosslessPacketNoThrow, "(II[B)J")
+JNI_NATIVE (toxFriendSendLossyPacket, "(II[B)V")
+JNI_NATIVE (toxFriendSendLossyPacketDirect, "(IILjava/nio/ByteBuffer;II)V")
+JNI_NATIVE (toxFriendSendLossyPacketNoThrow, "(II[B)J")
+JNI_NATIVE (toxFriendSendMessage, "(IIII[B)I")
+JNI_NATIVE (toxFriendSendMessageDirect, "(IIIILjava/nio/ByteBuffer;II)I")
+JNI_NATIVE (toxFriendSendMessageNoThrow, "(IIII[B)J")
+JNI_NATIVE (toxGetSavedata, "(I)[B")
+JNI_NATIVE (toxIterate, "(I)[B")
+JNI_NATIVE (toxIterationInterval, "(I)I")
+JNI_NATIVE (toxKill, "(I)V")
+JNI_NATIVE (toxNew, "(ZZZILjava/lang/String;IIIII[B)I")
+JNI_NATIVE (toxSelfGetAddress, "(I)[B")
+JNI_NATIVE (toxSelfGetDhtId, "(I)[B")
+JNI_NATIVE (toxSelfGetFriendList, "(I)[I")
+JNI_NATIVE (toxSelfGetName, "(I)[B")
+JNI_NATIVE (toxSelfGetNospam, "(I)I")
+JNI_NATIVE (toxSelfGetPublicKey, "(I)[B")
+JNI_NATIVE (toxSelfGetSecretKey, "(I)[B")
+JNI_NATIVE (toxSelfGetStatus, "(I)I")
+JNI_NATIVE (toxSelfGetStatusMessage, "(I)[B")
+JNI_NATIVE (toxSelfGetTcpPort, "(I)I")
+JNI_NATIVE (toxSelfGetUdpPort, "(I)I")
+JNI_NATIVE (toxSelfSetName, "(I[B)V")
+JNI_NATIVE (toxSelfSetNospam, "(II)V")
+JNI_NATIVE (toxSelfSetStatus, "(II)V")
+JNI_NATIVE (toxSelfSetStatusMessage, "(I[B)V")
+JNI_NATIVE (toxSelfSetTyping, "(IIZ)V")
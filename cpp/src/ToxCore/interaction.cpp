@@ -32,3 +32,53 @@ TOX_METHOD (jint, FriendSendMessage,
     tox_friend_send_message, friendNumber, Enum::valueOf<TOX_MESSAGE_TYPE> (env, messageType), message_array.data (), message_array.size ()
   );
 }
+
+
+uint32_t
+tox_friend_send_message_direct (Tox *tox, uint32_t friend_number, TOX_MESSAGE_TYPE type, uint8_t const *message, size_t length, TOX_ERR_FRIEND_SEND_MESSAGE *error)
+{
+  return tox_friend_send_message (tox, friend_number, type, message, length, error);
+}
+
+/*
+ * Class:     im_tox_tox4j_impl_ToxCoreJni
+ * Method:    toxFriendSendMessageDirect
+ * Signature: (IIIILjava/nio/ByteBuffer;II)I
+ */
+TOX_METHOD (jint, FriendSendMessageDirect,
+  jint instanceNumber, jint friendNumber, jint messageType, jint timeDelta, jobject message, jint offset, jint length)
+{
+  auto message_buffer = fromDirectBuffer<uint8_t> (env, message, offset, length);
+  if (!message_buffer)
+    {
+      throw_illegal_argument_exception (env, instanceNumber, "Invalid direct buffer region");
+      return 0;
+    }
+
+  return instances.with_instance_err (env, instanceNumber,
+    identity,
+    tox_friend_send_message_direct, friendNumber, Enum::valueOf<TOX_MESSAGE_TYPE> (env, messageType), message_buffer, message_buffer.size ()
+  );
+}
+
+
+uint32_t
+tox_friend_send_message_no_throw (Tox *tox, uint32_t friend_number, TOX_MESSAGE_TYPE type, uint8_t const *message, size_t length, TOX_ERR_FRIEND_SEND_MESSAGE *error)
+{
+  return tox_friend_send_message (tox, friend_number, type, message, length, error);
+}
+
+/*
+ * Class:     im_tox_tox4j_impl_ToxCoreJni
+ * Method:    toxFriendSendMessageNoThrow
+ * Signature: (IIII[B)J
+ */
+TOX_METHOD (jlong, FriendSendMessageNoThrow,
+  jint instanceNumber, jint friendNumber, jint messageType, jint timeDelta, jbyteArray message)
+{
+  auto message_array = fromJavaArray (env, message);
+
+  return instances.with_instance_code (env, instanceNumber,
+    tox_friend_send_message_no_throw, friendNumber, Enum::valueOf<TOX_MESSAGE_TYPE> (env, messageType), message_array.data (), message_array.size ()
+  );
+}
@@ -218,22 +218,22 @@ tox_new_unique (Tox_Options const *options, TOX_ERR_NEW *error)
 static void
 tox_finalize ()
 {
-  assert (!"This function is only here for register_funcs and should never be called.");
+  assert (!"This function is only here for the function name table and should never be called.");
 }
 
 
-REGISTER_FUNCS (
+FUNC_NAMES (tox_func_names,
 #define JAVA_METHOD_REF(x)
-#define CXX_FUNCTION_REF(func)  REGISTER_FUNC (func),
+#define CXX_FUNCTION_REF(func)  FUNC_NAME (func),
 #include "generated/natives.h"
 #undef CXX_FUNCTION_REF
 #undef JAVA_METHOD_REF
 
-#define CALLBACK(NAME)          REGISTER_FUNC (tox4j_##NAME##_cb),
+#define CALLBACK(NAME)          FUNC_NAME (tox4j_##NAME##_cb),
 #include "tox/generated/core.h"
 #undef CALLBACK
 
-  REGISTER_FUNC (tox_new_unique)
+  FUNC_NAME (tox_new_unique)
 );
 
 
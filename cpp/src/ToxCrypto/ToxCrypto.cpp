@@ -23,3 +23,16 @@ reference_symbols_crypto ()
 #undef CXX_FUNCTION_REF
 #undef JAVA_METHOD_REF
 }
+
+
+bool
+register_natives_crypto (JNIEnv *env)
+{
+  static JNINativeMethod const methods[] = {
+#define JNI_NATIVE(NAME, SIGNATURE) JNI_NATIVE_METHOD (NAME, SIGNATURE),
+#include "generated/registrations.h"
+#undef JNI_NATIVE
+  };
+
+  return register_natives (env, JAVA_CLASS_NAME, methods);
+}
@@ -10,6 +10,7 @@
 #define SUBSYSTEM TOX
 #define CLASS     ToxCrypto
 #define PREFIX    tox
+#define OBJECT    ToxCrypto
 
 
 struct ToxCrypto;
@@ -27,7 +27,7 @@ pass_key_from_java (JNIEnv *env, jbyteArray passKeyArray)
 {
   pass_key_ptr pass_key (reinterpret_cast<Tox_Pass_Key *> (new pass_key_impl));
 
-  auto passKey = fromJavaArray (env, passKeyArray);
+  auto passKey = fromJavaArray<TOX_PASS_SALT_LENGTH + TOX_PASS_KEY_LENGTH> (env, passKeyArray);
   tox4j_assert (passKey.size () == TOX_PASS_SALT_LENGTH + TOX_PASS_KEY_LENGTH);
   std::copy (
     passKey.begin (),
@@ -85,7 +85,7 @@ JNIEXPORT jbyteArray JNICALL Java_im_tox_tox4j_impl_jni_ToxCryptoJni_toxPassKeyD
   (JNIEnv *env, jclass, jbyteArray passphraseArray, jbyteArray saltArray)
 {
   auto passphrase = fromJavaArray (env, passphraseArray);
-  auto salt = fromJavaArray (env, saltArray);
+  auto salt = fromJavaArray<TOX_PASS_SALT_LENGTH> (env, saltArray);
 
   if (salt.size () != TOX_PASS_SALT_LENGTH)
     {
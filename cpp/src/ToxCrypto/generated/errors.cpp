@@ -47,3 +47,5 @@ HANDLE ("KeyDerivation", KEY_DERIVATION)
     }
   return unhandled ();
 }
+
+TOX_EXCEPTIONS (toxcrypto_exceptions, EXCEPTION_CLASS (DECRYPTION), EXCEPTION_CLASS (ENCRYPTION), EXCEPTION_CLASS (GET_SALT), EXCEPTION_CLASS (KEY_DERIVATION))
@@ -0,0 +1,8 @@
+// im.tox.tox4j.impl.jni.ToxCryptoJni
+JNI_NATIVE (toxGetSalt, "([B)[B")
+JNI_NATIVE (toxHash, "([B)[B")
+JNI_NATIVE (toxIsDataEncrypted, "([B)Z")
+JNI_NATIVE (toxPassKeyDecrypt, "([B[B)[B")
+JNI_NATIVE (toxPassKeyDerive, "([B)[B")
+JNI_NATIVE (toxPassKeyDeriveWithSalt, "([B[B)[B")
+JNI_NATIVE (toxPassKeyEncrypt, "([B[B)[B")
@@ -5,11 +5,14 @@
 #include "ToxInstances.h"
 #include "util/jni/ArrayFromJava.h"
 #include "util/jni/ArrayToJava.h"
+#include "util/jni/DirectBuffer.h"
 #include "util/jni/Enum.h"
 #include "util/jni/UTFChars.h"
 #include "util/pp_cat.h"
 #include "util/to_bytes.h"
 
+#include <cstddef>
+
 
 #define JAVA_METHOD_NAME(NAME) \
   PP_CAT(Java_im_tox_tox4j_impl_jni_, PP_CAT(CLASS, PP_CAT(Jni_, NAME)))
@@ -27,3 +30,31 @@ extern "C" JNIEXPORT TYPE JNICALL NAME \
 
 #define TOX_METHOD(TYPE, NAME, ...) \
   JNI_METHOD(TYPE, TOX_METHOD_NAME(NAME), __VA_ARGS__)
+
+
+#define JAVA_CLASS_NAME \
+  "im/tox/tox4j/impl/jni/" STR (PP_CAT (CLASS, Jni))
+
+#define JNI_NATIVE_METHOD(NAME, SIGNATURE) {                   \
+  const_cast<char *> (#NAME),                                  \
+  const_cast<char *> (SIGNATURE),                              \
+  reinterpret_cast<void *> (JAVA_METHOD_NAME (NAME))           \
+}
+
+
+/**
+ * Bind a class's native methods to their implementations, so that the JVM
+ * does not need to look them up by their mangled symbol names.
+ */
+template<std::size_t N>
+bool
+register_natives (JNIEnv *env, char const *class_name, JNINativeMethod const (&methods)[N])
+{
+  jclass clazz = env->FindClass (class_name);
+  if (!clazz)
+    return false;
+
+  bool const registered = env->RegisterNatives (clazz, methods, N) == JNI_OK;
+  env->DeleteLocalRef (clazz);
+  return registered;
+}
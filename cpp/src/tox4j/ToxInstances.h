@@ -4,6 +4,7 @@
 #include "util/pp_cat.h"
 #include "util/debug_log.h"
 
+#include <cstdint>
 #include <iostream>
 
 
@@ -30,14 +31,23 @@ struct conversions
     typename CType,
     typename JavaArray,
     JType *(JNIEnv::*GetArrayElements) (JavaArray, jboolean *),
-    void (JNIEnv::*ReleaseArrayElements) (JavaArray, JType *, jint)
+    void (JNIEnv::*ReleaseArrayElements) (JavaArray, JType *, jint),
+    void (JNIEnv::*GetArrayRegion) (JavaArray, jsize, jsize, JType *),
+    std::size_t InlineBytes
   >
   static auto
-  from_java (detail::MakeArrayFromJava<JType, CType, JavaArray, GetArrayElements, ReleaseArrayElements> const &array)
+  from_java (detail::MakeArrayFromJava<JType, CType, JavaArray, GetArrayElements, ReleaseArrayElements, GetArrayRegion, InlineBytes> const &array)
   {
     return array.data ();
   }
 
+  template<typename T>
+  static T const *
+  from_java (DirectBuffer<T> const &buffer)
+  {
+    return buffer.data ();
+  }
+
 
   template<typename T>
   static T
@@ -110,6 +120,18 @@ ErrorHandling
 handle_error_enum (ErrorT error);
 
 
+/**
+ * The Code enum member name of an error code, as stored in
+ * tox_exception_class::code_name.
+ */
+template<typename ErrorT>
+char const *
+error_code_name (int error)
+{
+  return handle_error_enum<ErrorT> (static_cast<ErrorT> (error)).error;
+}
+
+
 /*****************************************************************************
  *
  * Find Tox error code (last parameter).
@@ -147,12 +169,29 @@ struct error_type_of<Result (*) (ErrorCode *)>
 
 #define HANDLE(NAME, METHOD)                                      \
 template<>                                                        \
-char const *method_name<ERROR_CODE (METHOD)>() { return NAME; }   \
+ErrorHandling                                                     \
+handle_error_enum<ERROR_CODE (METHOD)> (ERROR_CODE (METHOD) error); \
+                                                                  \
+static tox_exception_class PP_CAT (METHOD, _exception) = {        \
+  module_name<OBJECT>, exn_prefix<OBJECT>, NAME,                  \
+  error_code_name<ERROR_CODE (METHOD)>, { }                       \
+};                                                                \
+                                                                  \
+template<>                                                        \
+tox_exception_class &                                             \
+exception_class<ERROR_CODE (METHOD)>()                            \
+{ return PP_CAT (METHOD, _exception); }                           \
                                                                   \
 template<>                                                        \
 ErrorHandling                                                     \
 handle_error_enum<ERROR_CODE (METHOD)> (ERROR_CODE (METHOD) error)
 
+/**
+ * An entry in the TOX_EXCEPTIONS table at the end of generated/errors.cpp.
+ */
+#define EXCEPTION_CLASS(METHOD)                     \
+  &PP_CAT (METHOD, _exception)
+
 
 /**
  * Package name inside im.tox.tox4j (av, core, crypto) in which the subsystem
@@ -168,13 +207,13 @@ template<typename Subsystem>
 char const *exn_prefix();
 
 /**
- * Exception name (after prefix) corresponding to the Tox error code enum.
+ * Exception class corresponding to the Tox error code enum.
  *
  * These are defined in generated/errors.cpp for each subsystem using the
  * HANDLE macro.
  */
 template<typename ErrorCode>
-char const *method_name();
+tox_exception_class &exception_class();
 
 
 /**
@@ -186,12 +225,7 @@ template<typename Object, typename ErrorType>
 void
 throw_tox_exception (JNIEnv *env, char const *error)
 {
-  return throw_tox_exception (env,
-    module_name<Object>(),
-    exn_prefix<Object>(),
-    method_name<ErrorType>(),
-    error
-  );
+  return throw_tox_exception (env, exception_class<ErrorType>(), -1, error);
 }
 
 
@@ -207,7 +241,7 @@ throw_tox_exception (JNIEnv *env, ErrorType error)
   switch (result.result)
     {
     case ErrorHandling::FAILURE:
-      return throw_tox_exception<Object, ErrorType> (env, result.error);
+      return throw_tox_exception (env, exception_class<ErrorType>(), error, result.error);
     case ErrorHandling::SUCCESS:
       return throw_illegal_state_exception (env, error, "Throwing OK code");
     case ErrorHandling::UNHANDLED:
@@ -265,10 +299,12 @@ with_error_handling (LogEntry &log_entry,
       return success_func (std::move (value));
     case ErrorHandling::FAILURE:
       // Throw an exception in case of error.
-      throw_tox_exception<Object, error_type> (env, result.error);
+      log_entry.set_error ();
+      throw_tox_exception (env, exception_class<error_type>(), error, result.error);
       break;
     case ErrorHandling::UNHANDLED:
       // This only happens if the tox API changed.
+      log_entry.set_error ();
       throw_illegal_state_exception (env, error, "Unknown error code");
       break;
     }
@@ -279,6 +315,114 @@ with_error_handling (LogEntry &log_entry,
 }
 
 
+/**
+ * Returned by the non-throwing entry points when the result could not be
+ * encoded, always with a pending Java exception. It is neither 0 (success)
+ * nor -(ordinal + 1) of any enum member, and it survives narrowing to jint.
+ */
+jlong const error_code_unavailable = INT32_MIN;
+
+
+/**
+ * Encode a failed call for the non-throwing entry points: -(ordinal + 1) of
+ * the Code enum member in the exception that would otherwise be thrown.
+ *
+ * The ordinal is cached by JNI_OnLoad. If the Java lookup fails, a Java
+ * exception is pending and error_code_unavailable is returned.
+ */
+template<typename Object, typename ErrorType>
+jlong
+error_code_result (JNIEnv *env, ErrorType error, char const *name)
+{
+  jint const ordinal = tox_exception_code_ordinal (env, exception_class<ErrorType>(), error, name);
+  if (ordinal < 0)
+    return error_code_unavailable;
+
+  return -(jlong (ordinal) + 1);
+}
+
+
+/**
+ * Success values of the non-throwing entry points. Functions returning bool
+ * only report success through their error code, so they encode as 0.
+ */
+template<typename T>
+jlong
+success_code_result (T value)
+{
+  return value;
+}
+
+inline jlong
+success_code_result (bool)
+{
+  return 0;
+}
+
+
+/**
+ * Like with_error_handling, but expected failures are returned instead of
+ * thrown. The result is the non-negative return value of tox_func on success
+ * (0 for bool functions), or an error_code_result. Unknown error codes still
+ * throw, since they indicate a mismatch between tox4j and toxcore, and
+ * return error_code_unavailable.
+ */
+template<typename Object, typename ToxFunc, typename ...Args>
+jlong
+with_error_code (LogEntry &log_entry,
+                 JNIEnv *env,
+                 ToxFunc tox_func,
+                 Args &&...args)
+{
+  using error_type = typename error_type_of<ToxFunc>::type;
+
+  error_type error;
+  auto value = conversions<ToxFunc, Args..., error_type *>::to_java (
+    env, log_entry, tox_func, std::forward<Args> (args)..., &error
+  );
+  ErrorHandling result = handle_error_enum<error_type> (error);
+  switch (result.result)
+    {
+    case ErrorHandling::SUCCESS:
+      return success_code_result (value);
+    case ErrorHandling::FAILURE:
+      log_entry.set_error ();
+      return error_code_result<Object> (env, error, result.error);
+    case ErrorHandling::UNHANDLED:
+      log_entry.set_error ();
+      throw_illegal_state_exception (env, error, "Unknown error code");
+      break;
+    }
+
+  return error_code_unavailable;
+}
+
+
+/**
+ * Like with_error_handling, but the error code is returned untranslated, so
+ * the caller can inspect it before passing it to throw_tox_exception or
+ * error_code_result. The call is marked as failed in the log entry if the
+ * code is anything but "OK".
+ */
+template<typename ToxFunc, typename ...Args>
+auto
+with_error_result (LogEntry &log_entry,
+                   JNIEnv *env,
+                   ToxFunc tox_func,
+                   Args &&...args)
+{
+  using error_type = typename error_type_of<ToxFunc>::type;
+
+  error_type error;
+  conversions<ToxFunc, Args..., error_type *>::to_java (
+    env, log_entry, tox_func, std::forward<Args> (args)..., &error
+  );
+  if (handle_error_enum<error_type> (error).result != ErrorHandling::SUCCESS)
+    log_entry.set_error ();
+  return error;
+}
+
+
 /**
  * A Tox instance manager. In addition to the facilities provided by
  * instance_manager, this provides with_error_handling member functions for
@@ -362,6 +506,30 @@ struct ToxInstances
   }
 
 
+  /**
+   * A composition of with_instance and with_error_code.
+   */
+  template<typename ToxFunc, typename ...Args>
+  jlong
+  with_instance_code (JNIEnv *env,
+                      jint instanceNumber,
+                      ToxFunc tox_func,
+                      Args &&...args)
+  {
+    return this->with_instance (env, instanceNumber,
+      [&] (Object *tox, Events &events)
+        {
+          unused (events);
+          LogEntry log_entry (instanceNumber, tox_func, tox, args...);
+          return ::with_error_code<Object> (
+            log_entry, env,
+            tox_func, tox, std::forward<Args> (args)...
+          );
+        }
+    );
+  }
+
+
   /**
    * Call a tox function that can not fail.
    */
@@ -1,13 +1,17 @@
 #include "util/debug_log.h"
+#include "util/histogram.h"
+#include "util/trace_writer.h"
 
 #include <tox/core.h>
 
 #include <algorithm>
+#include <atomic>
 #include <cctype>
 #include <cstdlib>
 #include <iostream>
 #include <sstream>
 #include <map>
+#include <unordered_set>
 
 #include <jni.h>
 
@@ -29,45 +33,45 @@ static std::size_t const MAX_DATA_LOG_LENGTH = 128;
 JniLog jni_log;
 
 
+template<typename Func>
+static void for_each_func_name (Func func);
+
+
 struct JniLog::data
 {
   int max_size = 100;
+  std::atomic<bool> aggregate { false };
+  std::atomic<bool> streaming { false };
   std::recursive_mutex mutex;
   protolog::JniLog log;
-  std::vector<std::string> filters;
+  // The filtered addresses, replaced as a whole by filter() so that they can
+  // be read without the lock. Replaced sets are kept until the log is
+  // destroyed, since another thread may still be reading one.
+  std::atomic<std::unordered_set<std::uintptr_t> const *> filters { nullptr };
+  std::vector<std::unique_ptr<std::unordered_set<std::uintptr_t> const>> filter_sets;
+  std::shared_ptr<trace_writer> writer;
 };
 
 
-JniLog::Entry::Entry (data *log, protolog::JniLogEntry *entry, std::unique_lock<std::recursive_mutex> lock)
-  : log (log)
-  , entry (entry)
+JniLog::Entry::Entry (protolog::JniLogEntry *entry, std::unique_lock<std::recursive_mutex> lock)
+  : entry (entry)
   , lock (std::move (lock))
 {
 }
 
 
+JniLog::Entry::Entry (std::shared_ptr<trace_writer> writer)
+  : writer (std::move (writer))
+  , owned (std::make_unique<protolog::JniLogEntry> ())
+{
+  entry = owned.get ();
+}
+
+
 JniLog::Entry::~Entry ()
 {
-  // Check if this entry needs to be filtered out.
-  if (entry && std::find (log->filters.begin (), log->filters.end (), entry->name ()) != log->filters.end ())
-    {
-      auto *entries = log->log.mutable_entries ();
-
-      // Search for the current entry in the recently added entries.
-      auto found = std::find_if (entries->rbegin (), entries->rend (),
-        [this](auto const &element)
-        { return &element == entry; }
-      );
-
-      // This would mean the log was cleared before the mutex was unlocked.
-      assert (found != entries->rend ());
-
-      // Remove the entry from the log, moving the ones after it to the front
-      // by one place. These should not be many, usually just one. During a
-      // single entry's lifetime, only event processing can happen recursively.
-      int deleted_index = entries->rend () - found - 1;
-      entries->DeleteSubrange (deleted_index, 1);
-    }
+  if (owned)
+    writer->push (std::move (owned));
 }
 
 
@@ -85,15 +89,25 @@ JniLog::Entry
 JniLog::new_entry ()
 {
   // No lock for max_size.
-  if (self->max_size == 0)
+  if (self->max_size == 0 && !self->streaming.load (std::memory_order_relaxed))
     return { };
 
   // Acquire a lock and pass it to the Entry.
   std::unique_lock<std::recursive_mutex> lock (self->mutex);
+  if (self->writer)
+    // Streaming entries are not part of the log, so they don't need the lock.
+    return JniLog::Entry (self->writer);
   if (self->log.entries_size () >= self->max_size)
     // If the log is full, unlock right away and return null.
     return nullptr;
-  return JniLog::Entry (self.get (), self->log.add_entries (), std::move (lock));
+  return JniLog::Entry (self->log.add_entries (), std::move (lock));
+}
+
+bool
+JniLog::filtered (std::uintptr_t func) const
+{
+  std::unordered_set<std::uintptr_t> const *filters = self->filters.load (std::memory_order_acquire);
+  return filters != nullptr && filters->find (func) != filters->end ();
 }
 
 std::vector<char>
@@ -147,10 +161,192 @@ JniLog::size () const
 }
 
 void
-JniLog::filter (std::vector<std::string> filters)
+JniLog::filter (std::vector<std::string> const &filters)
 {
+  // Resolve the names outside the lock. A name can belong to more than one
+  // address, e.g. for functions that are registered from several translation
+  // units, so we scan the whole registry.
+  std::unordered_set<std::uintptr_t> addresses;
+  for_each_func_name ([&] (std::uintptr_t func, std::string const &name)
+    {
+      if (std::find (filters.begin (), filters.end (), name) != filters.end ())
+        addresses.insert (func);
+    }
+  );
+
+  std::unique_ptr<std::unordered_set<std::uintptr_t> const> snapshot;
+  if (!addresses.empty ())
+    snapshot = std::make_unique<std::unordered_set<std::uintptr_t> const> (std::move (addresses));
+
   std::lock_guard<std::recursive_mutex> lock (self->mutex);
-  self->filters = std::move (filters);
+  self->filters.store (snapshot.get (), std::memory_order_release);
+  if (snapshot)
+    self->filter_sets.push_back (std::move (snapshot));
+}
+
+
+bool
+JniLog::stream (std::string const &path, std::size_t segment_size)
+{
+  std::shared_ptr<trace_writer> writer;
+  if (!path.empty ())
+    {
+      writer = std::make_shared<trace_writer> (path, segment_size);
+      if (!*writer)
+        return false;
+    }
+
+  {
+    std::lock_guard<std::recursive_mutex> lock (self->mutex);
+    std::swap (self->writer, writer);
+    self->streaming.store (self->writer != nullptr, std::memory_order_relaxed);
+  }
+
+  // If there are no entries in flight, the previous writer is flushed and
+  // closed here, outside the lock.
+  writer.reset ();
+  return true;
+}
+
+
+thread_local std::uint32_t call_depth::current;
+
+
+std::uint32_t
+trace_thread_id ()
+{
+  static std::atomic<std::uint32_t> next_id;
+  static thread_local std::uint32_t const id = ++next_id;
+  return id;
+}
+
+
+/****************************************************************************
+ *
+ * :: Latency aggregation.
+ *
+ ****************************************************************************/
+
+
+/**
+ * One histogram per (function, instance number) pair. Slots are claimed on
+ * first use and never released, so a slot's key is immutable once its state
+ * is READY.
+ */
+struct latency_slot
+{
+  enum State
+  {
+    FREE,
+    CLAIMING,
+    READY
+  };
+
+  std::atomic<int> state;
+  std::uintptr_t func;
+  int instance_number;
+  latency_histogram histogram;
+};
+
+
+/**
+ * Number of distinct (function, instance number) pairs that can be tracked.
+ * Must be a power of two. Calls that don't fit are counted in
+ * latency_overflow and otherwise ignored.
+ */
+static std::size_t const LATENCY_SLOTS = 256;
+
+// Zero-initialised, so all slots start out FREE.
+static latency_slot latency_table[LATENCY_SLOTS];
+static std::atomic<std::uint64_t> latency_overflow;
+
+
+/**
+ * Find the slot for a function/instance pair using lock-free open addressing
+ * with linear probing. Returns null if the table is full.
+ */
+static latency_slot *
+find_latency_slot (std::uintptr_t func, int instance_number)
+{
+  std::size_t const hash = (func >> 4) ^ (std::size_t (instance_number) * 0x9e3779b1);
+  for (std::size_t probe = 0; probe < LATENCY_SLOTS; probe++)
+    {
+      latency_slot &slot = latency_table[(hash + probe) & (LATENCY_SLOTS - 1)];
+
+      int state = slot.state.load (std::memory_order_acquire);
+      if (state == latency_slot::FREE
+          && slot.state.compare_exchange_strong (state, latency_slot::CLAIMING, std::memory_order_acquire))
+        {
+          slot.func = func;
+          slot.instance_number = instance_number;
+          slot.state.store (latency_slot::READY, std::memory_order_release);
+          return &slot;
+        }
+
+      // Another thread is writing the key; it will be done momentarily.
+      while (state == latency_slot::CLAIMING)
+        state = slot.state.load (std::memory_order_acquire);
+
+      if (slot.func == func && slot.instance_number == instance_number)
+        return &slot;
+    }
+
+  return nullptr;
+}
+
+
+void
+JniLog::aggregate (bool enabled)
+{
+  self->aggregate.store (enabled, std::memory_order_relaxed);
+}
+
+bool
+JniLog::aggregate () const
+{
+  return self->aggregate.load (std::memory_order_relaxed);
+}
+
+void
+JniLog::record_latency (std::uintptr_t func, int instance_number, std::uint64_t elapsed_nanos, bool error)
+{
+  if (latency_slot *slot = find_latency_slot (func, instance_number))
+    slot->histogram.record (elapsed_nanos, error);
+  else
+    latency_overflow.fetch_add (1, std::memory_order_relaxed);
+}
+
+std::vector<char>
+JniLog::latency_stats ()
+{
+  protolog::JniLatencyStats stats;
+
+  latency_histogram::summary summary;
+  for (latency_slot &slot : latency_table)
+    {
+      if (slot.state.load (std::memory_order_acquire) != latency_slot::READY)
+        continue;
+
+      slot.histogram.snapshot (summary);
+      if (summary.count == 0)
+        continue;
+
+      protolog::JniLatency *latency = stats.add_functions ();
+      latency->set_name (get_func_name (slot.func));
+      latency->set_instance_number (slot.instance_number);
+      latency->set_call_count (summary.count);
+      latency->set_error_count (summary.errors);
+      latency->set_p50_nanos (summary.percentile (0.5));
+      latency->set_p99_nanos (summary.percentile (0.99));
+      latency->set_p999_nanos (summary.percentile (0.999));
+      latency->set_max_nanos (summary.max);
+    }
+  stats.set_dropped_calls (latency_overflow.exchange (0, std::memory_order_relaxed));
+
+  std::vector<char> buffer (stats.ByteSize ());
+  stats.SerializeToArray (buffer.data (), buffer.size ());
+
+  return buffer;
 }
 
 
@@ -161,25 +357,75 @@ JniLog::filter (std::vector<std::string> filters)
  ****************************************************************************/
 
 
+/**
+ * All entries of func_name_tables, sorted by address. This is built on the
+ * first lookup, so that no registry code runs when the library is loaded.
+ */
+static std::vector<func_name> const &
+static_func_names ()
+{
+  static std::vector<func_name> const sorted = [] {
+    std::vector<func_name> names;
+    for (func_name_table const *const *table = func_name_tables; *table != nullptr; table++)
+      names.insert (names.end (), (*table)->begin, (*table)->end);
+
+    std::sort (names.begin (), names.end (),
+      [] (func_name const &a, func_name const &b)
+      { return a.func < b.func; }
+    );
+    return names;
+  } ();
+  return sorted;
+}
+
+
+/**
+ * Names registered at run time with register_func. These are few, and only
+ * registered on first use of the named function, so a locked map suffices.
+ */
+struct dynamic_registry
+{
+  std::mutex mutex;
+  std::map<std::uintptr_t, std::string const> names;
+};
+
 /**
  * The global singleton is in a function because otherwise static
  * initialisation order does not guarantee the map to be initialised when it
  * is accessed from another translation unit calling register_func.
  */
-static std::map<std::uintptr_t, std::string const> &
-func_names ()
+static dynamic_registry &
+dynamic_func_names ()
 {
-  static std::map<std::uintptr_t, std::string const> func_names;
+  static dynamic_registry func_names;
   return func_names;
 }
 
 
+/**
+ * Call a function with the address and name of every registered function.
+ */
+template<typename Func>
+static void
+for_each_func_name (Func func)
+{
+  for (func_name const &name : static_func_names ())
+    func (name.func, name.name);
+
+  auto &dynamic = dynamic_func_names ();
+  std::lock_guard<std::mutex> lock (dynamic.mutex);
+  for (auto const &name : dynamic.names)
+    func (name.first, name.second);
+}
+
+
 bool
 register_func (std::uintptr_t func, std::string const &name)
 {
-  auto &names = func_names ();
-  assert (names.find (func) == names.end ());
-  names.insert (std::make_pair (func, name));
+  auto &dynamic = dynamic_func_names ();
+  std::lock_guard<std::mutex> lock (dynamic.mutex);
+  assert (dynamic.names.find (func) == dynamic.names.end ());
+  dynamic.names.insert (std::make_pair (func, name));
   return true;
 }
 
@@ -187,12 +433,21 @@ register_func (std::uintptr_t func, std::string const &name)
 std::string
 get_func_name (std::uintptr_t func)
 {
-  auto &names = func_names ();
-  auto found = names.find (func);
-  if (found != names.end ())
-    return found->second;
-  else
-    return std::to_string (func);
+  auto const &names = static_func_names ();
+  auto found = std::lower_bound (names.begin (), names.end (), func,
+    [] (func_name const &name, std::uintptr_t func)
+    { return name.func < func; }
+  );
+  if (found != names.end () && found->func == func)
+    return found->name;
+
+  auto &dynamic = dynamic_func_names ();
+  std::lock_guard<std::mutex> lock (dynamic.mutex);
+  auto dynamic_found = dynamic.names.find (func);
+  if (dynamic_found != dynamic.names.end ())
+    return dynamic_found->second;
+
+  return std::to_string (func);
 }
 
 
@@ -4,19 +4,24 @@
 #include "cpp14compat.h"
 
 #include "util/jni/ArrayFromJava.h"
+#include "util/jni/DirectBuffer.h"
 #include "util/pp_attributes.h"
 #include "util/pp_cat.h"
+#include "util/trace_clock.h"
 #include "util/unused.h"
 #include "util/wrap_void.h"
 
 #include "ProtoLog.pb.h"
 
-#include <chrono>
+#include <cstdint>
+#include <iterator>
 #include <memory>
 #include <mutex>
 
 namespace protolog = im::tox::tox4j::impl::jni::proto;
 
+struct trace_writer;
+
 
 /****************************************************************************
  *
@@ -69,14 +74,26 @@ template<
   typename CType,
   typename JavaArray,
   JType *(JNIEnv::*GetArrayElements) (JavaArray, jboolean *),
-  void (JNIEnv::*ReleaseArrayElements) (JavaArray, JType *, jint)
+  void (JNIEnv::*ReleaseArrayElements) (JavaArray, JType *, jint),
+  void (JNIEnv::*GetArrayRegion) (JavaArray, jsize, jsize, JType *),
+  std::size_t InlineBytes
 >
 void
-print_arg (protolog::Value &value, detail::MakeArrayFromJava<JType, CType, JavaArray, GetArrayElements, ReleaseArrayElements> const &array)
+print_arg (protolog::Value &value, detail::MakeArrayFromJava<JType, CType, JavaArray, GetArrayElements, ReleaseArrayElements, GetArrayRegion, InlineBytes> const &array)
 {
   print_arg (value, array.data (), array.size ());
 }
 
+/**
+ * The same for direct buffer regions.
+ */
+template<typename T>
+void
+print_arg (protolog::Value &value, DirectBuffer<T> const &buffer)
+{
+  print_arg (value, buffer.data (), buffer.size ());
+}
+
 /**
  * For wrapped_value, we need two overloads, one for the general case and one
  * for void.
@@ -166,7 +183,7 @@ print_args (protolog::JniLogEntry &log_entry,
 
 /****************************************************************************
  *
- * register_funcs: Function registry (map of address to name) for logging.
+ * Function registry (map of address to name) for logging.
  *
  ****************************************************************************/
 
@@ -191,7 +208,58 @@ get_func_name (R func (Args...))
 
 
 /**
- * Add a single address/name pair to the function map.
+ * An address/name pair in a static function name table.
+ */
+struct func_name
+{
+  std::uintptr_t func;
+  char const *name;
+};
+
+/**
+ * A static function name table, usually defined with FUNC_NAMES.
+ */
+struct func_name_table
+{
+  func_name const *begin;
+  func_name const *end;
+};
+
+/**
+ * The null-terminated list of all static function name tables, defined in
+ * Tox4j.cpp. On the first lookup, these are merged into a sorted array, so
+ * loading the library does not run any registry code.
+ */
+extern func_name_table const *const func_name_tables[];
+
+
+/**
+ * Syntax helper macros for defining a static function name table. Intended
+ * to be used at namespace scope like:
+ *
+ * FUNC_NAMES (cstdio_func_names,
+ *   FUNC_NAME (std::printf),
+ *   FUNC_NAME (std::puts),
+ *   FUNC_NAME (std::fopen)
+ * );
+ *
+ * This defines cstdio_func_names with three of the <cstdio> functions, which
+ * can be looked up by print_func once the table is added to
+ * func_name_tables. The table consists only of address constants and string
+ * literals, so the compiler emits it as initialised data.
+ */
+#define FUNC_NAMES(table, ...)                                          \
+  static func_name const PP_CAT (table, _data)[] = { __VA_ARGS__ };     \
+  extern func_name_table const table;                                   \
+  func_name_table const table = {                                       \
+    std::begin (PP_CAT (table, _data)), std::end (PP_CAT (table, _data)) \
+  }
+#define FUNC_NAME(func) { reinterpret_cast<std::uintptr_t> (func), #func }
+
+
+/**
+ * Add a single address/name pair to the function registry at run time. This
+ * is only needed for names that are not known at compile time.
  */
 bool register_func (uintptr_t func, std::string const &name);
 
@@ -206,7 +274,7 @@ register_funcs ()
 }
 
 /**
- * Register all address/name pairs in the function map.
+ * Register all address/name pairs at run time.
  */
 template<typename Func, typename Name, typename ...Funcs>
 bool
@@ -218,20 +286,15 @@ register_funcs (Func func, Name const &name, Funcs const &...funcs)
 
 
 /**
- * Syntax helper macros for registering a number of function addresses with
- * their names. Intended to be called like:
+ * Register function names computed at run time, e.g. from template arguments.
+ * This is intended to be used in a function that is called on first use, not
+ * at namespace scope, so that it doesn't run when the library is loaded:
  *
  * REGISTER_FUNCS (
- *   REGISTER_FUNC (std::printf),
- *   REGISTER_FUNC (std::puts),
- *   REGISTER_FUNC (std::fopen)
+ *   reinterpret_cast<uintptr_t> (make), "make<" + std::to_string (N) + ">"
  * );
- *
- * This will register three of the <cstdio> functions so that they can be
- * looked up by print_func.
  */
 #define REGISTER_FUNCS static PP_UNUSED bool const PP_CAT (register_funcs_, __LINE__) = register_funcs
-#define REGISTER_FUNC(func) reinterpret_cast<uintptr_t> (func), #func
 
 
 /****************************************************************************
@@ -258,6 +321,10 @@ struct JniLog
    * out of scope. This ensures that any writes to the log entry are done before
    * any other operations (in particular, clear()) occur.
    *
+   * In streaming mode, the Entry instead owns a standalone JniLogEntry and
+   * holds no lock. When it goes out of scope, the entry is passed to the trace
+   * writer thread.
+   *
    * It also contains some pointer operators ->, *, and bool conversion so it
    * behaves roughly like a JniLogEntry pointer.
    */
@@ -265,7 +332,8 @@ struct JniLog
   {
     Entry (Entry &&) = default;
 
-    Entry (data *log = nullptr, protolog::JniLogEntry *entry = nullptr, std::unique_lock<std::recursive_mutex> lock = { });
+    Entry (protolog::JniLogEntry *entry = nullptr, std::unique_lock<std::recursive_mutex> lock = { });
+    explicit Entry (std::shared_ptr<trace_writer> writer);
     ~Entry ();
 
     protolog::JniLogEntry *operator -> () const { return  entry; }
@@ -273,21 +341,32 @@ struct JniLog
     explicit operator bool () const { return entry; }
 
   private:
-    data *log;
     protolog::JniLogEntry *entry;
     std::unique_lock<std::recursive_mutex> lock;
+
+    std::shared_ptr<trace_writer> writer;
+    std::unique_ptr<protolog::JniLogEntry> owned;
   };
 
   JniLog ();
   ~JniLog ();
 
   /**
-   * Create a new log entry. Only one thread can operate on the log at the
-   * same time. This function does not acquire a lock when max_size is set
-   * to 0.
+   * Create a new log entry for a call. Only one thread can operate on the
+   * log at the same time. This function does not acquire a lock when
+   * max_size is set to 0 and no trace file is being written. Filters are not
+   * checked here; see filtered().
    */
   Entry new_entry ();
 
+  /**
+   * Return whether calls to the function at the given address are filtered
+   * out. This costs one hash lookup, or none without filters.
+   *
+   * This function does not acquire the lock.
+   */
+  bool filtered (std::uintptr_t func) const;
+
   /**
    * Serialise the log to bytes and then delete all log entries. After this,
    * empty() will be true.
@@ -313,9 +392,45 @@ struct JniLog
   int size () const;
 
   /**
-   * Set filters to avoid logging certain calls.
+   * Set filters to avoid logging certain calls. The names are resolved to
+   * function addresses through the function registry when this function is
+   * called, so only functions registered at that point can be filtered.
    */
-  void filter (std::vector<std::string> filters);
+  void filter (std::vector<std::string> const &filters);
+
+  /**
+   * Stream all log entries to a series of memory-mapped files named
+   * "<path>.0", "<path>.1", etc., each of about segment_size bytes. While
+   * streaming, max_size is ignored and the in-memory log stays empty. An empty
+   * path stops streaming and closes the current file once all pending entries
+   * are written.
+   *
+   * Returns false if the first file could not be created.
+   */
+  bool stream (std::string const &path, std::size_t segment_size);
+
+  /**
+   * Enable or disable latency aggregation. When enabled, every call made
+   * through LogEntry::print_result is timed and counted in a histogram for
+   * its function and instance number, independently of max_size.
+   *
+   * These functions do not acquire the lock.
+   */
+  void aggregate (bool enabled);
+  bool aggregate () const;
+
+  /**
+   * Record the execution time of a single call. This function is lock-free
+   * and does not allocate.
+   */
+  void record_latency (std::uintptr_t func, int instance_number, std::uint64_t elapsed_nanos, bool error);
+
+  /**
+   * Serialise the call count, error count, and latency percentiles of every
+   * function called since the last call to this function, then reset all
+   * histograms.
+   */
+  std::vector<char> latency_stats ();
 
 private:
   std::unique_ptr<data> self;
@@ -329,6 +444,27 @@ private:
 extern JniLog jni_log;
 
 
+/**
+ * Number of print_result calls currently executing on this thread, used to
+ * record which calls (e.g. callbacks) were made from inside which other calls
+ * (e.g. tox_iterate).
+ */
+struct call_depth
+{
+  static thread_local std::uint32_t current;
+
+  std::uint32_t const outer = current++;
+  ~call_depth () { current--; }
+};
+
+
+/**
+ * A small number identifying the calling thread in the log, assigned in the
+ * order in which threads first log a call.
+ */
+std::uint32_t trace_thread_id ();
+
+
 /**
  * Helper class to create a log entry in jni_log and write the function call
  * arguments and result to the new entry.
@@ -343,6 +479,7 @@ struct LogEntry
    */
   template<typename Func, typename ...Args>
   LogEntry (Func func, Args const &...args)
+    : func_address (reinterpret_cast<std::uintptr_t> (func))
   {
     static_assert (
       std::is_function<typename std::remove_pointer<Func>::type>::value,
@@ -363,40 +500,65 @@ struct LogEntry
   LogEntry (int instanceNumber, Func func, Args const &...args)
     : LogEntry (func, args...)
   {
+    instance_number = instanceNumber;
     if (entry)
       entry->set_instance_number (instanceNumber);
   }
 
+  /**
+   * If the call was timed for latency aggregation, the measurement is
+   * recorded here, so that set_error can still be called after print_result.
+   */
+  ~LogEntry ()
+  {
+    if (timed)
+      jni_log.record_latency (func_address, instance_number, elapsed_nanos, error);
+  }
+
+  /**
+   * Mark the call as failed. This is counted in the aggregated error count.
+   */
+  void set_error () { error = true; }
+
 
   /**
-   * Call a function with some arguments and write the result with start time
-   * and execution duration to the log entry. If the entry is null (this
-   * happens when the log is full), the call is not timed, so print_result
-   * has only the overhead of a comparison to 0 and a branch.
+   * Call a function with some arguments and write the result with start time,
+   * execution duration, and nesting depth to the log entry. If the entry is
+   * null (this happens when the log is full) and latency aggregation is
+   * disabled, the call is not timed, so print_result has only the overhead of
+   * two comparisons and branches, and the depth counter update.
    */
   template<typename FuncT, typename ...Args>
   auto
   print_result (FuncT func, Args &&...args)
   {
-    if (entry)
+    call_depth depth;
+
+    if (entry || jni_log.aggregate ())
       {
-        auto start = std::chrono::system_clock::now();
+        trace_clock::ensure_calibrated ();
+
+        std::uint64_t const start = trace_clock::ticks ();
         auto result = wrap_void (func, std::forward<Args> (args)...);
-        auto end = std::chrono::system_clock::now();
+        std::uint64_t const end = trace_clock::ticks ();
 
-        using std::chrono::duration_cast;
-        using std::chrono::seconds;
-        using std::chrono::nanoseconds;
+        elapsed_nanos = trace_clock::to_nanos (end - start);
+        timed = jni_log.aggregate ();
 
-        auto start_time = start.time_since_epoch ();
+        if (entry)
+          {
+            std::uint64_t const start_time = trace_clock::to_epoch_nanos (start);
 
-        protolog::Timestamp *timestamp = entry->mutable_timestamp ();
-        timestamp->set_seconds (duration_cast<seconds> (start_time).count ());
-        timestamp->set_nanos (duration_cast<nanoseconds> (start_time).count () % 1000000000);
+            protolog::Timestamp *timestamp = entry->mutable_timestamp ();
+            timestamp->set_seconds (start_time / 1000000000);
+            timestamp->set_nanos (start_time % 1000000000);
 
-        entry->set_elapsed_nanos (duration_cast<nanoseconds> (end - start).count ());
+            entry->set_elapsed_nanos (elapsed_nanos);
+            entry->set_depth (depth.outer);
+            entry->set_thread_id (trace_thread_id ());
 
-        print_arg (*entry->mutable_result (), result);
+            print_arg (*entry->mutable_result (), result);
+          }
 
         return result;
       }
@@ -405,7 +567,17 @@ struct LogEntry
   }
 
 private:
-  JniLog::Entry const entry = jni_log.new_entry ();
+  std::uintptr_t const func_address;
+  int instance_number = 0;
+  std::uint64_t elapsed_nanos = 0;
+  bool timed = false;
+  bool error = false;
+
+  // Must be declared after func_address, since it's initialised from it.
+  // Filtered calls don't get an entry, and don't touch the log's lock.
+  JniLog::Entry const entry = jni_log.filtered (func_address)
+    ? JniLog::Entry ()
+    : jni_log.new_entry ();
 };
 
 #endif
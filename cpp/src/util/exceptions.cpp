@@ -1,5 +1,7 @@
 #include "util/exceptions.h"
 
+#include "util/jni/UTFChars.h"
+
 #include <cstdlib>
 #include <sstream>
 
@@ -12,6 +14,165 @@ tox4j_fatal_error (JNIEnv *env, char const *message)
 }
 
 
+/*****************************************************************************
+ *
+ * Class cache, filled once in JNI_OnLoad and only read afterwards.
+ *
+ *****************************************************************************/
+
+
+namespace
+{
+  enum plain_exception
+  {
+    TOX_KILLED_EXCEPTION,
+    ILLEGAL_ARGUMENT_EXCEPTION,
+    ILLEGAL_STATE_EXCEPTION,
+  };
+
+  // Exceptions constructed by ThrowNew, indexed by plain_exception.
+  char const *const plain_exception_classes[] = {
+    "im/tox/tox4j/exceptions/ToxKilledException",
+    "java/lang/IllegalArgumentException",
+    "java/lang/IllegalStateException",
+  };
+
+  std::size_t const plain_exception_count = sizeof plain_exception_classes / sizeof *plain_exception_classes;
+
+  jclass plain_exception_cache[plain_exception_count];
+}
+
+
+static std::string
+exception_class_name (tox_exception_class const &exception)
+{
+  std::string className = "im/tox/tox4j/";
+  className += exception.module ();
+  className += "/exceptions/Tox";
+  className += exception.prefix ();
+  className += exception.method;
+  className += "Exception";
+  return className;
+}
+
+
+static jclass
+global_class (JNIEnv *env, char const *class_name)
+{
+  jclass clazz = env->FindClass (class_name);
+  if (!clazz)
+    return nullptr;
+
+  jclass global = static_cast<jclass> (env->NewGlobalRef (clazz));
+  env->DeleteLocalRef (clazz);
+  return global;
+}
+
+
+static bool
+cache_codes (JNIEnv *env, std::string const &class_name, tox_exception_class &exception)
+{
+  std::string enumName = class_name + "$Code";
+  jclass enumClass = env->FindClass (enumName.c_str ());
+  if (!enumClass)
+    return false;
+
+  std::string constructorSig = "(L" + enumName + ";)V";
+  exception.cache.constructor = env->GetMethodID (exception.cache.clazz, "<init>", constructorSig.c_str ());
+  if (!exception.cache.constructor)
+    return false;
+
+  std::string valueOfSig = "(Ljava/lang/String;)L" + enumName + ";";
+  jmethodID valueOf = env->GetStaticMethodID (enumClass, "valueOf", valueOfSig.c_str ());
+  jmethodID ordinal = env->GetMethodID (enumClass, "ordinal", "()I");
+  if (!valueOf || !ordinal)
+    return false;
+
+  // Resolve each C error code to its enum member once, so that throwing can
+  // index by the error code.
+  for (int error = 0; error < tox_exception_class::max_codes; error++)
+    {
+      char const *code = exception.code_name (error);
+      if (code == nullptr)
+        continue;
+
+      jstring name = env->NewStringUTF (code);
+      jobject member = env->CallStaticObjectMethod (enumClass, valueOf, name);
+      if (env->ExceptionCheck ())
+        return false;
+
+      exception.cache.ordinals[error] = env->CallIntMethod (member, ordinal);
+      exception.cache.codes[error] = env->NewGlobalRef (member);
+
+      env->DeleteLocalRef (member);
+      env->DeleteLocalRef (name);
+    }
+
+  env->DeleteLocalRef (enumClass);
+  return true;
+}
+
+
+bool
+cache_exception_classes (JNIEnv *env)
+{
+  for (std::size_t i = 0; i < plain_exception_count; i++)
+    {
+      plain_exception_cache[i] = global_class (env, plain_exception_classes[i]);
+      if (!plain_exception_cache[i])
+        return false;
+    }
+
+  for (tox_exception_table const *const *table = tox_exception_tables; *table != nullptr; table++)
+    for (tox_exception_class *const *it = (*table)->begin; it != (*table)->end; ++it)
+      {
+        tox_exception_class &exception = **it;
+        std::string const class_name = exception_class_name (exception);
+        exception.cache.clazz = global_class (env, class_name.c_str ());
+        if (!exception.cache.clazz || !cache_codes (env, class_name, exception))
+          return false;
+      }
+
+  return true;
+}
+
+
+void
+release_exception_classes (JNIEnv *env)
+{
+  for (jclass &clazz : plain_exception_cache)
+    {
+      if (clazz)
+        env->DeleteGlobalRef (clazz);
+      clazz = nullptr;
+    }
+
+  for (tox_exception_table const *const *table = tox_exception_tables; *table != nullptr; table++)
+    for (tox_exception_class *const *it = (*table)->begin; it != (*table)->end; ++it)
+      {
+        tox_exception_class &exception = **it;
+        for (jobject &code : exception.cache.codes)
+          {
+            if (code)
+              env->DeleteGlobalRef (code);
+            code = nullptr;
+          }
+        if (exception.cache.clazz)
+          env->DeleteGlobalRef (exception.cache.clazz);
+        exception.cache.clazz = nullptr;
+        exception.cache.constructor = nullptr;
+      }
+}
+
+
+/*****************************************************************************
+ *
+ * Exception throwing. The cache is consulted first, but classes can still be
+ * looked up through FindClass, for code running without JNI_OnLoad.
+ *
+ *****************************************************************************/
+
+
 static std::string
 fullMessage (jint instance_number, char const *message)
 {
@@ -23,68 +184,118 @@ fullMessage (jint instance_number, char const *message)
 
 
 static void
-throw_exception (JNIEnv *env, jint instance_number, char const *class_name, char const *message)
+throw_exception (JNIEnv *env, jint instance_number, plain_exception exception, char const *message)
 {
-  env->ThrowNew (env->FindClass (class_name), fullMessage (instance_number, message).c_str ());
+  jclass clazz = plain_exception_cache[exception];
+  if (!clazz)
+    clazz = env->FindClass (plain_exception_classes[exception]);
+  env->ThrowNew (clazz, fullMessage (instance_number, message).c_str ());
 }
 
 void
 throw_tox_killed_exception (JNIEnv *env, jint instance_number, char const *message)
 {
-  throw_exception (env, instance_number, "im/tox/tox4j/exceptions/ToxKilledException", message);
+  throw_exception (env, instance_number, TOX_KILLED_EXCEPTION, message);
 }
 
 void
 throw_illegal_state_exception (JNIEnv *env, jint instance_number, char const *message)
 {
-  throw_exception (env, instance_number, "java/lang/IllegalStateException", message);
+  throw_exception (env, instance_number, ILLEGAL_STATE_EXCEPTION, message);
 }
 
 void
 throw_illegal_state_exception (JNIEnv *env, jint instance_number, std::string const &message)
 {
-  throw_exception (env, instance_number, "java/lang/IllegalStateException", message.c_str ());
+  throw_exception (env, instance_number, ILLEGAL_STATE_EXCEPTION, message.c_str ());
 }
 
-
 void
-throw_tox_exception (JNIEnv *env, char const *module, char const *prefix, char const *method, char const *code)
+throw_illegal_argument_exception (JNIEnv *env, jint instance_number, char const *message)
 {
-  std::string className = "im/tox/tox4j/";
-  className += module;
-  className += "/exceptions/Tox";
-  className += prefix;
-  className += method;
-  className += "Exception";
+  throw_exception (env, instance_number, ILLEGAL_ARGUMENT_EXCEPTION, message);
+}
 
-  jclass exceptionClass = env->FindClass (className.c_str ());
-  if (!exceptionClass)
-    return;
 
-  std::string enumName = className + "$Code";
+static jobject
+cached_exception_code (tox_exception_class const &exception, int error)
+{
+  if (error < 0 || error >= tox_exception_class::max_codes)
+    return nullptr;
+  return exception.cache.codes[error];
+}
+
+
+static jobject
+lookup_exception_code (JNIEnv *env, std::string const &enumName, char const *code)
+{
   jclass enumClass = env->FindClass (enumName.c_str ());
   if (!enumClass)
-    return;
+    return nullptr;
 
   std::string valueOfSig = "(Ljava/lang/String;)L" + enumName + ";";
   jmethodID valueOf = env->GetStaticMethodID (enumClass, "valueOf", valueOfSig.c_str ());
   if (!valueOf)
-    return;
-
-  std::string constructorSig = "(L" + enumName + ";)V";
-  jmethodID constructor = env->GetMethodID (exceptionClass, "<init>", constructorSig.c_str ());
-  if (!constructor)
-    return;
+    return nullptr;
 
   jobject enumCode = env->CallStaticObjectMethod (enumClass, valueOf, env->NewStringUTF (code));
   if (env->ExceptionCheck ())
-    return;
+    return nullptr;
   tox4j_assert (enumCode);
 
-  jobject exception = env->NewObject (exceptionClass, constructor, enumCode);
+  return enumCode;
+}
+
+
+void
+throw_tox_exception (JNIEnv *env, tox_exception_class const &exception, int error, char const *code)
+{
+  jclass exceptionClass = exception.cache.clazz;
+  jmethodID constructor = exception.cache.constructor;
+  jobject enumCode = cached_exception_code (exception, error);
+
+  if (!exceptionClass)
+    {
+      std::string className = exception_class_name (exception);
+      exceptionClass = env->FindClass (className.c_str ());
+      if (!exceptionClass)
+        return;
+
+      std::string constructorSig = "(L" + className + "$Code;)V";
+      constructor = env->GetMethodID (exceptionClass, "<init>", constructorSig.c_str ());
+      if (!constructor)
+        return;
+    }
+
+  if (!enumCode)
+    {
+      enumCode = lookup_exception_code (env, exception_class_name (exception) + "$Code", code);
+      if (!enumCode)
+        return;
+    }
+
+  jobject exceptionObject = env->NewObject (exceptionClass, constructor, enumCode);
   if (env->ExceptionCheck ())
     return;
-  tox4j_assert (exception);
+  tox4j_assert (exceptionObject);
+
+  env->Throw ((jthrowable)exceptionObject);
+}
+
+
+jint
+tox_exception_code_ordinal (JNIEnv *env, tox_exception_class const &exception, int error, char const *code)
+{
+  if (cached_exception_code (exception, error))
+    return exception.cache.ordinals[error];
+
+  jobject enumCode = lookup_exception_code (env, exception_class_name (exception) + "$Code", code);
+  if (!enumCode)
+    return -1;
+
+  jmethodID ordinal = env->GetMethodID (env->GetObjectClass (enumCode), "ordinal", "()I");
+  if (!ordinal)
+    return -1;
 
-  env->Throw ((jthrowable)exception);
+  return env->CallIntMethod (enumCode, ordinal);
 }
@@ -2,15 +2,91 @@
 
 #include <jni.h>
 
+#include <iterator>
 #include <string>
 
 #include "util/pp_attributes.h"
+#include "util/pp_cat.h"
 
 
 void throw_tox_killed_exception (JNIEnv *env, jint instance_number, char const *message);
 void throw_illegal_state_exception (JNIEnv *env, jint instance_number, char const *message);
 void throw_illegal_state_exception (JNIEnv *env, jint instance_number, std::string const &message);
-void throw_tox_exception (JNIEnv *env, char const *module, char const *prefix, char const *method, char const *code);
+void throw_illegal_argument_exception (JNIEnv *env, jint instance_number, char const *message);
+
+/**
+ * A Tox exception class and its Code enum, for one toxcore error enum. The
+ * HANDLE macro defines one for each error enum in generated/errors.cpp, and
+ * TOX_EXCEPTIONS lists them in a table per subsystem. The description is
+ * constant-initialised; the cache is filled in JNI_OnLoad.
+ */
+struct tox_exception_class
+{
+  // Error enums have only a handful of members, so this covers all of them.
+  enum { max_codes = 32 };
+
+  char const *(*module) ();
+  char const *(*prefix) ();
+  char const *method;
+  // The Code enum member name for a C error code, or null for OK and unknown
+  // codes.
+  char const *(*code_name) (int error);
+
+  struct
+  {
+    jclass clazz;
+    // The (Code) constructor and the Code enum members with their ordinals,
+    // indexed by C error code.
+    jmethodID constructor;
+    jobject codes[max_codes];
+    jint ordinals[max_codes];
+  } cache;
+};
+
+/**
+ * The exception classes of a subsystem, usually defined with TOX_EXCEPTIONS.
+ */
+struct tox_exception_table
+{
+  tox_exception_class *const *begin;
+  tox_exception_class *const *end;
+};
+
+/**
+ * All exception tables, terminated by nullptr. Defined in Tox4j.cpp.
+ */
+extern tox_exception_table const *const tox_exception_tables[];
+
+#define TOX_EXCEPTIONS(table, ...)                                                  \
+  static tox_exception_class *const PP_CAT (table, _data)[] = { __VA_ARGS__ };      \
+  extern tox_exception_table const table;                                           \
+  tox_exception_table const table = {                                               \
+    std::begin (PP_CAT (table, _data)), std::end (PP_CAT (table, _data))            \
+  };
+
+
+/**
+ * Throw the exception for a C error code, whose Code enum member name is
+ * code. Once JNI_OnLoad has run, the class and member are found by index.
+ * Java-only codes, which have no C error code, are looked up by name.
+ */
+void throw_tox_exception (JNIEnv *env, tox_exception_class const &exception, int error, char const *code);
+
+/**
+ * Look up the ordinal of the Code enum member that throw_tox_exception would
+ * use for these arguments. Returns -1 with a pending Java exception if the
+ * enum or member does not exist.
+ */
+jint tox_exception_code_ordinal (JNIEnv *env, tox_exception_class const &exception, int error, char const *code);
+
+/**
+ * Create global references to all exception classes, their constructors and
+ * Code enum members, so that throwing no longer needs to look them up. Called
+ * from JNI_OnLoad, before any other thread can throw. Returns false with a
+ * pending Java exception if a class could not be found.
+ */
+bool cache_exception_classes (JNIEnv *env);
+void release_exception_classes (JNIEnv *env);
 
 
 PP_NORETURN void tox4j_fatal_error (JNIEnv *env, char const *message);
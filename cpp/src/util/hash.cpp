@@ -0,0 +1,165 @@
+#include "util/hash.h"
+
+#include <cstring>
+
+#if defined (__SSE2__)
+#include <emmintrin.h>
+#define HAVE_VECTOR_KERNEL 1
+#elif defined (__ARM_NEON) || defined (__ARM_NEON__)
+#include <arm_neon.h>
+#define HAVE_VECTOR_KERNEL 1
+#else
+#define HAVE_VECTOR_KERNEL 0
+#endif
+
+
+namespace
+{
+  // Bytes consumed per round by the four lanes.
+  std::size_t const BLOCK_SIZE = 32;
+
+  // The xxHash64 primes.
+  uint64_t const PRIME1 = 0x9e3779b185ebca87;
+  uint64_t const PRIME2 = 0xc2b2ae3d27d4eb4f;
+
+
+  uint64_t
+  load64 (uint8_t const *data)
+  {
+    uint64_t value;
+    std::memcpy (&value, data, sizeof value);
+    return value;
+  }
+
+
+  /**
+   * One lane step, the xxHash64 round: add 8 bytes multiplied by a prime,
+   * rotate, and multiply again. Both multiplies take all 64 bits, so every
+   * input bit reaches the high half of the lane, and no two values of one
+   * block give the same lane.
+   */
+  uint64_t
+  step (uint64_t lane, uint64_t value)
+  {
+    lane += value * PRIME2;
+    lane = (lane << 31) | (lane >> 33);
+    return lane * PRIME1;
+  }
+
+
+  uint64_t
+  avalanche (uint64_t value)
+  {
+    value ^= value >> 30;
+    value *= 0xbf58476d1ce4e5b9;
+    value ^= value >> 27;
+    value *= 0x94d049bb133111eb;
+    value ^= value >> 31;
+    return value;
+  }
+
+
+  template<bool Vector>
+  uint64_t
+  digest (uint8_t const *data, std::size_t length, uint64_t seed)
+  {
+    uint64_t lanes[4] = {
+      seed ^ 0x243f6a8885a308d3,
+      seed ^ 0x13198a2e03707344,
+      seed ^ 0xa4093822299f31d0,
+      seed ^ 0x082efa98ec4e6c89,
+    };
+
+    std::size_t i = 0;
+
+#if defined (__SSE2__)
+    if (Vector && length >= BLOCK_SIZE)
+      {
+        // SSE2 only multiplies 32 bit halves, so the low 64 bits of each
+        // product are put together from three of them.
+        auto const mul64 = [] (__m128i a, __m128i b, __m128i b_hi)
+          {
+            __m128i const cross = _mm_add_epi64 (_mm_mul_epu32 (_mm_srli_epi64 (a, 32), b), _mm_mul_epu32 (a, b_hi));
+            return _mm_add_epi64 (_mm_mul_epu32 (a, b), _mm_slli_epi64 (cross, 32));
+          };
+        auto const vector_step = [&] (__m128i lane, __m128i value)
+          {
+            __m128i const prime1 = _mm_set1_epi64x (PRIME1);
+            __m128i const prime2 = _mm_set1_epi64x (PRIME2);
+            lane = _mm_add_epi64 (lane, mul64 (value, prime2, _mm_srli_epi64 (prime2, 32)));
+            lane = _mm_or_si128 (_mm_slli_epi64 (lane, 31), _mm_srli_epi64 (lane, 33));
+            return mul64 (lane, prime1, _mm_srli_epi64 (prime1, 32));
+          };
+
+        __m128i lo = _mm_loadu_si128 (reinterpret_cast<__m128i const *> (lanes));
+        __m128i hi = _mm_loadu_si128 (reinterpret_cast<__m128i const *> (lanes + 2));
+        for (; i + BLOCK_SIZE <= length; i += BLOCK_SIZE)
+          {
+            lo = vector_step (lo, _mm_loadu_si128 (reinterpret_cast<__m128i const *> (data + i)));
+            hi = vector_step (hi, _mm_loadu_si128 (reinterpret_cast<__m128i const *> (data + i + 16)));
+          }
+        _mm_storeu_si128 (reinterpret_cast<__m128i *> (lanes), lo);
+        _mm_storeu_si128 (reinterpret_cast<__m128i *> (lanes + 2), hi);
+      }
+#elif defined (__ARM_NEON) || defined (__ARM_NEON__)
+    if (Vector && length >= BLOCK_SIZE)
+      {
+        // NEON has no 64 bit multiply either; see above.
+        auto const mul64 = [] (uint64x2_t a, uint64_t b)
+          {
+            uint32x2_t const b_lo = vdup_n_u32 (uint32_t (b));
+            uint32x2_t const b_hi = vdup_n_u32 (uint32_t (b >> 32));
+            uint32x2_t const a_lo = vmovn_u64 (a);
+            uint64x2_t const cross = vmlal_u32 (vmull_u32 (vshrn_n_u64 (a, 32), b_lo), a_lo, b_hi);
+            return vaddq_u64 (vmull_u32 (a_lo, b_lo), vshlq_n_u64 (cross, 32));
+          };
+        auto const vector_step = [&] (uint64x2_t lane, uint64x2_t value)
+          {
+            lane = vaddq_u64 (lane, mul64 (value, PRIME2));
+            lane = vorrq_u64 (vshlq_n_u64 (lane, 31), vshrq_n_u64 (lane, 33));
+            return mul64 (lane, PRIME1);
+          };
+
+        uint64x2_t lo = vld1q_u64 (lanes);
+        uint64x2_t hi = vld1q_u64 (lanes + 2);
+        for (; i + BLOCK_SIZE <= length; i += BLOCK_SIZE)
+          {
+            lo = vector_step (lo, vreinterpretq_u64_u8 (vld1q_u8 (data + i)));
+            hi = vector_step (hi, vreinterpretq_u64_u8 (vld1q_u8 (data + i + 16)));
+          }
+        vst1q_u64 (lanes, lo);
+        vst1q_u64 (lanes + 2, hi);
+      }
+#endif
+
+    for (; i + BLOCK_SIZE <= length; i += BLOCK_SIZE)
+      for (std::size_t lane = 0; lane < 4; lane++)
+        lanes[lane] = step (lanes[lane], load64 (data + i + lane * 8));
+
+    // The last partial block, zero padded.
+    uint8_t tail[BLOCK_SIZE] = { };
+    if (length > i)
+      std::memcpy (tail, data + i, length - i);
+    for (std::size_t lane = 0; lane < 4; lane++)
+      lanes[lane] = step (lanes[lane], load64 (tail + lane * 8));
+
+    uint64_t result = length;
+    for (uint64_t lane : lanes)
+      result = avalanche (result ^ lane);
+    return result;
+  }
+}
+
+
+uint64_t
+hash::digest (uint8_t const *data, std::size_t length, uint64_t seed)
+{
+  return ::digest<HAVE_VECTOR_KERNEL> (data, length, seed);
+}
+
+
+uint64_t
+hash::digest_scalar (uint8_t const *data, std::size_t length, uint64_t seed)
+{
+  return ::digest<false> (data, length, seed);
+}
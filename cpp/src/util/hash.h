@@ -0,0 +1,31 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+
+/*****************************************************************************
+ *
+ * Fast non-cryptographic hashing of large buffers, such as video frames.
+ *
+ *****************************************************************************/
+
+
+namespace hash
+{
+  /**
+   * A 64 bit digest of the bytes, for telling whether a buffer changed. Four
+   * independent lanes each take 8 bytes at a time through an xxHash64 round
+   * of full 64 bit multiplies, and are combined with a final avalanche step. Buffers differing
+   * only after length bytes have the same digest; the length itself is mixed
+   * in. Chaining digests through the seed hashes several buffers as one.
+   *
+   * Uses SSE2 or NEON when the target supports them.
+   */
+  uint64_t digest (uint8_t const *data, std::size_t length, uint64_t seed = 0);
+
+  /**
+   * The same without vector instructions. Both produce the same digest.
+   */
+  uint64_t digest_scalar (uint8_t const *data, std::size_t length, uint64_t seed = 0);
+}
@@ -0,0 +1,131 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+
+/*****************************************************************************
+ *
+ * Lock-free log-linear latency histogram.
+ *
+ *****************************************************************************/
+
+
+/**
+ * A fixed-size histogram in the style of HdrHistogram. Values are bucketed by
+ * their most significant bit, and each power of two is split into a number of
+ * linear sub-buckets, so the relative error of any reported percentile is
+ * bounded by 1 / sub_bucket_count.
+ *
+ * All counters are relaxed atomics, so record() can be called concurrently
+ * from any number of threads without locking or allocating. The type has no
+ * constructor, so objects with static storage duration are zero-initialised
+ * without any static initialisation code.
+ */
+struct latency_histogram
+{
+  static unsigned const sub_bucket_bits = 4;
+  static unsigned const max_value_bits = 40;
+
+  static std::uint64_t const sub_bucket_count = std::uint64_t (1) << sub_bucket_bits;
+  static std::size_t const bucket_count = (max_value_bits - sub_bucket_bits + 1) * sub_bucket_count;
+
+  /**
+   * A consistent-enough copy of the histogram, taken by snapshot().
+   */
+  struct summary
+  {
+    std::uint64_t count;
+    std::uint64_t errors;
+    std::uint64_t max;
+    std::uint64_t buckets[bucket_count];
+
+    /**
+     * Return the smallest bucket value below which the given fraction (0..1)
+     * of all recorded values fall.
+     */
+    std::uint64_t
+    percentile (double fraction) const
+    {
+      if (count == 0)
+        return 0;
+
+      std::uint64_t const rank = std::max<std::uint64_t> (1, std::uint64_t (fraction * count + 0.5));
+      std::uint64_t seen = 0;
+      for (std::size_t i = 0; i < bucket_count; i++)
+        {
+          seen += buckets[i];
+          if (seen >= rank)
+            return std::min (bucket_value (i), max);
+        }
+      return max;
+    }
+  };
+
+  /**
+   * Record a single value. Values above 2^max_value_bits are counted in the
+   * last bucket.
+   */
+  void
+  record (std::uint64_t value, bool error)
+  {
+    buckets[bucket_index (value)].fetch_add (1, std::memory_order_relaxed);
+    count.fetch_add (1, std::memory_order_relaxed);
+    if (error)
+      errors.fetch_add (1, std::memory_order_relaxed);
+
+    std::uint64_t current = max.load (std::memory_order_relaxed);
+    while (value > current && !max.compare_exchange_weak (current, value, std::memory_order_relaxed))
+      ;
+  }
+
+  /**
+   * Copy the current counts into a summary and reset the histogram. Values
+   * recorded concurrently with this call end up in either this or the next
+   * summary.
+   */
+  void
+  snapshot (summary &out)
+  {
+    out.count = count.exchange (0, std::memory_order_relaxed);
+    out.errors = errors.exchange (0, std::memory_order_relaxed);
+    out.max = max.exchange (0, std::memory_order_relaxed);
+    for (std::size_t i = 0; i < bucket_count; i++)
+      out.buckets[i] = buckets[i].exchange (0, std::memory_order_relaxed);
+  }
+
+  static std::size_t
+  bucket_index (std::uint64_t value)
+  {
+    if (value < sub_bucket_count)
+      return value;
+
+    unsigned msb = 63 - __builtin_clzll (value);
+    if (msb >= max_value_bits)
+      return bucket_count - 1;
+
+    unsigned exponent = msb - sub_bucket_bits + 1;
+    std::uint64_t mantissa = value >> (exponent - 1);
+    return exponent * sub_bucket_count + (mantissa - sub_bucket_count);
+  }
+
+  /**
+   * The highest value that maps to the given bucket.
+   */
+  static std::uint64_t
+  bucket_value (std::size_t index)
+  {
+    std::uint64_t exponent = index / sub_bucket_count;
+    std::uint64_t mantissa = index % sub_bucket_count;
+    if (exponent == 0)
+      return mantissa;
+    return ((sub_bucket_count + mantissa + 1) << (exponent - 1)) - 1;
+  }
+
+  std::atomic<std::uint64_t> count;
+  std::atomic<std::uint64_t> errors;
+  std::atomic<std::uint64_t> max;
+  std::atomic<std::uint64_t> buckets[bucket_count];
+};
@@ -2,6 +2,7 @@
 
 #include <jni.h>
 
+#include <cstddef>
 #include <cstdint>
 #include <memory>
 
@@ -39,12 +40,34 @@ struct JavaArrayDeleter
 };
 
 
+/**
+ * Arrays of up to this many bytes are copied into the MakeArrayFromJava
+ * object itself, unless the call site asks for a different size.
+ */
+static std::size_t const default_inline_bytes = 256;
+
+
+/**
+ * A read-only view of a Java array's contents.
+ *
+ * Arrays of up to InlineBytes bytes are copied with Get<Type>ArrayRegion into
+ * a buffer inside this object, which lives on the caller's stack. This avoids
+ * the malloc and free that Get<Type>ArrayElements does on most JVMs, which
+ * dominates the cost for keys and short messages. Larger arrays still use
+ * Get<Type>ArrayElements. GetPrimitiveArrayCritical is not an option here,
+ * since the array stays alive while we lock instances and throw exceptions,
+ * and no JNI calls are allowed inside a critical region.
+ *
+ * The array length is read once at construction.
+ */
 template<
   typename JType,
   typename CType,
   typename JavaArray,
   JType *(JNIEnv::*GetArrayElements) (JavaArray, jboolean *),
-  void (JNIEnv::*ReleaseArrayElements) (JavaArray, JType *, jint)
+  void (JNIEnv::*ReleaseArrayElements) (JavaArray, JType *, jint),
+  void (JNIEnv::*GetArrayRegion) (JavaArray, jsize, jsize, JType *),
+  std::size_t InlineBytes
 >
 struct MakeArrayFromJava
 {
@@ -52,17 +75,25 @@ struct MakeArrayFromJava
     JavaArrayDeleter<JType, JavaArray, ReleaseArrayElements>
   > array_pointer;
 
+  static std::size_t const inline_size = (InlineBytes + sizeof (JType) - 1) / sizeof (JType);
+
   MakeArrayFromJava (JNIEnv *env, JavaArray jArray)
-    : cArray (
-        jArray ? (env->*GetArrayElements) (jArray, nullptr) : nullptr,
-        typename array_pointer::deleter_type (env, jArray)
-      )
+    : length (jArray ? env->GetArrayLength (jArray) : 0)
+    , cArray (nullptr, typename array_pointer::deleter_type (env, jArray))
   {
+    if (length > inline_size)
+      cArray.reset ((env->*GetArrayElements) (jArray, nullptr));
+    else if (length != 0)
+      (env->*GetArrayRegion) (jArray, 0, length, inline_data);
   }
 
   CType const *begin () const { return data (); }
   CType const *end   () const { return data () + size (); }
 
+  /**
+   * Returns null if the Java array was null. The pointer is computed on every
+   * call, because it points into this object for small arrays.
+   */
   CType const *
   data () const
   {
@@ -70,43 +101,75 @@ struct MakeArrayFromJava
       "Java array element type should be the same as the C element type modulo signedness");
     static_assert (sizeof (JType) == sizeof (CType),
       "Size requirements for Java array not met");
-    return reinterpret_cast<CType const *> (cArray.get ());
+    if (!jArray ())
+      return nullptr;
+    return reinterpret_cast<CType const *> (cArray ? cArray.get () : inline_data);
   }
 
-  size_t size () const { return jArray () ? env ()->GetArrayLength (jArray ()) : 0; }
+  size_t size () const { return length; }
   bool empty () const { return size () == 0; }
 
 private:
-  JNIEnv *env      () const { return cArray.get_deleter ().env   ; }
   JavaArray jArray () const { return cArray.get_deleter ().jArray; }
 
+  std::size_t length;
   array_pointer cArray;
+  JType inline_data[inline_size];
 };
 
 
-template<typename JavaArray>
+template<typename JavaArray, std::size_t InlineBytes>
 struct ArrayFromJava;
 
-template<> struct ArrayFromJava<jbooleanArray> { typedef MakeArrayFromJava<jboolean, bool    , jbooleanArray, &JNIEnv::GetBooleanArrayElements, &JNIEnv::ReleaseBooleanArrayElements> type; };
-template<> struct ArrayFromJava<jbyteArray   > { typedef MakeArrayFromJava<jbyte   , uint8_t , jbyteArray   , &JNIEnv::GetByteArrayElements   , &JNIEnv::ReleaseByteArrayElements   > type; };
-template<> struct ArrayFromJava<jcharArray   > { typedef MakeArrayFromJava<jchar   , uint16_t, jcharArray   , &JNIEnv::GetCharArrayElements   , &JNIEnv::ReleaseCharArrayElements   > type; };
-template<> struct ArrayFromJava<jshortArray  > { typedef MakeArrayFromJava<jshort  , int16_t , jshortArray  , &JNIEnv::GetShortArrayElements  , &JNIEnv::ReleaseShortArrayElements  > type; };
-template<> struct ArrayFromJava<jintArray    > { typedef MakeArrayFromJava<jint    , int32_t , jintArray    , &JNIEnv::GetIntArrayElements    , &JNIEnv::ReleaseIntArrayElements    > type; };
-template<> struct ArrayFromJava<jlongArray   > { typedef MakeArrayFromJava<jlong   , int64_t , jlongArray   , &JNIEnv::GetLongArrayElements   , &JNIEnv::ReleaseLongArrayElements   > type; };
-template<> struct ArrayFromJava<jfloatArray  > { typedef MakeArrayFromJava<jfloat  , float   , jfloatArray  , &JNIEnv::GetFloatArrayElements  , &JNIEnv::ReleaseFloatArrayElements  > type; };
-template<> struct ArrayFromJava<jdoubleArray > { typedef MakeArrayFromJava<jdouble , double  , jdoubleArray , &JNIEnv::GetDoubleArrayElements , &JNIEnv::ReleaseDoubleArrayElements > type; };
+#define ARRAY_FROM_JAVA(JType, CType, Type)                                   \
+template<std::size_t InlineBytes>                                             \
+struct ArrayFromJava<JType##Array, InlineBytes>                               \
+{                                                                             \
+  typedef MakeArrayFromJava<JType, CType, JType##Array,                       \
+    &JNIEnv::Get##Type##ArrayElements,                                        \
+    &JNIEnv::Release##Type##ArrayElements,                                    \
+    &JNIEnv::Get##Type##ArrayRegion,                                          \
+    InlineBytes                                                               \
+  > type;                                                                     \
+}
+
+ARRAY_FROM_JAVA (jboolean, bool    , Boolean);
+ARRAY_FROM_JAVA (jbyte   , uint8_t , Byte   );
+ARRAY_FROM_JAVA (jchar   , uint16_t, Char   );
+ARRAY_FROM_JAVA (jshort  , int16_t , Short  );
+ARRAY_FROM_JAVA (jint    , int32_t , Int    );
+ARRAY_FROM_JAVA (jlong   , int64_t , Long   );
+ARRAY_FROM_JAVA (jfloat  , float   , Float  );
+ARRAY_FROM_JAVA (jdouble , double  , Double );
+
+#undef ARRAY_FROM_JAVA
 
 
 }
 
 
-template<typename JavaArray>
-using ArrayFromJava = typename detail::ArrayFromJava<JavaArray>::type;
+template<typename JavaArray, std::size_t InlineBytes = detail::default_inline_bytes>
+using ArrayFromJava = typename detail::ArrayFromJava<JavaArray, InlineBytes>::type;
 
 
+/**
+ * Access a Java array from C++, copying it into the returned object if it is
+ * small.
+ */
 template<typename JavaArray>
 auto
 fromJavaArray (JNIEnv *env, JavaArray jArray)
 {
   return ArrayFromJava<JavaArray> (env, jArray);
 }
+
+/**
+ * The same as above, but with a call-site specific inline size, e.g. the
+ * exact size of a key. Arrays of up to InlineBytes bytes are copied.
+ */
+template<std::size_t InlineBytes, typename JavaArray>
+auto
+fromJavaArray (JNIEnv *env, JavaArray jArray)
+{
+  return ArrayFromJava<JavaArray, InlineBytes> (env, jArray);
+}
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <jni.h>
+
+#include <cstddef>
+#include <cstdint>
+
+
+/*****************************************************************************
+ *
+ * Direct java.nio.ByteBuffer regions as C++ arrays.
+ *
+ *****************************************************************************/
+
+
+/**
+ * A read-only view of a region inside a direct ByteBuffer, with the offset
+ * given in bytes and the length in elements of type T. Both are jlong, so
+ * that callers can compute them from jint arguments without overflow. Unlike Java arrays,
+ * direct buffers don't move, so the memory is used in place without copying
+ * or pinning anything.
+ *
+ * If the buffer is null, not direct, the region is out of bounds, or the
+ * region start is not aligned for T, the view is invalid and data () is
+ * null.
+ */
+template<typename T>
+struct DirectBuffer
+{
+  DirectBuffer (JNIEnv *env, jobject buffer, jlong offset, jlong length)
+    : address (nullptr)
+    , length (0)
+  {
+    if (buffer == nullptr || offset < 0 || length < 0)
+      return;
+
+    auto *base = static_cast<std::uint8_t *> (env->GetDirectBufferAddress (buffer));
+    jlong capacity = env->GetDirectBufferCapacity (buffer);
+    if (base == nullptr || offset + length * jlong (sizeof (T)) > capacity)
+      return;
+
+    if (reinterpret_cast<std::uintptr_t> (base + offset) % alignof (T) != 0)
+      return;
+
+    this->address = reinterpret_cast<T const *> (base + offset);
+    this->length = length;
+  }
+
+  T const *begin () const { return data (); }
+  T const *end   () const { return data () + size (); }
+
+  T const *data () const { return address; }
+  std::size_t size () const { return length; }
+  bool empty () const { return size () == 0; }
+
+  explicit operator bool () const { return address != nullptr; }
+
+private:
+  T const *address;
+  std::size_t length;
+};
+
+
+template<typename T>
+DirectBuffer<T>
+fromDirectBuffer (JNIEnv *env, jobject buffer, jlong offset, jlong length)
+{
+  return DirectBuffer<T> (env, buffer, offset, length);
+}
@@ -0,0 +1,171 @@
+#include "util/mixer.h"
+
+#include <algorithm>
+#include <cassert>
+
+#if defined (__SSE2__)
+#include <emmintrin.h>
+#define HAVE_VECTOR_KERNEL 1
+#elif defined (__ARM_NEON) || defined (__ARM_NEON__)
+#include <arm_neon.h>
+#define HAVE_VECTOR_KERNEL 1
+#else
+#define HAVE_VECTOR_KERNEL 0
+#endif
+
+using namespace mixer;
+
+
+namespace
+{
+  // Number of samples mixed per vector kernel call.
+  std::size_t const KERNEL_WIDTH = 8;
+
+
+  int16_t
+  saturate (int32_t value)
+  {
+    return value < INT16_MIN ? INT16_MIN : value > INT16_MAX ? INT16_MAX : value;
+  }
+
+
+#if defined (__SSE2__)
+  void
+  mix_minus_kernel (int16_t *dest, int32_t const *sum, int16_t const *own)
+  {
+    __m128i lo = _mm_loadu_si128 (reinterpret_cast<__m128i const *> (sum));
+    __m128i hi = _mm_loadu_si128 (reinterpret_cast<__m128i const *> (sum + 4));
+    if (own != nullptr)
+      {
+        // Sign-extend the own samples by unpacking them into the high halves
+        // and shifting them back down.
+        __m128i const samples = _mm_loadu_si128 (reinterpret_cast<__m128i const *> (own));
+        lo = _mm_sub_epi32 (lo, _mm_srai_epi32 (_mm_unpacklo_epi16 (samples, samples), 16));
+        hi = _mm_sub_epi32 (hi, _mm_srai_epi32 (_mm_unpackhi_epi16 (samples, samples), 16));
+      }
+    _mm_storeu_si128 (reinterpret_cast<__m128i *> (dest), _mm_packs_epi32 (lo, hi));
+  }
+#elif defined (__ARM_NEON) || defined (__ARM_NEON__)
+  void
+  mix_minus_kernel (int16_t *dest, int32_t const *sum, int16_t const *own)
+  {
+    int32x4_t lo = vld1q_s32 (sum);
+    int32x4_t hi = vld1q_s32 (sum + 4);
+    if (own != nullptr)
+      {
+        int16x8_t const samples = vld1q_s16 (own);
+        lo = vsubw_s16 (lo, vget_low_s16 (samples));
+        hi = vsubw_s16 (hi, vget_high_s16 (samples));
+      }
+    vst1q_s16 (dest, vcombine_s16 (vqmovn_s32 (lo), vqmovn_s32 (hi)));
+  }
+#endif
+
+
+  template<bool Vector>
+  void
+  mix (int16_t *dest, int32_t const *sum, int16_t const *own, std::size_t count)
+  {
+    std::size_t i = 0;
+
+#if HAVE_VECTOR_KERNEL
+    if (Vector)
+      for (; i + KERNEL_WIDTH <= count; i += KERNEL_WIDTH)
+        mix_minus_kernel (dest + i, sum + i, own != nullptr ? own + i : nullptr);
+#endif
+
+    for (; i < count; i++)
+      dest[i] = saturate (sum[i] - (own != nullptr ? own[i] : 0));
+  }
+}
+
+
+void
+mixer::accumulate (int32_t *sum, int16_t const *pcm, std::size_t count)
+{
+  // A plain loop that the compiler vectorises; there is no saturation here.
+  for (std::size_t i = 0; i < count; i++)
+    sum[i] += pcm[i];
+}
+
+
+void
+mixer::mix_minus (int16_t *dest, int32_t const *sum, int16_t const *own, std::size_t count)
+{
+  mix<true> (dest, sum, own, count);
+}
+
+
+void
+mixer::mix_minus_scalar (int16_t *dest, int32_t const *sum, int16_t const *own, std::size_t count)
+{
+  mix<false> (dest, sum, own, count);
+}
+
+
+/*****************************************************************************
+ *
+ * Jitter buffer.
+ *
+ *****************************************************************************/
+
+
+jitter_buffer::jitter_buffer (std::size_t frame_size, std::size_t depth)
+  : frame_size (frame_size)
+  , depth (std::max<std::size_t> (depth, 1))
+  , ring (frame_size * this->depth * 2)
+{
+  assert (frame_size != 0);
+}
+
+
+void
+jitter_buffer::push (int16_t const *pcm, std::size_t count)
+{
+  std::size_t const capacity = ring.size ();
+  if (count > capacity)
+    {
+      pcm += count - capacity;
+      count = capacity;
+    }
+
+  // Drop the oldest samples to make room.
+  if (length + count > capacity)
+    {
+      std::size_t const dropped = length + count - capacity;
+      head = (head + dropped) % capacity;
+      length -= dropped;
+    }
+
+  std::size_t const tail = (head + length) % capacity;
+  std::size_t const first = std::min (count, capacity - tail);
+  std::copy (pcm, pcm + first, ring.begin () + tail);
+  std::copy (pcm + first, pcm + count, ring.begin ());
+  length += count;
+
+  if (length >= frame_size * depth)
+    playing = true;
+}
+
+
+bool
+jitter_buffer::pop (int16_t *frame)
+{
+  if (!playing)
+    return false;
+
+  if (length < frame_size)
+    {
+      // Underrun: wait for the buffer to fill up again.
+      playing = false;
+      return false;
+    }
+
+  std::size_t const capacity = ring.size ();
+  std::size_t const first = std::min (frame_size, capacity - head);
+  std::copy (ring.begin () + head, ring.begin () + head + first, frame);
+  std::copy (ring.begin (), ring.begin () + (frame_size - first), frame + first);
+  head = (head + frame_size) % capacity;
+  length -= frame_size;
+  return true;
+}
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+
+/*****************************************************************************
+ *
+ * Mixing of interleaved 16 bit PCM audio for conference calls.
+ *
+ *****************************************************************************/
+
+
+namespace mixer
+{
+  /**
+   * Add samples to 32 bit sums. These cannot overflow for fewer than 65536
+   * streams, so the order in which streams are added does not matter.
+   */
+  void accumulate (int32_t *sum, int16_t const *pcm, std::size_t count);
+
+  /**
+   * Write the sums minus one stream's own samples, saturated to 16 bits. This
+   * gives each participant the mix of everybody else without summing the
+   * other streams once per participant. own is null for a stream that did
+   * not contribute to the sums.
+   *
+   * Uses SSE2 or NEON when the target supports them.
+   */
+  void mix_minus (int16_t *dest, int32_t const *sum, int16_t const *own, std::size_t count);
+
+  /**
+   * The same without vector instructions, for testing the vector versions.
+   */
+  void mix_minus_scalar (int16_t *dest, int32_t const *sum, int16_t const *own, std::size_t count);
+
+  /**
+   * A FIFO of interleaved samples, taken out in fixed size frames. Playout
+   * starts once depth frames are buffered, which absorbs variations in
+   * packet arrival, and starts over after an underrun. Beyond twice the
+   * depth, the oldest samples are dropped, so a sender with a fast clock
+   * cannot make the latency grow without bounds.
+   */
+  struct jitter_buffer
+  {
+    jitter_buffer (std::size_t frame_size, std::size_t depth);
+
+    void push (int16_t const *pcm, std::size_t count);
+
+    /**
+     * Take the next frame_size samples. Returns false, leaving frame
+     * untouched, while the buffer is filling up.
+     */
+    bool pop (int16_t *frame);
+
+    std::size_t size () const { return length; }
+
+  private:
+    std::size_t frame_size;
+    std::size_t depth;
+    std::vector<int16_t> ring;
+    std::size_t head = 0;
+    std::size_t length = 0;
+    bool playing = false;
+  };
+}
@@ -0,0 +1,200 @@
+#include "util/resampler.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+
+#if defined (__SSE__)
+#include <xmmintrin.h>
+#elif defined (__ARM_NEON) || defined (__ARM_NEON__)
+#include <arm_neon.h>
+#endif
+
+using namespace resampler;
+
+
+namespace
+{
+  // Taps per phase when not reducing the rate. Downsampling lowers the
+  // cutoff, so it needs proportionally more.
+  std::size_t const BASE_TAPS = 16;
+
+  // Fraction of the lower Nyquist frequency that passes the filter.
+  double const PASSBAND = 0.9;
+
+  double const PI = 3.14159265358979323846;
+
+
+  uint32_t
+  gcd (uint32_t a, uint32_t b)
+  {
+    while (b != 0)
+      {
+        uint32_t const rest = a % b;
+        a = b;
+        b = rest;
+      }
+    return a;
+  }
+
+
+  /**
+   * Taps per phase for a rate change of up/down.
+   */
+  std::size_t
+  filter_taps (uint32_t up, uint32_t down)
+  {
+    double const ratio = std::max (1.0, double (down) / up);
+    return std::size_t (std::ceil (BASE_TAPS * ratio / 8)) * 8;
+  }
+
+
+  int16_t
+  saturate (float value)
+  {
+    return value < INT16_MIN ? INT16_MIN : value > INT16_MAX ? INT16_MAX : int16_t (std::lrint (value));
+  }
+
+
+  /**
+   * The dot product of two arrays of a multiple of 8 floats.
+   */
+  float
+  dot_product (float const *a, float const *b, std::size_t count)
+  {
+#if defined (__SSE__)
+    __m128 sum0 = _mm_setzero_ps ();
+    __m128 sum1 = _mm_setzero_ps ();
+    for (std::size_t i = 0; i < count; i += 8)
+      {
+        sum0 = _mm_add_ps (sum0, _mm_mul_ps (_mm_loadu_ps (a + i    ), _mm_loadu_ps (b + i    )));
+        sum1 = _mm_add_ps (sum1, _mm_mul_ps (_mm_loadu_ps (a + i + 4), _mm_loadu_ps (b + i + 4)));
+      }
+    float lanes[4];
+    _mm_storeu_ps (lanes, _mm_add_ps (sum0, sum1));
+    return (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+#elif defined (__ARM_NEON) || defined (__ARM_NEON__)
+    float32x4_t sum0 = vdupq_n_f32 (0);
+    float32x4_t sum1 = vdupq_n_f32 (0);
+    for (std::size_t i = 0; i < count; i += 8)
+      {
+        sum0 = vmlaq_f32 (sum0, vld1q_f32 (a + i    ), vld1q_f32 (b + i    ));
+        sum1 = vmlaq_f32 (sum1, vld1q_f32 (a + i + 4), vld1q_f32 (b + i + 4));
+      }
+    float lanes[4];
+    vst1q_f32 (lanes, vaddq_f32 (sum0, sum1));
+    return (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+#else
+    float sum = 0;
+    for (std::size_t i = 0; i < count; i++)
+      sum += a[i] * b[i];
+    return sum;
+#endif
+  }
+}
+
+
+uint32_t const polyphase::MAX_RATE;
+std::size_t const polyphase::MAX_COEFFICIENTS;
+
+
+bool
+polyphase::supported (uint32_t input_rate, uint32_t output_rate)
+{
+  if (input_rate == 0 || input_rate > MAX_RATE || output_rate == 0 || output_rate > MAX_RATE)
+    return false;
+
+  uint32_t const divisor = gcd (input_rate, output_rate);
+  uint32_t const up = output_rate / divisor;
+  uint32_t const down = input_rate / divisor;
+  return filter_taps (up, down) * up <= MAX_COEFFICIENTS;
+}
+
+
+polyphase::polyphase (uint32_t input_rate, uint8_t input_channels,
+                      uint32_t output_rate, uint8_t output_channels)
+  : input_rate (input_rate)
+  , input_channels (input_channels)
+  , output_rate (output_rate)
+  , output_channels (output_channels)
+  , up (output_rate / gcd (input_rate, output_rate))
+  , down (input_rate / gcd (input_rate, output_rate))
+  , channels (std::min (input_channels, output_channels))
+{
+  assert (supported (input_rate, output_rate));
+  assert (input_channels == 1 || input_channels == 2);
+  assert (output_channels == 1 || output_channels == 2);
+
+  double const ratio = std::max (1.0, double (down) / up);
+  taps = filter_taps (up, down);
+
+  // Windowed sinc at the upsampled rate, cut off below the lower of the two
+  // Nyquist frequencies.
+  std::size_t const length = taps * up;
+  double const cutoff = PASSBAND * 0.5 / (up * ratio);
+  coefficients.resize (length);
+  for (uint32_t p = 0; p < up; p++)
+    {
+      float *phase_coefficients = &coefficients[p * taps];
+      double sum = 0;
+      for (std::size_t k = 0; k < taps; k++)
+        {
+          std::size_t const i = p + k * up;
+          double const t = i - (length - 1) / 2.0;
+          double const sinc = t == 0 ? 1 : std::sin (2 * PI * cutoff * t) / (2 * PI * cutoff * t);
+          double const window = 0.42
+                              - 0.50 * std::cos (2 * PI * (i + 0.5) / length)
+                              + 0.08 * std::cos (4 * PI * (i + 0.5) / length);
+          phase_coefficients[taps - 1 - k] = sinc * window;
+          sum += sinc * window;
+        }
+
+      // Unity gain in every phase, so that a constant signal stays constant.
+      for (std::size_t k = 0; k < taps; k++)
+        phase_coefficients[k] /= sum;
+    }
+
+  history.assign (channels, std::vector<float> (taps - 1));
+}
+
+
+void
+polyphase::process (int16_t const *pcm, std::size_t sample_count, std::vector<int16_t> &output)
+{
+  for (uint8_t c = 0; c < channels; c++)
+    {
+      std::vector<float> &window = history[c];
+      std::size_t const offset = window.size ();
+      window.resize (offset + sample_count);
+      for (std::size_t i = 0; i < sample_count; i++)
+        {
+          if (input_channels == channels)
+            window[offset + i] = pcm[i * input_channels + c];
+          else
+            window[offset + i] = (pcm[i * 2] + pcm[i * 2 + 1]) * 0.5f;
+        }
+    }
+
+  std::size_t const available = history[0].size ();
+  while (start + taps <= available)
+    {
+      float const *phase_coefficients = &coefficients[phase * taps];
+      for (uint8_t c = 0; c < channels; c++)
+        {
+          int16_t const sample = saturate (dot_product (phase_coefficients, &history[c][start], taps));
+          output.push_back (sample);
+          if (output_channels > channels)
+            output.push_back (sample);
+        }
+
+      phase += down;
+      start += phase / up;
+      phase %= up;
+    }
+
+  // When downsampling, the next window may start beyond the input so far.
+  std::size_t const consumed = std::min (start, available);
+  for (std::vector<float> &window : history)
+    window.erase (window.begin (), window.begin () + consumed);
+  start -= consumed;
+}
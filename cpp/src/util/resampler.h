@@ -0,0 +1,81 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+
+/*****************************************************************************
+ *
+ * Sampling rate and channel conversion of interleaved 16 bit PCM audio.
+ *
+ *****************************************************************************/
+
+
+namespace resampler
+{
+  /**
+   * A polyphase FIR resampler for one stream. The ratio between the rates is
+   * reduced to L/M, and each output sample is the dot product of one of the
+   * L phases of a windowed sinc low-pass filter with the latest input
+   * samples. Input history and the current phase carry over between calls,
+   * so a stream can be converted in frames of any size without clicks at
+   * frame boundaries.
+   *
+   * Stereo is mixed down to mono before filtering, and mono is duplicated to
+   * stereo after it, so the filter runs on the smaller channel count.
+   *
+   * The dot products use SSE or NEON when the target supports them.
+   */
+  struct polyphase
+  {
+    polyphase (uint32_t input_rate, uint8_t input_channels,
+               uint32_t output_rate, uint8_t output_channels);
+
+    /**
+     * Whether a resampler between these rates can be built. Both rates must
+     * be between 1 and MAX_RATE, and the filter must have no more than
+     * MAX_COEFFICIENTS coefficients. Rates that share few factors reduce
+     * to a large L, and the filter has L phases.
+     */
+    static bool supported (uint32_t input_rate, uint32_t output_rate);
+
+    static uint32_t const MAX_RATE = 192000;
+    static std::size_t const MAX_COEFFICIENTS = 1 << 16;
+
+    /**
+     * Whether this converts from the given format.
+     */
+    bool
+    converts (uint32_t input_rate, uint8_t input_channels) const
+    {
+      return input_rate == this->input_rate && input_channels == this->input_channels;
+    }
+
+    /**
+     * Convert sample_count samples per channel, appending the result to
+     * output.
+     */
+    void process (int16_t const *pcm, std::size_t sample_count, std::vector<int16_t> &output);
+
+    uint32_t const input_rate;
+    uint8_t const input_channels;
+    uint32_t const output_rate;
+    uint8_t const output_channels;
+
+  private:
+    uint32_t up;        // L
+    uint32_t down;      // M
+    std::size_t taps;   // Per phase, a multiple of 8.
+    uint8_t channels;   // Filtered channels.
+
+    // The coefficients of each phase, reversed so that they line up with
+    // the input window in memory.
+    std::vector<float> coefficients;
+    // Per filtered channel: the input window, starting at the oldest sample
+    // the next output needs.
+    std::vector<std::vector<float>> history;
+    std::size_t start = 0;
+    uint32_t phase = 0;
+  };
+}
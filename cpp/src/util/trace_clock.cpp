@@ -0,0 +1,114 @@
+#include "util/trace_clock.h"
+
+#include <chrono>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <cpuid.h>
+#endif
+
+using std::chrono::duration_cast;
+using std::chrono::nanoseconds;
+using std::chrono::steady_clock;
+using std::chrono::system_clock;
+
+
+static bool
+has_invariant_tsc ()
+{
+#if defined(__x86_64__) || defined(__i386__)
+  unsigned eax, ebx, ecx, edx;
+  if (__get_cpuid (0x80000000, &eax, &ebx, &ecx, &edx) && eax >= 0x80000007)
+    {
+      __get_cpuid (0x80000007, &eax, &ebx, &ecx, &edx);
+      return edx & (1 << 8);
+    }
+#endif
+  return false;
+}
+
+bool const trace_clock::use_tsc = has_invariant_tsc ();
+
+
+std::uint64_t
+trace_clock::steady_ticks ()
+{
+  return duration_cast<nanoseconds> (steady_clock::now ().time_since_epoch ()).count ();
+}
+
+
+namespace
+{
+  struct calibration
+  {
+    double nanos_per_tick;
+    std::uint64_t anchor_ticks;
+    std::int64_t anchor_epoch_nanos;
+  };
+
+  calibration
+  measure ()
+  {
+    calibration result;
+    result.nanos_per_tick = 1.0;
+
+    if (trace_clock::use_tsc)
+      {
+        // Measure the TSC rate over a millisecond of steady_clock time.
+        auto const steady_start = steady_clock::now ();
+        std::uint64_t const tsc_start = trace_clock::ticks ();
+
+        auto steady_end = steady_start;
+        while (steady_end - steady_start < std::chrono::milliseconds (1))
+          steady_end = steady_clock::now ();
+        std::uint64_t const tsc_end = trace_clock::ticks ();
+
+        result.nanos_per_tick =
+          double (duration_cast<nanoseconds> (steady_end - steady_start).count ())
+            / (tsc_end - tsc_start);
+      }
+
+    result.anchor_ticks = trace_clock::ticks ();
+    result.anchor_epoch_nanos =
+      duration_cast<nanoseconds> (system_clock::now ().time_since_epoch ()).count ();
+
+    return result;
+  }
+
+  calibration const &
+  get_calibration ()
+  {
+    static calibration const calibration = measure ();
+    return calibration;
+  }
+}
+
+
+std::atomic<bool> trace_clock::calibrated;
+
+
+void
+trace_clock::calibrate ()
+{
+  get_calibration ();
+  calibrated.store (true, std::memory_order_release);
+}
+
+
+std::uint64_t
+trace_clock::to_nanos (std::uint64_t ticks)
+{
+  if (!use_tsc)
+    return ticks;
+  return ticks * get_calibration ().nanos_per_tick;
+}
+
+
+std::uint64_t
+trace_clock::to_epoch_nanos (std::uint64_t ticks)
+{
+  calibration const &calibration = get_calibration ();
+
+  // Readings taken before the anchor result in a negative offset.
+  std::int64_t const offset = ticks - calibration.anchor_ticks;
+  return calibration.anchor_epoch_nanos + std::int64_t (offset * calibration.nanos_per_tick);
+}
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+
+/*****************************************************************************
+ *
+ * Low-overhead monotonic clock for call tracing.
+ *
+ *****************************************************************************/
+
+
+namespace trace_clock
+{
+  /**
+   * Whether ticks () reads the CPU's time stamp counter. This is only the case
+   * on x86 CPUs with an invariant TSC, which ticks at a constant rate
+   * regardless of frequency scaling and sleep states. Everywhere else, ticks
+   * are steady_clock nanoseconds.
+   */
+  extern bool const use_tsc;
+
+  std::uint64_t steady_ticks ();
+
+  /**
+   * Read the clock. The unit is unspecified; use to_nanos to convert a
+   * difference between two readings to nanoseconds.
+   */
+  inline std::uint64_t
+  ticks ()
+  {
+#if defined(__x86_64__) || defined(__i386__)
+    if (use_tsc)
+      return __rdtsc ();
+#endif
+    return steady_ticks ();
+  }
+
+  extern std::atomic<bool> calibrated;
+  void calibrate ();
+
+  /**
+   * Calibrate the TSC against steady_clock if that hasn't happened yet. This
+   * takes about a millisecond once per process, so it should be called before
+   * taking the first reading of a measurement, not in between.
+   */
+  inline void
+  ensure_calibrated ()
+  {
+    if (!calibrated.load (std::memory_order_acquire))
+      calibrate ();
+  }
+
+  /**
+   * Convert a tick count to nanoseconds.
+   */
+  std::uint64_t to_nanos (std::uint64_t ticks);
+
+  /**
+   * Convert a clock reading to nanoseconds since the Unix epoch. Readings are
+   * anchored to the wall clock once, so that consecutive timestamps never go
+   * backwards even if the system time is adjusted.
+   */
+  std::uint64_t to_epoch_nanos (std::uint64_t ticks);
+}
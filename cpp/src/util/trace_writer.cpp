@@ -0,0 +1,148 @@
+#include "util/trace_writer.h"
+#include "util/logging.h"
+
+#include <google/protobuf/io/coded_stream.h>
+
+#include <algorithm>
+#include <cassert>
+#include <cerrno>
+#include <cstring>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+using google::protobuf::io::CodedOutputStream;
+
+
+trace_writer::trace_writer (std::string path, std::size_t segment_size)
+  : path (std::move (path))
+  , segment_size (segment_size)
+{
+  // Open the first segment synchronously, so that the caller can report an
+  // invalid path.
+  if (open_segment (0))
+    thread = std::thread (&trace_writer::run, this);
+}
+
+
+trace_writer::~trace_writer ()
+{
+  {
+    std::lock_guard<std::mutex> lock (mutex);
+    stopping = true;
+  }
+  ready.notify_one ();
+  if (thread.joinable ())
+    thread.join ();
+}
+
+
+void
+trace_writer::push (std::unique_ptr<protolog::JniLogEntry> entry)
+{
+  {
+    std::lock_guard<std::mutex> lock (mutex);
+    queue.push_back (std::move (entry));
+  }
+  ready.notify_one ();
+}
+
+
+void
+trace_writer::run ()
+{
+  std::vector<std::unique_ptr<protolog::JniLogEntry>> batch;
+
+  std::unique_lock<std::mutex> lock (mutex);
+  while (true)
+    {
+      ready.wait (lock, [this] { return stopping || !queue.empty (); });
+      if (queue.empty ())
+        break;
+
+      // Write the batch outside the lock, so that push never waits for I/O.
+      batch.swap (queue);
+      lock.unlock ();
+      for (auto const &entry : batch)
+        write (*entry);
+      batch.clear ();
+      lock.lock ();
+    }
+
+  close_segment ();
+}
+
+
+void
+trace_writer::write (protolog::JniLogEntry const &entry)
+{
+  std::size_t const size = entry.ByteSizeLong ();
+  std::size_t const record_size = CodedOutputStream::VarintSize32 (size) + size;
+
+  if (map == nullptr || offset + record_size > map_size)
+    {
+      close_segment ();
+      // A single record larger than the segment size gets its own segment.
+      if (!open_segment (record_size))
+        return;
+    }
+
+  std::uint8_t *target = map + offset;
+  target = CodedOutputStream::WriteVarint32ToArray (size, target);
+  target = entry.SerializeWithCachedSizesToArray (target);
+  offset = target - map;
+}
+
+
+bool
+trace_writer::open_segment (std::size_t min_size)
+{
+  assert (map == nullptr);
+
+  std::string const name = path + "." + std::to_string (segment_index++);
+  std::size_t const size = std::max (segment_size, min_size);
+
+  fd = open (name.c_str (), O_RDWR | O_CREAT | O_TRUNC, 0644);
+  if (fd == -1)
+    {
+      LOG (ERROR) << "Could not create trace file " << name << ": " << std::strerror (errno);
+      return false;
+    }
+
+  void *mapping = MAP_FAILED;
+  if (ftruncate (fd, size) == 0)
+    mapping = mmap (nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+
+  if (mapping == MAP_FAILED)
+    {
+      LOG (ERROR) << "Could not map trace file " << name << ": " << std::strerror (errno);
+      close (fd);
+      fd = -1;
+      return false;
+    }
+
+  map = static_cast<std::uint8_t *> (mapping);
+  map_size = size;
+  offset = 0;
+  return true;
+}
+
+
+void
+trace_writer::close_segment ()
+{
+  if (map == nullptr)
+    return;
+
+  munmap (map, map_size);
+  // Cut off the unused, zero-filled tail so readers see a clean end of file.
+  if (ftruncate (fd, offset) == -1)
+    LOG (ERROR) << "Could not truncate trace file " << path << ": " << std::strerror (errno);
+  close (fd);
+
+  fd = -1;
+  map = nullptr;
+  map_size = 0;
+  offset = 0;
+}
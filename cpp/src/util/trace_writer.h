@@ -0,0 +1,72 @@
+#pragma once
+
+#include "ProtoLog.pb.h"
+
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace protolog = im::tox::tox4j::impl::jni::proto;
+
+
+/**
+ * Writes JniLogEntry records to a series of memory-mapped files from a
+ * background thread.
+ *
+ * Each record is a varint length followed by the serialised entry, the same
+ * framing as protobuf's writeDelimitedTo/parseDelimitedFrom. Once a segment
+ * is full, it is truncated to its used size and the next segment is created
+ * as "<path>.<index>", starting at index 0.
+ *
+ * Entries are queued without limit, so the JNI threads never wait for disk
+ * I/O; they only briefly take the queue mutex.
+ */
+struct trace_writer
+{
+  /**
+   * Creates the first segment and starts the writer thread. If the segment
+   * could not be created, the writer evaluates to false and must not be used.
+   */
+  trace_writer (std::string path, std::size_t segment_size);
+
+  /**
+   * Writes all queued entries, closes the current segment, and joins the
+   * writer thread.
+   */
+  ~trace_writer ();
+
+  /**
+   * Queue an entry for writing. The entry is destroyed by the writer thread
+   * after it is written.
+   */
+  void push (std::unique_ptr<protolog::JniLogEntry> entry);
+
+  explicit operator bool () const { return thread.joinable (); }
+
+private:
+  void run ();
+  void write (protolog::JniLogEntry const &entry);
+  bool open_segment (std::size_t min_size);
+  void close_segment ();
+
+  std::string const path;
+  std::size_t const segment_size;
+
+  std::mutex mutex;
+  std::condition_variable ready;
+  std::vector<std::unique_ptr<protolog::JniLogEntry>> queue;
+  bool stopping = false;
+
+  // Owned by the writer thread.
+  int segment_index = 0;
+  int fd = -1;
+  std::uint8_t *map = nullptr;
+  std::size_t map_size = 0;
+  std::size_t offset = 0;
+
+  std::thread thread;
+};
@@ -0,0 +1,178 @@
+#include "util/vad.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+
+#if defined (__SSE2__)
+#include <emmintrin.h>
+#define HAVE_VECTOR_KERNEL 1
+#elif defined (__ARM_NEON) || defined (__ARM_NEON__)
+#include <arm_neon.h>
+#define HAVE_VECTOR_KERNEL 1
+#else
+#define HAVE_VECTOR_KERNEL 0
+#endif
+
+using namespace vad;
+
+
+namespace
+{
+  // Number of samples summed per vector kernel iteration.
+  std::size_t const KERNEL_WIDTH = 8;
+
+
+  template<bool Vector>
+  uint64_t
+  sum (int16_t const *pcm, std::size_t count)
+  {
+    uint64_t total = 0;
+    std::size_t i = 0;
+
+#if defined (__SSE2__)
+    if (Vector)
+      {
+        // Pairs of squares of -32768 add up to 2^31, which only fits into
+        // the 32 bit lanes unsigned, so they are zero-extended to 64 bits.
+        __m128i const zero = _mm_setzero_si128 ();
+        __m128i sums = _mm_setzero_si128 ();
+        for (; i + KERNEL_WIDTH <= count; i += KERNEL_WIDTH)
+          {
+            __m128i const samples = _mm_loadu_si128 (reinterpret_cast<__m128i const *> (pcm + i));
+            __m128i const pairs = _mm_madd_epi16 (samples, samples);
+            sums = _mm_add_epi64 (sums, _mm_unpacklo_epi32 (pairs, zero));
+            sums = _mm_add_epi64 (sums, _mm_unpackhi_epi32 (pairs, zero));
+          }
+        uint64_t lanes[2];
+        _mm_storeu_si128 (reinterpret_cast<__m128i *> (lanes), sums);
+        total = lanes[0] + lanes[1];
+      }
+#elif defined (__ARM_NEON) || defined (__ARM_NEON__)
+    if (Vector)
+      {
+        uint64x2_t sums = vdupq_n_u64 (0);
+        for (; i + KERNEL_WIDTH <= count; i += KERNEL_WIDTH)
+          {
+            int16x8_t const samples = vld1q_s16 (pcm + i);
+            int32x4_t const lo = vmull_s16 (vget_low_s16 (samples), vget_low_s16 (samples));
+            int32x4_t const hi = vmull_s16 (vget_high_s16 (samples), vget_high_s16 (samples));
+            sums = vpadalq_u32 (sums, vreinterpretq_u32_s32 (lo));
+            sums = vpadalq_u32 (sums, vreinterpretq_u32_s32 (hi));
+          }
+        total = vgetq_lane_u64 (sums, 0) + vgetq_lane_u64 (sums, 1);
+      }
+#endif
+
+    for (; i < count; i++)
+      total += uint32_t (int32_t (pcm[i]) * pcm[i]);
+    return total;
+  }
+
+
+  template<bool Vector>
+  uint32_t
+  max_magnitude (int16_t const *pcm, std::size_t count)
+  {
+    uint32_t peak = 0;
+    std::size_t i = 0;
+
+#if defined (__SSE2__)
+    if (Vector && count >= KERNEL_WIDTH)
+      {
+        // The magnitude of -32768 does not fit, so track the extremes in
+        // both directions and take their magnitudes at the end.
+        __m128i lowest = _mm_setzero_si128 ();
+        __m128i highest = _mm_setzero_si128 ();
+        for (; i + KERNEL_WIDTH <= count; i += KERNEL_WIDTH)
+          {
+            __m128i const samples = _mm_loadu_si128 (reinterpret_cast<__m128i const *> (pcm + i));
+            lowest = _mm_min_epi16 (lowest, samples);
+            highest = _mm_max_epi16 (highest, samples);
+          }
+        int16_t lows[KERNEL_WIDTH];
+        int16_t highs[KERNEL_WIDTH];
+        _mm_storeu_si128 (reinterpret_cast<__m128i *> (lows), lowest);
+        _mm_storeu_si128 (reinterpret_cast<__m128i *> (highs), highest);
+        for (std::size_t lane = 0; lane < KERNEL_WIDTH; lane++)
+          peak = std::max<uint32_t> (peak, std::max (-int32_t (lows[lane]), int32_t (highs[lane])));
+      }
+#elif defined (__ARM_NEON) || defined (__ARM_NEON__)
+    if (Vector && count >= KERNEL_WIDTH)
+      {
+        // vabsq would saturate -32768, but the unsigned absolute difference
+        // from zero does not.
+        uint16x8_t magnitudes = vdupq_n_u16 (0);
+        for (; i + KERNEL_WIDTH <= count; i += KERNEL_WIDTH)
+          magnitudes = vmaxq_u16 (magnitudes, vreinterpretq_u16_s16 (vabdq_s16 (vld1q_s16 (pcm + i), vdupq_n_s16 (0))));
+        uint16_t lanes[KERNEL_WIDTH];
+        vst1q_u16 (lanes, magnitudes);
+        for (std::size_t lane = 0; lane < KERNEL_WIDTH; lane++)
+          peak = std::max<uint32_t> (peak, lanes[lane]);
+      }
+#endif
+
+    for (; i < count; i++)
+      peak = std::max<uint32_t> (peak, std::abs (int32_t (pcm[i])));
+    return peak;
+  }
+}
+
+
+uint64_t
+vad::sum_of_squares (int16_t const *pcm, std::size_t count)
+{
+  return sum<HAVE_VECTOR_KERNEL> (pcm, count);
+}
+
+
+uint64_t
+vad::sum_of_squares_scalar (int16_t const *pcm, std::size_t count)
+{
+  return sum<false> (pcm, count);
+}
+
+
+uint32_t
+vad::peak (int16_t const *pcm, std::size_t count)
+{
+  return max_magnitude<HAVE_VECTOR_KERNEL> (pcm, count);
+}
+
+
+uint32_t
+vad::peak_scalar (int16_t const *pcm, std::size_t count)
+{
+  return max_magnitude<false> (pcm, count);
+}
+
+
+detector::detector (int threshold_dbfs, uint32_t hangover_ms)
+  : threshold (32768.0 * 32768.0 * std::pow (10.0, threshold_dbfs / 10.0))
+  , hangover_us (uint64_t (hangover_ms) * 1000)
+{
+}
+
+
+bool
+detector::update (int16_t const *pcm, std::size_t sample_count, uint8_t channels, uint32_t sampling_rate)
+{
+  std::size_t const count = sample_count * channels;
+  if (count == 0 || sampling_rate == 0)
+    return remaining_us != 0;
+
+  uint64_t const duration_us = uint64_t (sample_count) * 1000000 / sampling_rate;
+  if (double (sum_of_squares (pcm, count)) / count >= threshold)
+    {
+      remaining_us = hangover_us + duration_us;
+      return true;
+    }
+
+  if (remaining_us <= duration_us)
+    {
+      remaining_us = 0;
+      return false;
+    }
+  remaining_us -= duration_us;
+  return true;
+}
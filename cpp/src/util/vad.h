@@ -0,0 +1,61 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+
+/*****************************************************************************
+ *
+ * Audio levels and energy based voice activity detection on 16 bit PCM
+ * audio.
+ *
+ *****************************************************************************/
+
+
+namespace vad
+{
+  /**
+   * The sum of the squares of the samples, without overflow for any frame
+   * shorter than 2^33 samples.
+   *
+   * Uses SSE2 or NEON when the target supports them.
+   */
+  uint64_t sum_of_squares (int16_t const *pcm, std::size_t count);
+
+  /**
+   * The same without vector instructions, for testing the vector versions.
+   */
+  uint64_t sum_of_squares_scalar (int16_t const *pcm, std::size_t count);
+
+  /**
+   * The largest magnitude of the samples, up to 32768.
+   *
+   * Uses SSE2 or NEON when the target supports them.
+   */
+  uint32_t peak (int16_t const *pcm, std::size_t count);
+
+  uint32_t peak_scalar (int16_t const *pcm, std::size_t count);
+
+  /**
+   * Tracks whether a stream carries voice. A frame whose mean power reaches
+   * the threshold is voice, and so is everything for the hangover time after
+   * it, so that quiet word endings and short pauses are kept.
+   */
+  struct detector
+  {
+    /**
+     * The threshold is in dB relative to full scale, e.g. -50.
+     */
+    detector (int threshold_dbfs, uint32_t hangover_ms);
+
+    /**
+     * Whether an interleaved frame is voice, counting the hangover.
+     */
+    bool update (int16_t const *pcm, std::size_t sample_count, uint8_t channels, uint32_t sampling_rate);
+
+  private:
+    double threshold;
+    uint64_t hangover_us;
+    uint64_t remaining_us = 0;
+  };
+}
@@ -0,0 +1,571 @@
+#include "util/yuv.h"
+
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+#if defined (__SSE2__)
+#include <emmintrin.h>
+#define HAVE_VECTOR_KERNEL 1
+#elif defined (__ARM_NEON) || defined (__ARM_NEON__)
+#include <arm_neon.h>
+#define HAVE_VECTOR_KERNEL 1
+#else
+#define HAVE_VECTOR_KERNEL 0
+#endif
+
+using namespace yuv;
+
+
+namespace
+{
+  // Coefficients in 6 bit fixed point, so that every intermediate value fits
+  // into a 16 bit lane. Only the blue sum can exceed it, and only when the
+  // result is clamped to 255 anyway.
+  int const Y_SCALE = 74;   // 1.164
+  int const V_TO_R  = 102;  // 1.596
+  int const U_TO_G  = 25;   // 0.391
+  int const V_TO_G  = 52;   // 0.813
+  int const U_TO_B  = 129;  // 2.018
+  int const ROUND   = 32;
+  int const SHIFT   = 6;
+
+  // Number of pixels converted per vector kernel call.
+  uint16_t const KERNEL_WIDTH = 8;
+
+
+  uint8_t
+  clamp (int value)
+  {
+    return value < 0 ? 0 : value > 255 ? 255 : value;
+  }
+
+
+  void
+  convert_pixel (uint8_t *dest, int y, int u, int v, pixel_order order)
+  {
+    int const c = Y_SCALE * (y - 16);
+    int const d = u - 128;
+    int const e = v - 128;
+
+    uint8_t const r = clamp ((c + V_TO_R * e + ROUND) >> SHIFT);
+    uint8_t const g = clamp ((c - U_TO_G * d - V_TO_G * e + ROUND) >> SHIFT);
+    uint8_t const b = clamp ((c + U_TO_B * d + ROUND) >> SHIFT);
+
+    switch (order)
+      {
+      case pixel_order::RGBA:
+        dest[0] = r; dest[1] = g; dest[2] = b; dest[3] = 0xff;
+        break;
+      case pixel_order::ARGB:
+        dest[0] = 0xff; dest[1] = r; dest[2] = g; dest[3] = b;
+        break;
+      }
+  }
+
+
+#if defined (__SSE2__)
+
+  /**
+   * Convert 8 pixels, reading 8 luma and 4 chroma samples.
+   */
+  void
+  convert_kernel (uint8_t *dest, uint8_t const *y, uint8_t const *u, uint8_t const *v, pixel_order order)
+  {
+    int32_t u4, v4;
+    std::memcpy (&u4, u, sizeof u4);
+    std::memcpy (&v4, v, sizeof v4);
+
+    __m128i const zero = _mm_setzero_si128 ();
+    __m128i const y16 = _mm_unpacklo_epi8 (_mm_loadl_epi64 (reinterpret_cast<__m128i const *> (y)), zero);
+    __m128i u8 = _mm_cvtsi32_si128 (u4);
+    __m128i v8 = _mm_cvtsi32_si128 (v4);
+    u8 = _mm_unpacklo_epi8 (u8, u8);
+    v8 = _mm_unpacklo_epi8 (v8, v8);
+
+    __m128i const c = _mm_mullo_epi16 (_mm_sub_epi16 (y16, _mm_set1_epi16 (16)), _mm_set1_epi16 (Y_SCALE));
+    __m128i const d = _mm_sub_epi16 (_mm_unpacklo_epi8 (u8, zero), _mm_set1_epi16 (128));
+    __m128i const e = _mm_sub_epi16 (_mm_unpacklo_epi8 (v8, zero), _mm_set1_epi16 (128));
+    __m128i const round = _mm_set1_epi16 (ROUND);
+
+    __m128i r = _mm_adds_epi16 (c, _mm_mullo_epi16 (e, _mm_set1_epi16 (V_TO_R)));
+    __m128i g = _mm_subs_epi16 (c, _mm_mullo_epi16 (d, _mm_set1_epi16 (U_TO_G)));
+    g = _mm_subs_epi16 (g, _mm_mullo_epi16 (e, _mm_set1_epi16 (V_TO_G)));
+    __m128i b = _mm_adds_epi16 (c, _mm_mullo_epi16 (d, _mm_set1_epi16 (U_TO_B)));
+
+    r = _mm_packus_epi16 (_mm_srai_epi16 (_mm_adds_epi16 (r, round), SHIFT), zero);
+    g = _mm_packus_epi16 (_mm_srai_epi16 (_mm_adds_epi16 (g, round), SHIFT), zero);
+    b = _mm_packus_epi16 (_mm_srai_epi16 (_mm_adds_epi16 (b, round), SHIFT), zero);
+    __m128i const a = _mm_set1_epi8 (-1);
+
+    bool const rgba = order == pixel_order::RGBA;
+    __m128i const first  = rgba ? _mm_unpacklo_epi8 (r, g) : _mm_unpacklo_epi8 (a, r);
+    __m128i const second = rgba ? _mm_unpacklo_epi8 (b, a) : _mm_unpacklo_epi8 (g, b);
+
+    _mm_storeu_si128 (reinterpret_cast<__m128i *> (dest     ), _mm_unpacklo_epi16 (first, second));
+    _mm_storeu_si128 (reinterpret_cast<__m128i *> (dest + 16), _mm_unpackhi_epi16 (first, second));
+  }
+
+#elif defined (__ARM_NEON) || defined (__ARM_NEON__)
+
+  /**
+   * Convert 8 pixels, reading 8 luma and 4 chroma samples.
+   */
+  void
+  convert_kernel (uint8_t *dest, uint8_t const *y, uint8_t const *u, uint8_t const *v, pixel_order order)
+  {
+    uint32_t u4, v4;
+    std::memcpy (&u4, u, sizeof u4);
+    std::memcpy (&v4, v, sizeof v4);
+
+    uint8x8_t const u_bytes = vreinterpret_u8_u32 (vdup_n_u32 (u4));
+    uint8x8_t const v_bytes = vreinterpret_u8_u32 (vdup_n_u32 (v4));
+    uint8x8_t const u8 = vzip_u8 (u_bytes, u_bytes).val[0];
+    uint8x8_t const v8 = vzip_u8 (v_bytes, v_bytes).val[0];
+
+    int16x8_t const y16 = vreinterpretq_s16_u16 (vmovl_u8 (vld1_u8 (y)));
+    int16x8_t const c = vmulq_n_s16 (vsubq_s16 (y16, vdupq_n_s16 (16)), Y_SCALE);
+    int16x8_t const d = vsubq_s16 (vreinterpretq_s16_u16 (vmovl_u8 (u8)), vdupq_n_s16 (128));
+    int16x8_t const e = vsubq_s16 (vreinterpretq_s16_u16 (vmovl_u8 (v8)), vdupq_n_s16 (128));
+    int16x8_t const round = vdupq_n_s16 (ROUND);
+
+    int16x8_t r = vqaddq_s16 (c, vmulq_n_s16 (e, V_TO_R));
+    int16x8_t g = vqsubq_s16 (vqsubq_s16 (c, vmulq_n_s16 (d, U_TO_G)), vmulq_n_s16 (e, V_TO_G));
+    int16x8_t b = vqaddq_s16 (c, vmulq_n_s16 (d, U_TO_B));
+
+    uint8x8_t const r8 = vqmovun_s16 (vshrq_n_s16 (vqaddq_s16 (r, round), SHIFT));
+    uint8x8_t const g8 = vqmovun_s16 (vshrq_n_s16 (vqaddq_s16 (g, round), SHIFT));
+    uint8x8_t const b8 = vqmovun_s16 (vshrq_n_s16 (vqaddq_s16 (b, round), SHIFT));
+    uint8x8_t const a8 = vdup_n_u8 (0xff);
+
+    bool const rgba = order == pixel_order::RGBA;
+    uint8x8x4_t pixels;
+    pixels.val[0] = rgba ? r8 : a8;
+    pixels.val[1] = rgba ? g8 : r8;
+    pixels.val[2] = rgba ? b8 : g8;
+    pixels.val[3] = rgba ? a8 : b8;
+    vst4_u8 (dest, pixels);
+  }
+
+#endif
+
+
+  /**
+   * Convert one row. The chroma rows are null if the chroma planes are
+   * empty, in which case the pixels are grey.
+   */
+  template<bool Vector>
+  void
+  convert_row (uint8_t *dest, uint8_t const *y, uint8_t const *u, uint8_t const *v,
+               uint16_t width, uint16_t chroma_width, pixel_order order)
+  {
+    uint16_t x = 0;
+
+#if HAVE_VECTOR_KERNEL
+    if (Vector && u != nullptr)
+      for (; x + KERNEL_WIDTH <= chroma_width * 2; x += KERNEL_WIDTH)
+        convert_kernel (dest + x * 4, y + x, u + x / 2, v + x / 2, order);
+#endif
+
+    for (; x < width; x++)
+      {
+        if (u == nullptr)
+          convert_pixel (dest + x * 4, y[x], 128, 128, order);
+        else
+          {
+            uint16_t const cx = std::min<uint16_t> (x / 2, chroma_width - 1);
+            convert_pixel (dest + x * 4, y[x], u[cx], v[cx], order);
+          }
+      }
+  }
+
+
+  template<bool Vector>
+  void
+  convert (uint8_t *dest,
+           uint8_t const *y, int32_t ystride,
+           uint8_t const *u, int32_t ustride,
+           uint8_t const *v, int32_t vstride,
+           uint16_t width, uint16_t height,
+           pixel_order order)
+  {
+    uint16_t const chroma_width = width / 2;
+    uint16_t const chroma_height = height / 2;
+    bool const have_chroma = chroma_width != 0 && chroma_height != 0;
+
+    for (uint16_t row = 0; row < height; row++)
+      {
+        uint16_t const chroma_row = std::min<uint16_t> (row / 2, chroma_height - 1);
+        convert_row<Vector> (
+          dest + std::size_t (row) * width * 4,
+          y + std::ptrdiff_t (row) * ystride,
+          have_chroma ? u + std::ptrdiff_t (chroma_row) * ustride : nullptr,
+          have_chroma ? v + std::ptrdiff_t (chroma_row) * vstride : nullptr,
+          width, chroma_width, order
+        );
+      }
+  }
+}
+
+
+void
+yuv::i420_to_pixels (uint8_t *dest,
+                     uint8_t const *y, int32_t ystride,
+                     uint8_t const *u, int32_t ustride,
+                     uint8_t const *v, int32_t vstride,
+                     uint16_t width, uint16_t height,
+                     pixel_order order)
+{
+  convert<true> (dest, y, ystride, u, ustride, v, vstride, width, height, order);
+}
+
+
+void
+yuv::i420_to_pixels_scalar (uint8_t *dest,
+                            uint8_t const *y, int32_t ystride,
+                            uint8_t const *u, int32_t ustride,
+                            uint8_t const *v, int32_t vstride,
+                            uint16_t width, uint16_t height,
+                            pixel_order order)
+{
+  convert<false> (dest, y, ystride, u, ustride, v, vstride, width, height, order);
+}
+
+
+/*****************************************************************************
+ *
+ * Packed pixels to I420.
+ *
+ *****************************************************************************/
+
+
+namespace
+{
+  // 8 bit fixed point coefficients. The luma sum is at most 56228, so it
+  // fits into an unsigned 16 bit lane; the chroma sums fit into signed ones.
+  int const R_TO_Y = 66;
+  int const G_TO_Y = 129;
+  int const B_TO_Y = 25;
+  int const R_TO_U = -38;
+  int const G_TO_U = -74;
+  int const B_TO_U = 112;
+  int const R_TO_V = 112;
+  int const G_TO_V = -94;
+  int const B_TO_V = -18;
+
+  // Number of pixels per row converted per vector kernel call.
+  uint16_t const RGB_KERNEL_WIDTH = 8;
+
+
+  struct rgb
+  {
+    int r, g, b;
+  };
+
+
+  rgb
+  read_pixel (uint8_t const *pixel, pixel_order order)
+  {
+    switch (order)
+      {
+      case pixel_order::RGBA:
+        return { pixel[0], pixel[1], pixel[2] };
+      case pixel_order::ARGB:
+        return { pixel[1], pixel[2], pixel[3] };
+      }
+    return { 0, 0, 0 };
+  }
+
+
+  uint8_t
+  luma (rgb p)
+  {
+    return ((R_TO_Y * p.r + G_TO_Y * p.g + B_TO_Y * p.b + 128) >> 8) + 16;
+  }
+
+
+  void
+  convert_block (uint8_t *u, uint8_t *v, rgb a, rgb b, rgb c, rgb d)
+  {
+    rgb const average = {
+      (a.r + b.r + c.r + d.r + 2) >> 2,
+      (a.g + b.g + c.g + d.g + 2) >> 2,
+      (a.b + b.b + c.b + d.b + 2) >> 2,
+    };
+    *u = ((R_TO_U * average.r + G_TO_U * average.g + B_TO_U * average.b + 128) >> 8) + 128;
+    *v = ((R_TO_V * average.r + G_TO_V * average.g + B_TO_V * average.b + 128) >> 8) + 128;
+  }
+
+
+#if defined (__SSE2__)
+
+  /**
+   * Extract one channel of 8 pixels as 16 bit values.
+   */
+  __m128i
+  channel (__m128i first, __m128i second, int shift)
+  {
+    __m128i const count = _mm_cvtsi32_si128 (shift);
+    __m128i const mask = _mm_set1_epi32 (0xff);
+    return _mm_packs_epi32 (_mm_and_si128 (_mm_srl_epi32 (first, count), mask),
+                            _mm_and_si128 (_mm_srl_epi32 (second, count), mask));
+  }
+
+
+  __m128i
+  luma_kernel (__m128i r, __m128i g, __m128i b)
+  {
+    __m128i sum = _mm_mullo_epi16 (r, _mm_set1_epi16 (R_TO_Y));
+    sum = _mm_add_epi16 (sum, _mm_mullo_epi16 (g, _mm_set1_epi16 (G_TO_Y)));
+    sum = _mm_add_epi16 (sum, _mm_mullo_epi16 (b, _mm_set1_epi16 (B_TO_Y)));
+    sum = _mm_srli_epi16 (_mm_add_epi16 (sum, _mm_set1_epi16 (128)), 8);
+    return _mm_add_epi16 (sum, _mm_set1_epi16 (16));
+  }
+
+
+  /**
+   * Average 2x2 blocks of one channel from two rows of 8 values.
+   */
+  __m128i
+  block_average (__m128i top, __m128i bottom)
+  {
+    __m128i const sums = _mm_madd_epi16 (_mm_add_epi16 (top, bottom), _mm_set1_epi16 (1));
+    __m128i const average = _mm_srai_epi32 (_mm_add_epi32 (sums, _mm_set1_epi32 (2)), 2);
+    return _mm_packs_epi32 (average, average);
+  }
+
+
+  __m128i
+  chroma_kernel (__m128i r, __m128i g, __m128i b, int r_coeff, int g_coeff, int b_coeff)
+  {
+    __m128i sum = _mm_mullo_epi16 (r, _mm_set1_epi16 (r_coeff));
+    sum = _mm_add_epi16 (sum, _mm_mullo_epi16 (g, _mm_set1_epi16 (g_coeff)));
+    sum = _mm_add_epi16 (sum, _mm_mullo_epi16 (b, _mm_set1_epi16 (b_coeff)));
+    sum = _mm_srai_epi16 (_mm_add_epi16 (sum, _mm_set1_epi16 (128)), 8);
+    return _mm_add_epi16 (sum, _mm_set1_epi16 (128));
+  }
+
+
+  /**
+   * Convert 8 pixels from each of two rows into 16 luma and 4 chroma
+   * samples.
+   */
+  void
+  rgb_kernel (uint8_t *y0, uint8_t *y1, uint8_t *u, uint8_t *v,
+              uint8_t const *row0, uint8_t const *row1, pixel_order order)
+  {
+    int const shift = order == pixel_order::RGBA ? 0 : 8;
+    __m128i r[2], g[2], b[2];
+    uint8_t const *rows[] = { row0, row1 };
+    uint8_t *luma_rows[] = { y0, y1 };
+
+    for (int i = 0; i < 2; i++)
+      {
+        __m128i const first  = _mm_loadu_si128 (reinterpret_cast<__m128i const *> (rows[i]     ));
+        __m128i const second = _mm_loadu_si128 (reinterpret_cast<__m128i const *> (rows[i] + 16));
+        r[i] = channel (first, second, shift);
+        g[i] = channel (first, second, shift + 8);
+        b[i] = channel (first, second, shift + 16);
+
+        __m128i const luma = luma_kernel (r[i], g[i], b[i]);
+        _mm_storel_epi64 (reinterpret_cast<__m128i *> (luma_rows[i]), _mm_packus_epi16 (luma, luma));
+      }
+
+    __m128i const r_avg = block_average (r[0], r[1]);
+    __m128i const g_avg = block_average (g[0], g[1]);
+    __m128i const b_avg = block_average (b[0], b[1]);
+    __m128i const u16 = chroma_kernel (r_avg, g_avg, b_avg, R_TO_U, G_TO_U, B_TO_U);
+    __m128i const v16 = chroma_kernel (r_avg, g_avg, b_avg, R_TO_V, G_TO_V, B_TO_V);
+
+    int32_t const u4 = _mm_cvtsi128_si32 (_mm_packus_epi16 (u16, u16));
+    int32_t const v4 = _mm_cvtsi128_si32 (_mm_packus_epi16 (v16, v16));
+    std::memcpy (u, &u4, sizeof u4);
+    std::memcpy (v, &v4, sizeof v4);
+  }
+
+#elif defined (__ARM_NEON) || defined (__ARM_NEON__)
+
+  uint8x8_t
+  luma_kernel (uint8x8_t r, uint8x8_t g, uint8x8_t b)
+  {
+    uint16x8_t sum = vmull_u8 (r, vdup_n_u8 (R_TO_Y));
+    sum = vmlal_u8 (sum, g, vdup_n_u8 (G_TO_Y));
+    sum = vmlal_u8 (sum, b, vdup_n_u8 (B_TO_Y));
+    return vadd_u8 (vshrn_n_u16 (vaddq_u16 (sum, vdupq_n_u16 (128)), 8), vdup_n_u8 (16));
+  }
+
+
+  /**
+   * Average 2x2 blocks of one channel from two rows of 8 values.
+   */
+  int16x4_t
+  block_average (uint8x8_t top, uint8x8_t bottom)
+  {
+    return vreinterpret_s16_u16 (vrshrn_n_u32 (vpaddlq_u16 (vaddl_u8 (top, bottom)), 2));
+  }
+
+
+  uint8x8_t
+  chroma_kernel (int16x4_t r, int16x4_t g, int16x4_t b, int r_coeff, int g_coeff, int b_coeff)
+  {
+    int16x4_t sum = vmul_n_s16 (r, r_coeff);
+    sum = vmla_n_s16 (sum, g, g_coeff);
+    sum = vmla_n_s16 (sum, b, b_coeff);
+    sum = vadd_s16 (vshr_n_s16 (vadd_s16 (sum, vdup_n_s16 (128)), 8), vdup_n_s16 (128));
+    return vqmovun_s16 (vcombine_s16 (sum, sum));
+  }
+
+
+  /**
+   * Convert 8 pixels from each of two rows into 16 luma and 4 chroma
+   * samples.
+   */
+  void
+  rgb_kernel (uint8_t *y0, uint8_t *y1, uint8_t *u, uint8_t *v,
+              uint8_t const *row0, uint8_t const *row1, pixel_order order)
+  {
+    int const first = order == pixel_order::RGBA ? 0 : 1;
+    uint8x8x4_t const top = vld4_u8 (row0);
+    uint8x8x4_t const bottom = vld4_u8 (row1);
+
+    vst1_u8 (y0, luma_kernel (top.val[first], top.val[first + 1], top.val[first + 2]));
+    vst1_u8 (y1, luma_kernel (bottom.val[first], bottom.val[first + 1], bottom.val[first + 2]));
+
+    int16x4_t const r = block_average (top.val[first    ], bottom.val[first    ]);
+    int16x4_t const g = block_average (top.val[first + 1], bottom.val[first + 1]);
+    int16x4_t const b = block_average (top.val[first + 2], bottom.val[first + 2]);
+
+    vst1_lane_u32 (reinterpret_cast<uint32_t *> (u), vreinterpret_u32_u8 (chroma_kernel (r, g, b, R_TO_U, G_TO_U, B_TO_U)), 0);
+    vst1_lane_u32 (reinterpret_cast<uint32_t *> (v), vreinterpret_u32_u8 (chroma_kernel (r, g, b, R_TO_V, G_TO_V, B_TO_V)), 0);
+  }
+
+#endif
+
+
+  template<bool Vector>
+  void
+  convert_rgb (uint8_t *y, uint8_t *u, uint8_t *v,
+               uint8_t const *pixels, int32_t stride,
+               uint16_t width, uint16_t height,
+               pixel_order order)
+  {
+    uint16_t const chroma_width = width / 2;
+    uint16_t const chroma_height = height / 2;
+
+    for (uint16_t chroma_row = 0; chroma_row < chroma_height; chroma_row++)
+      {
+        uint16_t const row = chroma_row * 2;
+        uint8_t const *row0 = pixels + std::ptrdiff_t (row) * stride;
+        uint8_t const *row1 = row0 + stride;
+        uint8_t *y0 = y + std::size_t (row) * width;
+        uint8_t *y1 = y0 + width;
+        uint8_t *u_row = u + std::size_t (chroma_row) * chroma_width;
+        uint8_t *v_row = v + std::size_t (chroma_row) * chroma_width;
+
+        uint16_t x = 0;
+#if HAVE_VECTOR_KERNEL
+        if (Vector)
+          for (; x + RGB_KERNEL_WIDTH <= chroma_width * 2; x += RGB_KERNEL_WIDTH)
+            rgb_kernel (y0 + x, y1 + x, u_row + x / 2, v_row + x / 2, row0 + x * 4, row1 + x * 4, order);
+#endif
+
+        for (; x < chroma_width * 2; x += 2)
+          {
+            rgb const a = read_pixel (row0 + x * 4    , order);
+            rgb const b = read_pixel (row0 + x * 4 + 4, order);
+            rgb const c = read_pixel (row1 + x * 4    , order);
+            rgb const d = read_pixel (row1 + x * 4 + 4, order);
+            y0[x] = luma (a);
+            y0[x + 1] = luma (b);
+            y1[x] = luma (c);
+            y1[x + 1] = luma (d);
+            convert_block (u_row + x / 2, v_row + x / 2, a, b, c, d);
+          }
+
+        if (x < width)
+          {
+            y0[x] = luma (read_pixel (row0 + x * 4, order));
+            y1[x] = luma (read_pixel (row1 + x * 4, order));
+          }
+      }
+
+    if (height % 2 != 0)
+      {
+        uint16_t const row = height - 1;
+        for (uint16_t x = 0; x < width; x++)
+          y[std::size_t (row) * width + x] = luma (read_pixel (pixels + std::ptrdiff_t (row) * stride + x * 4, order));
+      }
+  }
+}
+
+
+void
+yuv::pixels_to_i420 (uint8_t *y, uint8_t *u, uint8_t *v,
+                     uint8_t const *pixels, int32_t stride,
+                     uint16_t width, uint16_t height,
+                     pixel_order order)
+{
+  convert_rgb<true> (y, u, v, pixels, stride, width, height, order);
+}
+
+
+void
+yuv::pixels_to_i420_scalar (uint8_t *y, uint8_t *u, uint8_t *v,
+                            uint8_t const *pixels, int32_t stride,
+                            uint16_t width, uint16_t height,
+                            pixel_order order)
+{
+  convert_rgb<false> (y, u, v, pixels, stride, width, height, order);
+}
+
+
+/*****************************************************************************
+ *
+ * Downscaling.
+ *
+ *****************************************************************************/
+
+
+void
+yuv::scale_plane (uint8_t *dest, uint16_t dest_width, uint16_t dest_height,
+                  uint8_t const *plane, int32_t stride,
+                  uint16_t width, uint16_t height)
+{
+  if (dest_width == 0 || dest_height == 0)
+    return;
+
+  // Reused between calls, so that scaling every frame does not allocate.
+  thread_local std::vector<uint32_t> column_sums;
+  thread_local std::vector<uint16_t> columns;
+  column_sums.resize (width);
+  columns.resize (dest_width + 1);
+
+  for (uint16_t x = 0; x <= dest_width; x++)
+    columns[x] = uint32_t (x) * width / dest_width;
+
+  for (uint16_t dest_row = 0; dest_row < dest_height; dest_row++)
+    {
+      uint16_t const first_row = uint32_t (dest_row) * height / dest_height;
+      uint16_t const last_row = uint32_t (dest_row + 1) * height / dest_height;
+
+      // Sum the covered rows first; this loop is simple enough for the
+      // compiler to vectorise.
+      std::fill (column_sums.begin (), column_sums.end (), 0);
+      for (uint16_t row = first_row; row < last_row; row++)
+        {
+          uint8_t const *source = plane + std::ptrdiff_t (row) * stride;
+          for (uint16_t x = 0; x < width; x++)
+            column_sums[x] += source[x];
+        }
+
+      for (uint16_t x = 0; x < dest_width; x++)
+        {
+          uint32_t sum = 0;
+          for (uint16_t column = columns[x]; column < columns[x + 1]; column++)
+            sum += column_sums[column];
+
+          uint32_t const area = uint32_t (columns[x + 1] - columns[x]) * (last_row - first_row);
+          dest[std::size_t (dest_row) * dest_width + x] = (sum + area / 2) / area;
+        }
+    }
+}
@@ -0,0 +1,80 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+
+/*****************************************************************************
+ *
+ * Colour space conversion between I420 frames and 32 bit pixels.
+ *
+ *****************************************************************************/
+
+
+namespace yuv
+{
+  /**
+   * Byte order of a 32 bit pixel in memory. ARGB read as a big endian int is
+   * the packed pixel format used by java.awt.image.BufferedImage.
+   */
+  enum class pixel_order
+  {
+    RGBA,
+    ARGB,
+  };
+
+  /**
+   * Convert an I420 frame to packed pixels, width * 4 bytes per row, using
+   * the BT.601 studio swing coefficients that the video codecs produce. Row
+   * i of each plane starts at plane + i * stride, so negative strides
+   * describe bottom-up planes. The chroma planes are width / 2 by
+   * height / 2; an odd last row or column reuses the chroma of its
+   * neighbour.
+   *
+   * Uses SSE2 or NEON when the target supports them.
+   */
+  void i420_to_pixels (uint8_t *dest,
+                       uint8_t const *y, int32_t ystride,
+                       uint8_t const *u, int32_t ustride,
+                       uint8_t const *v, int32_t vstride,
+                       uint16_t width, uint16_t height,
+                       pixel_order order);
+
+  /**
+   * The same conversion without vector instructions. The vector versions
+   * produce exactly the same output; this is exposed for testing them.
+   */
+  void i420_to_pixels_scalar (uint8_t *dest,
+                              uint8_t const *y, int32_t ystride,
+                              uint8_t const *u, int32_t ustride,
+                              uint8_t const *v, int32_t vstride,
+                              uint16_t width, uint16_t height,
+                              pixel_order order);
+
+  /**
+   * Convert packed pixels to an I420 frame with packed planes, using the
+   * BT.601 studio swing coefficients in the other direction. Each chroma
+   * sample is the average of a 2x2 block; an odd last row or column only
+   * contributes to the luma plane. The pixel rows are stride bytes apart.
+   *
+   * Uses SSE2 or NEON when the target supports them.
+   */
+  void pixels_to_i420 (uint8_t *y, uint8_t *u, uint8_t *v,
+                       uint8_t const *pixels, int32_t stride,
+                       uint16_t width, uint16_t height,
+                       pixel_order order);
+
+  void pixels_to_i420_scalar (uint8_t *y, uint8_t *u, uint8_t *v,
+                              uint8_t const *pixels, int32_t stride,
+                              uint16_t width, uint16_t height,
+                              pixel_order order);
+
+  /**
+   * Shrink a plane with a box filter: each destination sample is the rounded
+   * average of the source samples it covers. The destination must not be
+   * larger than the source in either dimension, and is packed.
+   */
+  void scale_plane (uint8_t *dest, uint16_t dest_width, uint16_t dest_height,
+                    uint8_t const *plane, int32_t stride,
+                    uint16_t width, uint16_t height);
+}
@@ -0,0 +1,65 @@
+#include "ToxAv/ToxAv.h"
+
+#include <gtest/gtest.h>
+
+#include <map>
+#include <vector>
+
+using av::AudioMixer;
+
+
+static std::map<uint32_t, std::vector<int16_t>>
+mix_once (AudioMixer &mixer)
+{
+  std::map<uint32_t, std::vector<int16_t>> sent;
+  mixer.mix (std::chrono::steady_clock::now (),
+    [&] (uint32_t friend_number, int16_t const *pcm)
+      {
+        sent[friend_number].assign (pcm, pcm + mixer.sample_count * mixer.channels);
+      });
+  return sent;
+}
+
+
+TEST (AudioMixer, DuplicateFriendIsAddedOnce) {
+  AudioMixer mixer (4, 1, 8000, 1);
+  mixer.set_participants ({ 1, 1, 2 });
+  ASSERT_EQ (2u, mixer.participants.size ());
+
+  int16_t const pcm[] = { 10, 20, 30, 40 };
+  ASSERT_TRUE (mixer.receive (1, pcm, 4, 1, 8000));
+
+  // Friend 2 hears friend 1 once, not mixed in twice.
+  auto sent = mix_once (mixer);
+  ASSERT_EQ (2u, sent.size ());
+  EXPECT_EQ (std::vector<int16_t> ({ 10, 20, 30, 40 }), sent[2]);
+  EXPECT_EQ (std::vector<int16_t> ({ 0, 0, 0, 0 }), sent[1]);
+}
+
+
+TEST (AudioMixer, ReconfigureWithDuplicateKeepsBuffer) {
+  AudioMixer mixer (4, 1, 8000, 1);
+  mixer.set_participants ({ 1, 2 });
+
+  int16_t const pcm[] = { 1, 2, 3, 4 };
+  ASSERT_TRUE (mixer.receive (2, pcm, 4, 1, 8000));
+
+  // Friend 2 is moved into the new participants once, keeping its buffered
+  // frame, and friend 1 is removed.
+  mixer.set_participants ({ 2, 3, 2 });
+  ASSERT_EQ (2u, mixer.participants.size ());
+  EXPECT_EQ (2u, mixer.participants[0].friend_number);
+  EXPECT_EQ (3u, mixer.participants[1].friend_number);
+  EXPECT_FALSE (mixer.receive (1, pcm, 4, 1, 8000));
+
+  auto sent = mix_once (mixer);
+  EXPECT_EQ (std::vector<int16_t> ({ 1, 2, 3, 4 }), sent[3]);
+
+  // Both jitter buffers still work after the move.
+  ASSERT_TRUE (mixer.receive (2, pcm, 4, 1, 8000));
+  ASSERT_TRUE (mixer.receive (3, pcm, 4, 1, 8000));
+  std::this_thread::sleep_for (mixer.frame_duration);
+  sent = mix_once (mixer);
+  EXPECT_EQ (std::vector<int16_t> ({ 1, 2, 3, 4 }), sent[2]);
+  EXPECT_EQ (std::vector<int16_t> ({ 1, 2, 3, 4 }), sent[3]);
+}
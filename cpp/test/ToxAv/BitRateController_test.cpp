@@ -0,0 +1,196 @@
+#include "ToxAv/ToxAv.h"
+
+#include <gtest/gtest.h>
+
+using av::BitRateController;
+using av::proto::BitRateDecision;
+
+
+namespace
+{
+  // Far enough from the clock's epoch that the first change is not held.
+  std::chrono::steady_clock::time_point const start (std::chrono::hours (1));
+  std::chrono::seconds const hold (1);
+
+  BitRateController
+  make_controller ()
+  {
+    return BitRateController ({ 32, 64 }, { 500, 5000 }, hold);
+  }
+
+  /**
+   * A controller that toxav has told about a call at 48 and 2000 kbit/s.
+   */
+  BitRateController
+  seeded_controller ()
+  {
+    BitRateController controller = make_controller ();
+    controller.suggest (48, 2000);
+    BitRateDecision decision;
+    EXPECT_FALSE (controller.decide (start, decision));
+    return controller;
+  }
+}
+
+
+TEST (BitRateController, SeededFromFirstStatus) {
+  BitRateController controller = make_controller ();
+  controller.suggest (48, 2000);
+  EXPECT_EQ (48u, controller.audio_bit_rate);
+  EXPECT_EQ (2000u, controller.video_bit_rate);
+
+  // The rates toxav already uses are not set again.
+  BitRateDecision decision;
+  EXPECT_FALSE (controller.decide (start, decision));
+}
+
+
+TEST (BitRateController, FailuresBeforeFirstStatusIgnored) {
+  BitRateController controller = make_controller ();
+  controller.failures = 3;
+
+  BitRateDecision decision;
+  EXPECT_FALSE (controller.decide (start, decision));
+  EXPECT_EQ (0u, controller.failures);
+}
+
+
+TEST (BitRateController, FirstStatusClampedToRange) {
+  BitRateController controller = make_controller ();
+  controller.suggest (16, 8000);
+
+  BitRateDecision decision;
+  ASSERT_TRUE (controller.decide (start, decision));
+  EXPECT_EQ (BitRateDecision::SUGGESTED, decision.reason ());
+  EXPECT_EQ (32u, decision.audio_bit_rate ());
+  EXPECT_EQ (5000u, decision.video_bit_rate ());
+}
+
+
+TEST (BitRateController, SuggestionsClampedToRange) {
+  BitRateController controller = seeded_controller ();
+
+  controller.suggest (8, 100);
+  BitRateDecision decision;
+  ASSERT_TRUE (controller.decide (start, decision));
+  EXPECT_EQ (32u, decision.audio_bit_rate ());
+  EXPECT_EQ (500u, decision.video_bit_rate ());
+
+  controller.suggest (128, 10000);
+  ASSERT_TRUE (controller.decide (start + hold, decision));
+  EXPECT_EQ (64u, decision.audio_bit_rate ());
+  EXPECT_EQ (5000u, decision.video_bit_rate ());
+}
+
+
+TEST (BitRateController, ChangesWithinAnEighthIgnored) {
+  BitRateController controller = seeded_controller ();
+  BitRateDecision decision;
+
+  // An eighth of 2000 is 250, so 1750 is not quite far enough down.
+  controller.suggest (48, 1750);
+  EXPECT_FALSE (controller.decide (start, decision));
+  controller.suggest (48, 1749);
+  ASSERT_TRUE (controller.decide (start, decision));
+  EXPECT_EQ (1749u, decision.video_bit_rate ());
+
+  // An eighth of 1749 is 218, so 1967 is not quite far enough up.
+  controller.suggest (48, 1967);
+  EXPECT_FALSE (controller.decide (start + hold, decision));
+  controller.suggest (48, 1968);
+  ASSERT_TRUE (controller.decide (start + hold, decision));
+  EXPECT_EQ (1968u, decision.video_bit_rate ());
+}
+
+
+TEST (BitRateController, IncreasesHeldBack) {
+  BitRateController controller = seeded_controller ();
+  BitRateDecision decision;
+
+  controller.suggest (48, 1000);
+  ASSERT_TRUE (controller.decide (start, decision));
+
+  // An increase is kept until the hold has passed since the last change.
+  controller.suggest (48, 3000);
+  EXPECT_FALSE (controller.decide (start + hold / 2, decision));
+  EXPECT_TRUE (controller.suggested);
+  ASSERT_TRUE (controller.decide (start + hold, decision));
+  EXPECT_EQ (BitRateDecision::SUGGESTED, decision.reason ());
+  EXPECT_EQ (3000u, decision.video_bit_rate ());
+  EXPECT_FALSE (controller.suggested);
+}
+
+
+TEST (BitRateController, DecreasesNotHeldBack) {
+  BitRateController controller = seeded_controller ();
+  BitRateDecision decision;
+
+  controller.suggest (48, 1000);
+  ASSERT_TRUE (controller.decide (start, decision));
+  controller.suggest (48, 600);
+  ASSERT_TRUE (controller.decide (start + hold / 10, decision));
+  EXPECT_EQ (600u, decision.video_bit_rate ());
+}
+
+
+TEST (BitRateController, FailuresLowerVideoByAQuarter) {
+  BitRateController controller = seeded_controller ();
+  BitRateDecision decision;
+
+  controller.failures = 2;
+  ASSERT_TRUE (controller.decide (start + hold, decision));
+  EXPECT_EQ (BitRateDecision::SEND_FAILURES, decision.reason ());
+  EXPECT_EQ (48u, decision.audio_bit_rate ());
+  EXPECT_EQ (1500u, decision.video_bit_rate ());
+  EXPECT_EQ (0u, controller.failures);
+}
+
+
+TEST (BitRateController, FailuresIgnoredWhileHeld) {
+  BitRateController controller = seeded_controller ();
+  BitRateDecision decision;
+
+  controller.suggest (48, 1000);
+  ASSERT_TRUE (controller.decide (start, decision));
+
+  // Failures during the hold are taken to be answered by the last change,
+  // and are not carried over past it.
+  controller.failures = 5;
+  EXPECT_FALSE (controller.decide (start + hold / 2, decision));
+  EXPECT_EQ (0u, controller.failures);
+  EXPECT_FALSE (controller.decide (start + hold, decision));
+
+  controller.failures = 1;
+  ASSERT_TRUE (controller.decide (start + hold, decision));
+  EXPECT_EQ (750u, decision.video_bit_rate ());
+}
+
+
+TEST (BitRateController, FailuresClampedToMinimum) {
+  BitRateController controller ({ 32, 64 }, { 700, 5000 }, hold);
+  controller.suggest (48, 800);
+  BitRateDecision decision;
+  EXPECT_FALSE (controller.decide (start, decision));
+
+  controller.failures = 1;
+  ASSERT_TRUE (controller.decide (start, decision));
+  EXPECT_EQ (700u, decision.video_bit_rate ());
+
+  // Already at the minimum, so there is nothing to change.
+  controller.failures = 1;
+  EXPECT_FALSE (controller.decide (start + hold, decision));
+}
+
+
+TEST (BitRateController, DisabledRangeLeftAlone) {
+  BitRateController controller ({ 0, 0 }, { 500, 5000 }, hold);
+  controller.suggest (48, 2000);
+  BitRateDecision decision;
+  EXPECT_FALSE (controller.decide (start, decision));
+
+  controller.suggest (8, 1000);
+  ASSERT_TRUE (controller.decide (start, decision));
+  EXPECT_EQ (0u, decision.audio_bit_rate ());
+  EXPECT_EQ (48u, controller.audio_bit_rate);
+  EXPECT_EQ (1000u, decision.video_bit_rate ());
+}
@@ -0,0 +1,152 @@
+#include "ToxAv/ToxAv.h"
+
+#include <gtest/gtest.h>
+
+using av::FriendStats;
+using av::ReceiveStats;
+using av::SendStats;
+
+using std::chrono::milliseconds;
+
+
+TEST (SendStats, RecordCountsSentFrames) {
+  SendStats stats;
+  stats.record (TOXAV_ERR_SEND_FRAME_OK, 100, milliseconds (3));
+  stats.record (TOXAV_ERR_SEND_FRAME_OK, 50, milliseconds (5));
+
+  EXPECT_EQ (2u, stats.frames);
+  EXPECT_EQ (150u, stats.bytes);
+  EXPECT_EQ (milliseconds (8), stats.send_time);
+  EXPECT_EQ (milliseconds (5), stats.max_send_time);
+  EXPECT_TRUE (stats.failures.empty ());
+}
+
+
+TEST (SendStats, RecordCountsFailuresByError) {
+  SendStats stats;
+  stats.record (TOXAV_ERR_SEND_FRAME_SYNC, 100, milliseconds (1));
+  stats.record (TOXAV_ERR_SEND_FRAME_RTP_FAILED, 100, milliseconds (7));
+  stats.record (TOXAV_ERR_SEND_FRAME_SYNC, 100, milliseconds (2));
+
+  // Failed frames count towards the time spent, but not the frames sent.
+  EXPECT_EQ (0u, stats.frames);
+  EXPECT_EQ (0u, stats.bytes);
+  EXPECT_EQ (milliseconds (10), stats.send_time);
+  EXPECT_EQ (milliseconds (7), stats.max_send_time);
+  ASSERT_EQ (2u, stats.failures.size ());
+  EXPECT_EQ (2u, stats.failures[TOXAV_ERR_SEND_FRAME_SYNC]);
+  EXPECT_EQ (1u, stats.failures[TOXAV_ERR_SEND_FRAME_RTP_FAILED]);
+}
+
+
+TEST (SendStats, Merge) {
+  SendStats stats;
+  stats.record (TOXAV_ERR_SEND_FRAME_OK, 100, milliseconds (4));
+  stats.record (TOXAV_ERR_SEND_FRAME_SYNC, 100, milliseconds (1));
+
+  SendStats other;
+  other.record (TOXAV_ERR_SEND_FRAME_OK, 30, milliseconds (2));
+  other.record (TOXAV_ERR_SEND_FRAME_SYNC, 30, milliseconds (9));
+  other.record (TOXAV_ERR_SEND_FRAME_INVALID, 30, milliseconds (1));
+
+  stats.merge (other);
+  EXPECT_EQ (2u, stats.frames);
+  EXPECT_EQ (130u, stats.bytes);
+  EXPECT_EQ (milliseconds (17), stats.send_time);
+  EXPECT_EQ (milliseconds (9), stats.max_send_time);
+  EXPECT_EQ (2u, stats.failures[TOXAV_ERR_SEND_FRAME_SYNC]);
+  EXPECT_EQ (1u, stats.failures[TOXAV_ERR_SEND_FRAME_INVALID]);
+
+  // Merging into empty counters copies them.
+  SendStats empty;
+  empty.merge (stats);
+  EXPECT_EQ (stats.frames, empty.frames);
+  EXPECT_EQ (stats.bytes, empty.bytes);
+  EXPECT_EQ (stats.send_time, empty.send_time);
+  EXPECT_EQ (stats.max_send_time, empty.max_send_time);
+  EXPECT_EQ (stats.failures, empty.failures);
+}
+
+
+TEST (Resolution, FirstFrameIsNotAChange) {
+  FriendStats::Resolution resolution {};
+  resolution.update (640, 480);
+  EXPECT_EQ (640, resolution.width);
+  EXPECT_EQ (480, resolution.height);
+  EXPECT_EQ (0u, resolution.changes);
+
+  resolution.update (640, 480);
+  EXPECT_EQ (0u, resolution.changes);
+}
+
+
+TEST (Resolution, CountsChanges) {
+  FriendStats::Resolution resolution {};
+  resolution.update (640, 480);
+  resolution.update (320, 240);
+  resolution.update (320, 240);
+  resolution.update (320, 180);
+  resolution.update (640, 480);
+
+  EXPECT_EQ (3u, resolution.changes);
+  EXPECT_EQ (640, resolution.width);
+  EXPECT_EQ (480, resolution.height);
+}
+
+
+TEST (ReceiveStats, CountsFramesAndBytes) {
+  ReceiveStats stats;
+  auto const start = std::chrono::steady_clock::now ();
+  stats.record (100, start);
+  EXPECT_EQ (1u, stats.frames);
+  EXPECT_EQ (100u, stats.bytes);
+  // One arrival has no interval yet.
+  EXPECT_EQ (0, stats.interval_ms);
+  EXPECT_EQ (0, stats.arrival_jitter_ms);
+
+  stats.record (50, start + milliseconds (20));
+  EXPECT_EQ (2u, stats.frames);
+  EXPECT_EQ (150u, stats.bytes);
+}
+
+
+TEST (ReceiveStats, EvenArrivalsHaveNoJitter) {
+  ReceiveStats stats;
+  auto now = std::chrono::steady_clock::now ();
+  for (int i = 0; i < 100; i++)
+    {
+      stats.record (100, now);
+      now += milliseconds (20);
+    }
+
+  // The first interval is taken as the mean, rather than smoothed up from 0.
+  EXPECT_DOUBLE_EQ (20, stats.interval_ms);
+  EXPECT_DOUBLE_EQ (0, stats.arrival_jitter_ms);
+}
+
+
+TEST (ReceiveStats, SmoothsWithGainOfOneSixteenth) {
+  ReceiveStats stats;
+  auto now = std::chrono::steady_clock::now ();
+  stats.record (100, now);
+  stats.record (100, now += milliseconds (20));
+  ASSERT_DOUBLE_EQ (20, stats.interval_ms);
+
+  // One late frame moves the mean and the jitter by a sixteenth.
+  stats.record (100, now += milliseconds (36));
+  EXPECT_DOUBLE_EQ (21, stats.interval_ms);
+  EXPECT_DOUBLE_EQ (15.0 / 16, stats.arrival_jitter_ms);
+}
+
+
+TEST (ReceiveStats, AlternatingArrivalsConvergeToTheirDeviation) {
+  ReceiveStats stats;
+  auto now = std::chrono::steady_clock::now ();
+  stats.record (100, now);
+  for (int i = 0; i < 1000; i++)
+    stats.record (100, now += milliseconds (i % 2 == 0 ? 10 : 30));
+
+  // Frames 10 and 30 ms apart average 20 ms, each 10 ms from the mean.
+  EXPECT_NEAR (20, stats.interval_ms, 1);
+  EXPECT_NEAR (10, stats.arrival_jitter_ms, 1);
+}
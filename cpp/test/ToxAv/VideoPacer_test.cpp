@@ -0,0 +1,278 @@
+#include "ToxAv/ToxAv.h"
+
+#include <gtest/gtest.h>
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+using av::VideoPacer;
+
+
+namespace
+{
+  /**
+   * Stands in for toxav_video_send_frame_paced. Each frame carries a marker
+   * in its first luma byte, so the tests can tell which frames were sent.
+   */
+  struct FakeSend
+  {
+    std::mutex mutex;
+    std::condition_variable changed;
+    std::vector<uint8_t> sent;
+    // Errors to return, in order, before returning OK.
+    std::deque<TOXAV_ERR_SEND_FRAME> errors;
+    // While closed, sends wait inside the send function.
+    bool gate_open = true;
+    bool in_flight = false;
+
+    void reset ()
+    {
+      std::lock_guard<std::mutex> lock (mutex);
+      sent.clear ();
+      errors.clear ();
+      gate_open = true;
+      in_flight = false;
+    }
+
+    void set_gate (bool open)
+    {
+      {
+        std::lock_guard<std::mutex> lock (mutex);
+        gate_open = open;
+      }
+      changed.notify_all ();
+    }
+
+    bool wait_for_sends (std::size_t count)
+    {
+      std::unique_lock<std::mutex> lock (mutex);
+      return changed.wait_for (lock, std::chrono::seconds (5), [&] { return sent.size () >= count; });
+    }
+
+    bool wait_in_flight ()
+    {
+      std::unique_lock<std::mutex> lock (mutex);
+      return changed.wait_for (lock, std::chrono::seconds (5), [&] { return in_flight; });
+    }
+
+    std::vector<uint8_t> sent_markers ()
+    {
+      std::lock_guard<std::mutex> lock (mutex);
+      return sent;
+    }
+  };
+
+  FakeSend fake;
+
+  bool
+  fake_send (ToxAV *, uint32_t, uint16_t, uint16_t, uint8_t const *y, uint8_t const *, uint8_t const *,
+             TOXAV_ERR_SEND_FRAME *error)
+  {
+    std::unique_lock<std::mutex> lock (fake.mutex);
+    fake.in_flight = true;
+    fake.changed.notify_all ();
+    fake.changed.wait (lock, [] { return fake.gate_open; });
+    fake.in_flight = false;
+
+    fake.sent.push_back (y[0]);
+    *error = TOXAV_ERR_SEND_FRAME_OK;
+    if (!fake.errors.empty ())
+      {
+        *error = fake.errors.front ();
+        fake.errors.pop_front ();
+      }
+    fake.changed.notify_all ();
+    return *error == TOXAV_ERR_SEND_FRAME_OK;
+  }
+
+  bool
+  enqueue (VideoPacer &pacer, uint32_t friend_number, int64_t capture_ms, uint8_t marker)
+  {
+    uint8_t const y[] = { marker, 0, 0, 0 };
+    uint8_t const u[] = { 0 };
+    uint8_t const v[] = { 0 };
+    return pacer.enqueue (friend_number, capture_ms, 2, 2, y, u, v);
+  }
+
+  VideoPacer::Queue
+  make_queue (uint32_t max_fps, uint32_t bit_rate, uint32_t reported_bit_rate)
+  {
+    return VideoPacer::Queue { {}, 1, max_fps, bit_rate, reported_bit_rate, {}, 0, false, 0, 0, {} };
+  }
+
+  struct VideoPacerTest
+    : ::testing::Test
+  {
+    void SetUp () override { fake.reset (); }
+    void TearDown () override { fake.set_gate (true); }
+  };
+}
+
+
+TEST_F (VideoPacerTest, EnqueueWithoutQueueFails) {
+  VideoPacer pacer (0, nullptr, fake_send);
+  EXPECT_FALSE (enqueue (pacer, 1, 0, 0));
+
+  pacer.configure (1, 30, 2, 0);
+  EXPECT_TRUE (enqueue (pacer, 1, 0, 0));
+
+  pacer.configure (1, 0, 2, 0);
+  EXPECT_FALSE (enqueue (pacer, 1, 0, 0));
+}
+
+
+TEST_F (VideoPacerTest, DropsOldestFrameWhenFull) {
+  VideoPacer pacer (0, nullptr, fake_send);
+  pacer.configure (1, 100, 2, 0);
+
+  // Hold the first frame in the send function while three more are queued,
+  // one more than fits.
+  fake.set_gate (false);
+  ASSERT_TRUE (enqueue (pacer, 1, 0, 0));
+  ASSERT_TRUE (fake.wait_in_flight ());
+  ASSERT_TRUE (enqueue (pacer, 1, 1000, 1));
+  ASSERT_TRUE (enqueue (pacer, 1, 2000, 2));
+  ASSERT_TRUE (enqueue (pacer, 1, 3000, 3));
+  fake.set_gate (true);
+
+  ASSERT_TRUE (fake.wait_for_sends (3));
+  std::this_thread::sleep_for (std::chrono::milliseconds (50));
+  EXPECT_EQ (std::vector<uint8_t> ({ 0, 2, 3 }), fake.sent_markers ());
+}
+
+
+TEST_F (VideoPacerTest, DropsFramesCapturedWithinAnInterval) {
+  VideoPacer pacer (0, nullptr, fake_send);
+  // 10 fps, so frames less than 100 ms apart in capture time are stale once
+  // a newer one is waiting.
+  pacer.configure (1, 10, 4, 0);
+
+  fake.set_gate (false);
+  ASSERT_TRUE (enqueue (pacer, 1, 0, 0));
+  ASSERT_TRUE (fake.wait_in_flight ());
+  ASSERT_TRUE (enqueue (pacer, 1, 40, 1));
+  ASSERT_TRUE (enqueue (pacer, 1, 80, 2));
+  ASSERT_TRUE (enqueue (pacer, 1, 150, 3));
+  fake.set_gate (true);
+
+  ASSERT_TRUE (fake.wait_for_sends (2));
+  std::this_thread::sleep_for (std::chrono::milliseconds (150));
+  EXPECT_EQ (std::vector<uint8_t> ({ 0, 3 }), fake.sent_markers ());
+}
+
+
+TEST_F (VideoPacerTest, LastFrameWithinAnIntervalIsSent) {
+  VideoPacer pacer (0, nullptr, fake_send);
+  pacer.configure (1, 10, 4, 0);
+
+  // With no newer frame waiting, a frame captured early is still sent, only
+  // no sooner than an interval after the previous one.
+  ASSERT_TRUE (enqueue (pacer, 1, 0, 0));
+  ASSERT_TRUE (fake.wait_for_sends (1));
+  auto const first = std::chrono::steady_clock::now ();
+  ASSERT_TRUE (enqueue (pacer, 1, 10, 1));
+
+  ASSERT_TRUE (fake.wait_for_sends (2));
+  EXPECT_GE (std::chrono::steady_clock::now () - first, std::chrono::milliseconds (80));
+  EXPECT_EQ (std::vector<uint8_t> ({ 0, 1 }), fake.sent_markers ());
+}
+
+
+TEST_F (VideoPacerTest, RequeuesOnSyncUpToRetries) {
+  VideoPacer pacer (0, nullptr, fake_send);
+  pacer.configure (1, 100, 2, 0);
+
+  fake.errors.assign (VideoPacer::SYNC_RETRIES + 1, TOXAV_ERR_SEND_FRAME_SYNC);
+  ASSERT_TRUE (enqueue (pacer, 1, 0, 7));
+
+  // The frame is tried once and retried SYNC_RETRIES times, then given up.
+  ASSERT_TRUE (fake.wait_for_sends (VideoPacer::SYNC_RETRIES + 1));
+  std::this_thread::sleep_for (std::chrono::milliseconds (50));
+  EXPECT_EQ (std::vector<uint8_t> (VideoPacer::SYNC_RETRIES + 1, 7), fake.sent_markers ());
+
+  av::Stats stats;
+  pacer.take_stats (stats);
+  EXPECT_EQ (0u, stats[1].video_sent.frames);
+  EXPECT_EQ (1u, stats[1].video_sent.failures[TOXAV_ERR_SEND_FRAME_SYNC]);
+}
+
+
+TEST_F (VideoPacerTest, SyncRetrySucceeds) {
+  VideoPacer pacer (0, nullptr, fake_send);
+  pacer.configure (1, 100, 2, 0);
+
+  fake.errors.assign (2, TOXAV_ERR_SEND_FRAME_SYNC);
+  ASSERT_TRUE (enqueue (pacer, 1, 0, 7));
+
+  ASSERT_TRUE (fake.wait_for_sends (3));
+  std::this_thread::sleep_for (std::chrono::milliseconds (50));
+  EXPECT_EQ (std::vector<uint8_t> ({ 7, 7, 7 }), fake.sent_markers ());
+
+  // Only the final outcome is counted.
+  av::Stats stats;
+  pacer.take_stats (stats);
+  EXPECT_EQ (1u, stats[1].video_sent.frames);
+  EXPECT_TRUE (stats[1].video_sent.failures.empty ());
+  EXPECT_EQ (0u, pacer.take_failures (1));
+}
+
+
+TEST (VideoPacerQueue, IntervalFollowsFrameRate) {
+  EXPECT_EQ (std::chrono::milliseconds (40), make_queue (25, 0, 0).interval ());
+  EXPECT_EQ (std::chrono::milliseconds (40), make_queue (25, 1000, 1000).interval ());
+  EXPECT_EQ (std::chrono::milliseconds (40), make_queue (25, 1000, 2000).interval ());
+}
+
+
+TEST (VideoPacerQueue, IntervalScalesWithReportedBitRate) {
+  EXPECT_EQ (std::chrono::milliseconds (100), make_queue (20, 1000, 500).interval ());
+  EXPECT_EQ (std::chrono::milliseconds (250), make_queue (20, 1000, 200).interval ());
+  // The frame rate is rounded down.
+  EXPECT_EQ (std::chrono::steady_clock::duration (std::chrono::seconds (1)) / 12, make_queue (25, 1000, 500).interval ());
+}
+
+
+TEST (VideoPacerQueue, IntervalAtReportedBitRateZero) {
+  // A reported bit rate of zero slows the friend down to one frame a second,
+  // rather than dividing by zero.
+  EXPECT_EQ (std::chrono::seconds (1), make_queue (25, 1000, 0).interval ());
+  EXPECT_EQ (std::chrono::seconds (1), make_queue (25, 1000, 1).interval ());
+
+  // Without a configured bit rate, reports do not change the frame rate.
+  EXPECT_EQ (std::chrono::milliseconds (40), make_queue (25, 0, 0).interval ());
+}
+
+
+TEST_F (VideoPacerTest, DestructorJoinsWhileSendInFlight) {
+  std::unique_ptr<VideoPacer> pacer (new VideoPacer (0, nullptr, fake_send));
+  pacer->configure (1, 100, 2, 0);
+
+  fake.set_gate (false);
+  ASSERT_TRUE (enqueue (*pacer, 1, 0, 0));
+  ASSERT_TRUE (fake.wait_in_flight ());
+  ASSERT_TRUE (enqueue (*pacer, 1, 1000, 1));
+
+  // The destructor waits for the send in flight, and then stops without
+  // sending the frame still queued.
+  std::mutex mutex;
+  bool destroyed = false;
+  std::thread destroyer ([&] {
+    pacer.reset ();
+    std::lock_guard<std::mutex> lock (mutex);
+    destroyed = true;
+  });
+
+  std::this_thread::sleep_for (std::chrono::milliseconds (50));
+  {
+    std::lock_guard<std::mutex> lock (mutex);
+    EXPECT_FALSE (destroyed);
+  }
+
+  fake.set_gate (true);
+  destroyer.join ();
+  EXPECT_TRUE (destroyed);
+  EXPECT_EQ (std::vector<uint8_t> ({ 0 }), fake.sent_markers ());
+}
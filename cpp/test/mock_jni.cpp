@@ -1125,12 +1125,6 @@ ReleaseStringUTFChars (JNIEnv *env, jstring str, const char *chars)
   ADD_FAILURE () << "ReleaseStringUTFChars";
 }
 
-jsize
-GetArrayLength (JNIEnv *env, jarray array)
-{
-  ADD_FAILURE () << "GetArrayLength";
-  return 0;
-}
 
 jobjectArray
 NewObjectArray (JNIEnv *env, jsize len, jclass clazz, jobject init)
@@ -1208,157 +1202,29 @@ NewDoubleArray (JNIEnv *env, jsize len)
   return 0;
 }
 
-jboolean *
-GetBooleanArrayElements (JNIEnv *env, jbooleanArray array, jboolean *isCopy)
-{
-  ADD_FAILURE () << "GetBooleanArrayElements";
-  return 0;
-}
 
-jbyte *
-GetByteArrayElements (JNIEnv *env, jbyteArray array, jboolean *isCopy)
-{
-  ADD_FAILURE () << "GetByteArrayElements";
-  return 0;
-}
 
-jchar *
-GetCharArrayElements (JNIEnv *env, jcharArray array, jboolean *isCopy)
-{
-  ADD_FAILURE () << "GetCharArrayElements";
-  return 0;
-}
 
-jshort *
-GetShortArrayElements (JNIEnv *env, jshortArray array, jboolean *isCopy)
-{
-  ADD_FAILURE () << "GetShortArrayElements";
-  return 0;
-}
 
-jint *
-GetIntArrayElements (JNIEnv *env, jintArray array, jboolean *isCopy)
-{
-  ADD_FAILURE () << "GetIntArrayElements";
-  return 0;
-}
 
-jlong *
-GetLongArrayElements (JNIEnv *env, jlongArray array, jboolean *isCopy)
-{
-  ADD_FAILURE () << "GetLongArrayElements";
-  return 0;
-}
 
-jfloat *
-GetFloatArrayElements (JNIEnv *env, jfloatArray array, jboolean *isCopy)
-{
-  ADD_FAILURE () << "GetFloatArrayElements";
-  return 0;
-}
 
-jdouble *
-GetDoubleArrayElements (JNIEnv *env, jdoubleArray array, jboolean *isCopy)
-{
-  ADD_FAILURE () << "GetDoubleArrayElements";
-  return 0;
-}
 
-void
-ReleaseBooleanArrayElements (JNIEnv *env, jbooleanArray array, jboolean *elems, jint mode)
-{
-  ADD_FAILURE () << "ReleaseBooleanArrayElements";
-}
 
-void
-ReleaseByteArrayElements (JNIEnv *env, jbyteArray array, jbyte *elems, jint mode)
-{
-  ADD_FAILURE () << "ReleaseByteArrayElements";
-}
 
-void
-ReleaseCharArrayElements (JNIEnv *env, jcharArray array, jchar *elems, jint mode)
-{
-  ADD_FAILURE () << "ReleaseCharArrayElements";
-}
 
-void
-ReleaseShortArrayElements (JNIEnv *env, jshortArray array, jshort *elems, jint mode)
-{
-  ADD_FAILURE () << "ReleaseShortArrayElements";
-}
 
-void
-ReleaseIntArrayElements (JNIEnv *env, jintArray array, jint *elems, jint mode)
-{
-  ADD_FAILURE () << "ReleaseIntArrayElements";
-}
 
-void
-ReleaseLongArrayElements (JNIEnv *env, jlongArray array, jlong *elems, jint mode)
-{
-  ADD_FAILURE () << "ReleaseLongArrayElements";
-}
 
-void
-ReleaseFloatArrayElements (JNIEnv *env, jfloatArray array, jfloat *elems, jint mode)
-{
-  ADD_FAILURE () << "ReleaseFloatArrayElements";
-}
 
-void
-ReleaseDoubleArrayElements (JNIEnv *env, jdoubleArray array, jdouble *elems, jint mode)
-{
-  ADD_FAILURE () << "ReleaseDoubleArrayElements";
-}
 
-void
-GetBooleanArrayRegion (JNIEnv *env, jbooleanArray array, jsize start, jsize l, jboolean *buf)
-{
-  ADD_FAILURE () << "GetBooleanArrayRegion";
-}
 
-void
-GetByteArrayRegion (JNIEnv *env, jbyteArray array, jsize start, jsize len, jbyte *buf)
-{
-  ADD_FAILURE () << "GetByteArrayRegion";
-}
 
-void
-GetCharArrayRegion (JNIEnv *env, jcharArray array, jsize start, jsize len, jchar *buf)
-{
-  ADD_FAILURE () << "GetCharArrayRegion";
-}
 
-void
-GetShortArrayRegion (JNIEnv *env, jshortArray array, jsize start, jsize len, jshort *buf)
-{
-  ADD_FAILURE () << "GetShortArrayRegion";
-}
 
-void
-GetIntArrayRegion (JNIEnv *env, jintArray array, jsize start, jsize len, jint *buf)
-{
-  ADD_FAILURE () << "GetIntArrayRegion";
-}
 
-void
-GetLongArrayRegion (JNIEnv *env, jlongArray array, jsize start, jsize len, jlong *buf)
-{
-  ADD_FAILURE () << "GetLongArrayRegion";
-}
 
-void
-GetFloatArrayRegion (JNIEnv *env, jfloatArray array, jsize start, jsize len, jfloat *buf)
-{
-  ADD_FAILURE () << "GetFloatArrayRegion";
-}
 
-void
-GetDoubleArrayRegion (JNIEnv *env, jdoubleArray array, jsize start, jsize len, jdouble *buf)
-{
-  ADD_FAILURE () << "GetDoubleArrayRegion";
-}
 
 void
 SetBooleanArrayRegion (JNIEnv *env, jbooleanArray array, jsize start, jsize l, const jboolean *buf)
@@ -1560,7 +1426,7 @@ static JNINativeInterface_ const functions = {
 
   ToReflectedField,
 
-  Throw,
+  [] (JNIEnv *env, jthrowable obj) { return self (env).Throw (obj); },
   [] (JNIEnv *env, jclass clazz, const char *msg) { return self (env).ThrowNew (clazz, msg); },
   ExceptionOccurred,
   ExceptionDescribe,
@@ -1579,7 +1445,7 @@ static JNINativeInterface_ const functions = {
 
   AllocObject,
   NewObject,
-  NewObjectV,
+  [] (JNIEnv *env, jclass clazz, jmethodID methodID, va_list args) { return self (env).NewObjectV (clazz, methodID, args); },
   NewObjectA,
 
   GetObjectClass,
@@ -1763,7 +1629,7 @@ static JNINativeInterface_ const functions = {
   ReleaseStringUTFChars,
 
 
-  GetArrayLength,
+  [] (JNIEnv *env, jarray array) { return self (env).GetArrayLength (array); },
 
   NewObjectArray,
   GetObjectArrayElement,
@@ -1778,32 +1644,32 @@ static JNINativeInterface_ const functions = {
   NewFloatArray,
   NewDoubleArray,
 
-  GetBooleanArrayElements,
-  GetByteArrayElements,
-  GetCharArrayElements,
-  GetShortArrayElements,
-  GetIntArrayElements,
-  GetLongArrayElements,
-  GetFloatArrayElements,
-  GetDoubleArrayElements,
-
-  ReleaseBooleanArrayElements,
-  ReleaseByteArrayElements,
-  ReleaseCharArrayElements,
-  ReleaseShortArrayElements,
-  ReleaseIntArrayElements,
-  ReleaseLongArrayElements,
-  ReleaseFloatArrayElements,
-  ReleaseDoubleArrayElements,
-
-  GetBooleanArrayRegion,
-  GetByteArrayRegion,
-  GetCharArrayRegion,
-  GetShortArrayRegion,
-  GetIntArrayRegion,
-  GetLongArrayRegion,
-  GetFloatArrayRegion,
-  GetDoubleArrayRegion,
+  [] (JNIEnv *env, jbooleanArray array, jboolean *isCopy) { return self (env).GetArrayElements<jboolean> (array, isCopy); },
+  [] (JNIEnv *env, jbyteArray array, jboolean *isCopy) { return self (env).GetArrayElements<jbyte> (array, isCopy); },
+  [] (JNIEnv *env, jcharArray array, jboolean *isCopy) { return self (env).GetArrayElements<jchar> (array, isCopy); },
+  [] (JNIEnv *env, jshortArray array, jboolean *isCopy) { return self (env).GetArrayElements<jshort> (array, isCopy); },
+  [] (JNIEnv *env, jintArray array, jboolean *isCopy) { return self (env).GetArrayElements<jint> (array, isCopy); },
+  [] (JNIEnv *env, jlongArray array, jboolean *isCopy) { return self (env).GetArrayElements<jlong> (array, isCopy); },
+  [] (JNIEnv *env, jfloatArray array, jboolean *isCopy) { return self (env).GetArrayElements<jfloat> (array, isCopy); },
+  [] (JNIEnv *env, jdoubleArray array, jboolean *isCopy) { return self (env).GetArrayElements<jdouble> (array, isCopy); },
+
+  [] (JNIEnv *env, jbooleanArray array, jboolean *elems, jint mode) { self (env).ReleaseArrayElements (array, elems, mode); },
+  [] (JNIEnv *env, jbyteArray array, jbyte *elems, jint mode) { self (env).ReleaseArrayElements (array, elems, mode); },
+  [] (JNIEnv *env, jcharArray array, jchar *elems, jint mode) { self (env).ReleaseArrayElements (array, elems, mode); },
+  [] (JNIEnv *env, jshortArray array, jshort *elems, jint mode) { self (env).ReleaseArrayElements (array, elems, mode); },
+  [] (JNIEnv *env, jintArray array, jint *elems, jint mode) { self (env).ReleaseArrayElements (array, elems, mode); },
+  [] (JNIEnv *env, jlongArray array, jlong *elems, jint mode) { self (env).ReleaseArrayElements (array, elems, mode); },
+  [] (JNIEnv *env, jfloatArray array, jfloat *elems, jint mode) { self (env).ReleaseArrayElements (array, elems, mode); },
+  [] (JNIEnv *env, jdoubleArray array, jdouble *elems, jint mode) { self (env).ReleaseArrayElements (array, elems, mode); },
+
+  [] (JNIEnv *env, jbooleanArray array, jsize start, jsize len, jboolean *buf) { self (env).GetArrayRegion (array, start, len, buf); },
+  [] (JNIEnv *env, jbyteArray array, jsize start, jsize len, jbyte *buf) { self (env).GetArrayRegion (array, start, len, buf); },
+  [] (JNIEnv *env, jcharArray array, jsize start, jsize len, jchar *buf) { self (env).GetArrayRegion (array, start, len, buf); },
+  [] (JNIEnv *env, jshortArray array, jsize start, jsize len, jshort *buf) { self (env).GetArrayRegion (array, start, len, buf); },
+  [] (JNIEnv *env, jintArray array, jsize start, jsize len, jint *buf) { self (env).GetArrayRegion (array, start, len, buf); },
+  [] (JNIEnv *env, jlongArray array, jsize start, jsize len, jlong *buf) { self (env).GetArrayRegion (array, start, len, buf); },
+  [] (JNIEnv *env, jfloatArray array, jsize start, jsize len, jfloat *buf) { self (env).GetArrayRegion (array, start, len, buf); },
+  [] (JNIEnv *env, jdoubleArray array, jsize start, jsize len, jdouble *buf) { self (env).GetArrayRegion (array, start, len, buf); },
 
   SetBooleanArrayRegion,
   SetByteArrayRegion,
@@ -1834,7 +1700,7 @@ static JNINativeInterface_ const functions = {
   NewWeakGlobalRef,
   DeleteWeakGlobalRef,
 
-  ExceptionCheck,
+  [] (JNIEnv *env) { return self (env).ExceptionCheck (); },
 
   NewDirectByteBuffer,
   GetDirectBufferAddress,
@@ -1,7 +1,11 @@
 #include <jni.h>
 
 #include <algorithm>
+#include <cstdarg>
+#include <cstring>
+#include <map>
 #include <string>
+#include <type_traits>
 #include <vector>
 
 
@@ -26,6 +30,8 @@ struct mock_jthrowable
 
   mock_jclass *clazz;
   std::string name;
+  // The constructor argument, for exceptions created with NewObject.
+  jobject argument = nullptr;
 };
 
 
@@ -40,6 +46,11 @@ struct mock_jni
   jclass
   FindClass (const char *name)
   {
+    if (std::find (missing_classes.begin (), missing_classes.end (), name) != missing_classes.end ())
+      {
+        exn = new mock_jthrowable (new mock_jclass ("java/lang/NoClassDefFoundError"), name);
+        return nullptr;
+      }
     return new mock_jclass (name);
   }
 
@@ -50,8 +61,105 @@ struct mock_jni
     return 0;
   }
 
+  jint
+  Throw (jthrowable obj)
+  {
+    exn = static_cast<mock_jthrowable *> (obj);
+    return 0;
+  }
+
+  // Only exceptions with a single object argument are constructed.
+  jobject
+  NewObjectV (jclass clazz, jmethodID, va_list args)
+  {
+    mock_jthrowable *object = new mock_jthrowable (clazz, "");
+    object->argument = va_arg (args, jobject);
+    return object;
+  }
+
+  jboolean
+  ExceptionCheck ()
+  {
+    return exn != nullptr;
+  }
+
+
+  /**
+   * Make a Java array with the given elements, which the array functions
+   * below can read.
+   */
+  template<typename JavaArray, typename JType>
+  JavaArray
+  NewArray (std::vector<JType> const &elements)
+  {
+    JavaArray array = new typename std::remove_pointer<JavaArray>::type;
+    mock_array &contents = arrays[array];
+    contents.length = elements.size ();
+    contents.bytes.resize (elements.size () * sizeof (JType));
+    std::memcpy (contents.bytes.data (), elements.data (), contents.bytes.size ());
+    return array;
+  }
+
+  jsize
+  GetArrayLength (jarray array)
+  {
+    return arrays.at (array).length;
+  }
+
+  // Returns a copy, as most JVMs do, which must be released.
+  template<typename JType>
+  JType *
+  GetArrayElements (jarray array, jboolean *isCopy)
+  {
+    elements_calls++;
+    mock_array const &contents = arrays.at (array);
+    JType *elements = new JType[contents.length];
+    std::memcpy (elements, contents.bytes.data (), contents.bytes.size ());
+    if (isCopy != nullptr)
+      *isCopy = JNI_TRUE;
+    return elements;
+  }
+
+  template<typename JType>
+  void
+  ReleaseArrayElements (jarray, JType *elems, jint mode)
+  {
+    release_calls++;
+    release_mode = mode;
+    delete[] elems;
+  }
+
+  template<typename JType>
+  void
+  GetArrayRegion (jarray array, jsize start, jsize len, JType *buf)
+  {
+    region_calls++;
+    mock_array const &contents = arrays.at (array);
+    if (start < 0 || len < 0 || start + len > contents.length)
+      {
+        exn = new mock_jthrowable (new mock_jclass ("java/lang/ArrayIndexOutOfBoundsException"), "");
+        return;
+      }
+    std::memcpy (buf, contents.bytes.data () + start * sizeof (JType), len * sizeof (JType));
+  }
+
 
   mock_jthrowable *exn = nullptr;
+  // Classes that FindClass fails to find.
+  std::vector<std::string> missing_classes;
+
+  struct mock_array
+  {
+    jsize length;
+    std::vector<char> bytes;
+  };
+
+  std::map<jarray, mock_array> arrays;
+  // Calls to the array functions, and the mode of the last release.
+  int elements_calls = 0;
+  int release_calls = 0;
+  int region_calls = 0;
+  jint release_mode = -1;
 };
 
 
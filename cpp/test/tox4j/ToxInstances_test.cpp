@@ -0,0 +1,89 @@
+#include "tox4j/ToxInstances.h"
+
+#include <gtest/gtest.h>
+
+#include "../mock_jni.h"
+
+
+namespace
+{
+  struct TestObject;
+
+  enum TEST_ERR_CODE
+  {
+    TEST_ERR_CODE_OK,
+    TEST_ERR_CODE_MISSING,
+  };
+}
+
+template<> char const *module_name<TestObject> () { return "test"; }
+template<> char const *exn_prefix<TestObject> () { return ""; }
+
+template<>
+ErrorHandling
+handle_error_enum<TEST_ERR_CODE> (TEST_ERR_CODE error)
+{
+  switch (error)
+    {
+    case TEST_ERR_CODE_OK:
+      return success ();
+    case TEST_ERR_CODE_MISSING:
+      return failure ("MISSING");
+    }
+  return unhandled ();
+}
+
+static tox_exception_class test_exception = {
+  module_name<TestObject>, exn_prefix<TestObject>, "Missing", error_code_name<TEST_ERR_CODE>, { }
+};
+
+template<> tox_exception_class &exception_class<TEST_ERR_CODE> () { return test_exception; }
+
+
+TEST (ToxInstances, ErrorCodeUnavailableIsNotAnErrorCode) {
+  EXPECT_NE (0, error_code_unavailable);
+  // Not -(ordinal + 1) for any Java enum ordinal.
+  EXPECT_LT (error_code_unavailable, -jlong (INT32_MAX));
+  EXPECT_EQ (error_code_unavailable, jint (error_code_unavailable));
+}
+
+
+TEST (ToxInstances, ErrorCodeResultWithMissingEnum) {
+  mock_jni *env = mock_jnienv ();
+  env->missing_classes.push_back ("im/tox/tox4j/test/exceptions/ToxMissingException$Code");
+
+  // The failed lookup leaves an exception pending and is not mistaken for
+  // success.
+  EXPECT_EQ (error_code_unavailable, error_code_result<TestObject> (env, TEST_ERR_CODE_MISSING, "MISSING"));
+  ASSERT_TRUE (env->exn != nullptr);
+  EXPECT_EQ ("java/lang/NoClassDefFoundError", env->exn->clazz->name);
+
+  // Nor is it cached.
+  env->exn = nullptr;
+  EXPECT_EQ (error_code_unavailable, error_code_result<TestObject> (env, TEST_ERR_CODE_MISSING, "MISSING"));
+  EXPECT_TRUE (env->exn != nullptr);
+}
+
+
+TEST (ToxInstances, CachedExceptionIsFoundByIndex) {
+  mock_jni *env = mock_jnienv ();
+  // Any class lookup would fail.
+  env->missing_classes.push_back ("im/tox/tox4j/test/exceptions/ToxMissingException");
+  env->missing_classes.push_back ("im/tox/tox4j/test/exceptions/ToxMissingException$Code");
+
+  mock_jclass clazz ("im/tox/tox4j/test/exceptions/ToxMissingException");
+  mock_jclass code ("im/tox/tox4j/test/exceptions/ToxMissingException$Code");
+  test_exception.cache.clazz = &clazz;
+  test_exception.cache.codes[TEST_ERR_CODE_MISSING] = &code;
+  test_exception.cache.ordinals[TEST_ERR_CODE_MISSING] = 4;
+
+  EXPECT_EQ (-5, error_code_result<TestObject> (env, TEST_ERR_CODE_MISSING, "MISSING"));
+  EXPECT_TRUE (env->exn == nullptr);
+
+  throw_tox_exception<TestObject> (env, TEST_ERR_CODE_MISSING);
+  ASSERT_TRUE (env->exn != nullptr);
+  EXPECT_EQ (&clazz, env->exn->clazz);
+  EXPECT_EQ (&code, env->exn->argument);
+
+  test_exception.cache = { };
+}
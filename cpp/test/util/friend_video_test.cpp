@@ -0,0 +1,123 @@
+#include "ToxAv/ToxAv.h"
+
+#include <gtest/gtest.h>
+
+#include <utility>
+
+using av::FriendVideo;
+
+using std::chrono::milliseconds;
+
+
+namespace
+{
+  typedef std::pair<uint16_t, uint16_t> size;
+
+  FriendVideo
+  limited_to (uint16_t max_width, uint16_t max_height)
+  {
+    FriendVideo video;
+    video.max_width = max_width;
+    video.max_height = max_height;
+    return video;
+  }
+
+  size
+  scaled (FriendVideo const &video, uint16_t width, uint16_t height)
+  {
+    size scaled_size;
+    video.scaled_size (width, height, scaled_size.first, scaled_size.second);
+    return scaled_size;
+  }
+}
+
+
+TEST (FriendVideo, AcceptsEveryFrameWithoutInterval) {
+  FriendVideo video;
+  auto const now = std::chrono::steady_clock::now ();
+  EXPECT_TRUE (video.accept_frame (now));
+  EXPECT_TRUE (video.accept_frame (now));
+  EXPECT_TRUE (video.accept_frame (now + milliseconds (1)));
+}
+
+
+TEST (FriendVideo, DropsFramesWithinInterval) {
+  FriendVideo video;
+  video.min_interval = milliseconds (100);
+  auto const start = std::chrono::steady_clock::now ();
+
+  EXPECT_TRUE (video.accept_frame (start));
+  EXPECT_FALSE (video.accept_frame (start + milliseconds (1)));
+  EXPECT_FALSE (video.accept_frame (start + milliseconds (99)));
+  EXPECT_TRUE (video.accept_frame (start + milliseconds (100)));
+}
+
+
+TEST (FriendVideo, KeepsToScheduleWithoutDrift) {
+  FriendVideo video;
+  video.min_interval = milliseconds (100);
+  auto const start = std::chrono::steady_clock::now ();
+
+  // Frames arriving a little late do not push the schedule back, so a 30 fps
+  // stream limited to 10 fps delivers every third frame.
+  EXPECT_TRUE (video.accept_frame (start));
+  EXPECT_TRUE (video.accept_frame (start + milliseconds (120)));
+  EXPECT_EQ (start + milliseconds (200), video.next_frame);
+  EXPECT_TRUE (video.accept_frame (start + milliseconds (210)));
+  EXPECT_EQ (start + milliseconds (300), video.next_frame);
+
+  int accepted = 0;
+  for (int i = 9; i < 39; i++)
+    if (video.accept_frame (start + milliseconds (i * 100) / 3))
+      accepted++;
+  EXPECT_EQ (10, accepted);
+}
+
+
+TEST (FriendVideo, RestartsScheduleAfterPause) {
+  FriendVideo video;
+  video.min_interval = milliseconds (100);
+  auto const start = std::chrono::steady_clock::now ();
+
+  EXPECT_TRUE (video.accept_frame (start));
+  // After a pause of more than a frame, the schedule starts over rather than
+  // letting a burst of frames through to catch up.
+  EXPECT_TRUE (video.accept_frame (start + milliseconds (1000)));
+  EXPECT_EQ (start + milliseconds (1100), video.next_frame);
+  EXPECT_FALSE (video.accept_frame (start + milliseconds (1050)));
+}
+
+
+TEST (FriendVideo, SmallFramesAreNotScaled) {
+  EXPECT_EQ (size (640, 480), scaled (limited_to (640, 480), 640, 480));
+  EXPECT_EQ (size (320, 240), scaled (limited_to (640, 480), 320, 240));
+  EXPECT_EQ (size (1920, 1080), scaled (limited_to (0, 0), 1920, 1080));
+}
+
+
+TEST (FriendVideo, KeepsAspectRatio) {
+  // Wide frames are limited by the width, tall ones by the height.
+  EXPECT_EQ (size (640, 360), scaled (limited_to (640, 480), 1280, 720));
+  EXPECT_EQ (size (270, 480), scaled (limited_to (640, 480), 720, 1280));
+  EXPECT_EQ (size (640, 480), scaled (limited_to (640, 480), 1280, 960));
+
+  // A limit of 0 leaves that dimension free.
+  EXPECT_EQ (size (320, 180), scaled (limited_to (320, 0), 1280, 720));
+  EXPECT_EQ (size (128, 72), scaled (limited_to (0, 72), 1280, 720));
+}
+
+
+TEST (FriendVideo, RoundsDown) {
+  // 720 * 100 / 1280 is 56.25.
+  EXPECT_EQ (size (100, 56), scaled (limited_to (100, 100), 1280, 720));
+  // 1280 * 100 / 720 is 177.8.
+  EXPECT_EQ (size (177, 100), scaled (limited_to (200, 100), 1280, 720));
+  // Odd sizes are not made even.
+  EXPECT_EQ (size (101, 75), scaled (limited_to (101, 101), 1280, 952));
+}
+
+
+TEST (FriendVideo, NeverScalesToZero) {
+  EXPECT_EQ (size (100, 1), scaled (limited_to (100, 100), 4000, 1));
+  EXPECT_EQ (size (1, 100), scaled (limited_to (100, 100), 1, 4000));
+}
@@ -0,0 +1,94 @@
+#include "util/hash.h"
+
+#include <gtest/gtest.h>
+
+#include <cstring>
+#include <random>
+#include <set>
+#include <vector>
+
+
+TEST (Hash, VectorMatchesScalar) {
+  std::mt19937 random (7);
+  for (std::size_t length : { 0, 1, 31, 32, 33, 64, 1000, 640 * 480 })
+    {
+      std::vector<uint8_t> data (length);
+      for (uint8_t &byte : data)
+        byte = random ();
+      ASSERT_EQ (hash::digest_scalar (data.data (), length, 99), hash::digest (data.data (), length, 99))
+        << length << " bytes";
+    }
+}
+
+
+TEST (Hash, SingleByteChangesDigest) {
+  std::vector<uint8_t> frame (640 * 480, 128);
+  std::set<uint64_t> digests { hash::digest (frame.data (), frame.size ()) };
+  for (std::size_t i : { std::size_t (0), std::size_t (31), std::size_t (32), std::size_t (12345), frame.size () - 1 })
+    {
+      frame[i]++;
+      EXPECT_TRUE (digests.insert (hash::digest (frame.data (), frame.size ())).second) << "at " << i;
+      frame[i]--;
+    }
+}
+
+
+TEST (Hash, LengthAndSeedChangeDigest) {
+  std::vector<uint8_t> const zeros (64);
+  EXPECT_NE (hash::digest (zeros.data (), 32), hash::digest (zeros.data (), 33));
+  EXPECT_NE (hash::digest (zeros.data (), 32, 1), hash::digest (zeros.data (), 32, 2));
+}
+
+
+TEST (Hash, NoCollisionAcrossWordHalves) {
+  // A step that multiplied only the low half of a word and added the high
+  // half gave the same lane for (lo + 1, hi - multiplier) as for (lo, hi).
+  uint64_t const lane = 0x243f6a8885a308d3;
+  uint64_t const multiplier = 0x9e3779b1;
+  uint64_t const first = lane ^ (uint64_t (0xa0000000) << 32 | 5);
+  uint64_t const second = lane ^ ((0xa0000000 - multiplier) << 32 | 6);
+
+  std::vector<uint8_t> a (32), b (32);
+  std::memcpy (a.data (), &first, sizeof first);
+  std::memcpy (b.data (), &second, sizeof second);
+  EXPECT_NE (hash::digest (a.data (), a.size ()), hash::digest (b.data (), b.size ()));
+  EXPECT_NE (hash::digest_scalar (a.data (), a.size ()), hash::digest_scalar (b.data (), b.size ()));
+}
+
+
+TEST (Hash, EveryBitChangesDigest) {
+  std::vector<uint8_t> data (96);
+  std::mt19937 random (11);
+  for (uint8_t &byte : data)
+    byte = random ();
+
+  std::set<uint64_t> digests { hash::digest (data.data (), data.size ()) };
+  for (std::size_t bit = 0; bit < data.size () * 8; bit++)
+    {
+      data[bit / 8] ^= 1 << bit % 8;
+      EXPECT_TRUE (digests.insert (hash::digest (data.data (), data.size ())).second) << "bit " << bit;
+      data[bit / 8] ^= 1 << bit % 8;
+    }
+}
+
+
+TEST (Hash, DigestBitsAreBalanced) {
+  // Over many inputs differing in one word, each digest bit is set about
+  // half the time.
+  std::vector<uint8_t> data (64);
+  int counts[64] = { };
+  int const inputs = 4096;
+  for (int i = 0; i < inputs; i++)
+    {
+      uint64_t const word = uint64_t (i) << 20;
+      std::memcpy (data.data () + 8, &word, sizeof word);
+      uint64_t const digest = hash::digest (data.data (), data.size ());
+      for (int bit = 0; bit < 64; bit++)
+        counts[bit] += digest >> bit & 1;
+    }
+  for (int bit = 0; bit < 64; bit++)
+    {
+      EXPECT_GT (counts[bit], inputs * 4 / 10) << "bit " << bit;
+      EXPECT_LT (counts[bit], inputs * 6 / 10) << "bit " << bit;
+    }
+}
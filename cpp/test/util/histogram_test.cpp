@@ -0,0 +1,59 @@
+#include "util/histogram.h"
+
+#include <gtest/gtest.h>
+
+#include <memory>
+
+
+static latency_histogram histogram;
+
+
+TEST (LatencyHistogram, SmallValuesAreExact) {
+  for (std::uint64_t value = 0; value < latency_histogram::sub_bucket_count * 2; value++)
+    ASSERT_EQ (value, latency_histogram::bucket_value (latency_histogram::bucket_index (value)));
+}
+
+
+TEST (LatencyHistogram, BucketsAreMonotonic) {
+  std::size_t const bucket_count = latency_histogram::bucket_count;
+  std::size_t previous = 0;
+  for (std::uint64_t value = 1; value < (std::uint64_t (1) << 41); value += value / 7 + 1)
+    {
+      std::size_t index = latency_histogram::bucket_index (value);
+      ASSERT_LE (previous, index);
+      ASSERT_LT (index, bucket_count);
+      previous = index;
+    }
+}
+
+
+TEST (LatencyHistogram, RelativeError) {
+  for (std::uint64_t value = 1; value < (std::uint64_t (1) << 40); value += value / 3 + 1)
+    {
+      std::uint64_t upper = latency_histogram::bucket_value (latency_histogram::bucket_index (value));
+      ASSERT_LE (value, upper);
+      ASSERT_LE (upper - value, value / latency_histogram::sub_bucket_count);
+    }
+}
+
+
+TEST (LatencyHistogram, Percentiles) {
+  for (std::uint64_t value = 1; value <= 1000; value++)
+    histogram.record (value * 1000, value % 10 == 0);
+
+  auto summary = std::make_unique<latency_histogram::summary> ();
+  histogram.snapshot (*summary);
+
+  ASSERT_EQ (1000, summary->count);
+  ASSERT_EQ (100, summary->errors);
+  ASSERT_EQ (1000000, summary->max);
+
+  ASSERT_NEAR (500000, summary->percentile (0.5), 500000 / 16);
+  ASSERT_NEAR (990000, summary->percentile (0.99), 990000 / 16);
+  ASSERT_EQ (1000000, summary->percentile (1.0));
+
+  // Snapshot resets the histogram.
+  histogram.snapshot (*summary);
+  ASSERT_EQ (0, summary->count);
+  ASSERT_EQ (0, summary->percentile (0.5));
+}
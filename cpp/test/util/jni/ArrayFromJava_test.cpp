@@ -0,0 +1,174 @@
+#include "util/jni/ArrayFromJava.h"
+
+#include <gtest/gtest.h>
+
+#include "../../mock_jni.h"
+
+#include <cstring>
+#include <vector>
+
+
+namespace
+{
+  template<typename JType>
+  std::vector<JType>
+  iota (std::size_t count)
+  {
+    std::vector<JType> elements (count);
+    for (std::size_t i = 0; i < count; i++)
+      elements[i] = JType (i * 7 + 1);
+    return elements;
+  }
+
+  template<typename Array>
+  bool
+  is_inline (Array const &array)
+  {
+    auto const *data = reinterpret_cast<char const *> (array.data ());
+    auto const *self = reinterpret_cast<char const *> (&array);
+    return data >= self && data < self + sizeof array;
+  }
+
+  /**
+   * Check that an array of count elements is read the expected way, and that
+   * its contents arrive intact.
+   */
+  template<std::size_t InlineBytes, typename JavaArray, typename JType>
+  void
+  check_array (std::size_t count, bool expect_inline)
+  {
+    mock_jni *env = mock_jnienv ();
+    std::vector<JType> const elements = iota<JType> (count);
+    JavaArray const jArray = env->NewArray<JavaArray> (elements);
+
+    {
+      ArrayFromJava<JavaArray, InlineBytes> const array (env, jArray);
+      ASSERT_EQ (count, array.size ());
+      ASSERT_NE (nullptr, array.data ());
+      EXPECT_EQ (expect_inline, is_inline (array));
+      EXPECT_EQ (0, std::memcmp (elements.data (), array.data (), count * sizeof (JType)));
+      EXPECT_EQ (count, std::size_t (array.end () - array.begin ()));
+
+      if (expect_inline)
+        {
+          EXPECT_EQ (1, env->region_calls);
+          EXPECT_EQ (0, env->elements_calls);
+        }
+      else
+        {
+          EXPECT_EQ (0, env->region_calls);
+          EXPECT_EQ (1, env->elements_calls);
+        }
+      EXPECT_EQ (0, env->release_calls);
+    }
+
+    // Elements are released without copying back, since they are read-only.
+    if (!expect_inline)
+      {
+        EXPECT_EQ (1, env->release_calls);
+        EXPECT_EQ (JNI_ABORT, env->release_mode);
+      }
+    EXPECT_EQ (nullptr, env->exn);
+  }
+}
+
+
+TEST (ArrayFromJava, DefaultInlineSize) {
+  EXPECT_EQ (256u, std::size_t (ArrayFromJava<jbyteArray>::inline_size));
+  EXPECT_EQ (64u, std::size_t (ArrayFromJava<jintArray>::inline_size));
+  EXPECT_EQ (32u, std::size_t (ArrayFromJava<jlongArray>::inline_size));
+}
+
+
+TEST (ArrayFromJava, ByteArraysUpToDefaultSizeAreCopied) {
+  check_array<detail::default_inline_bytes, jbyteArray, jbyte> (1, true);
+  check_array<detail::default_inline_bytes, jbyteArray, jbyte> (255, true);
+  check_array<detail::default_inline_bytes, jbyteArray, jbyte> (256, true);
+}
+
+
+TEST (ArrayFromJava, LargerByteArraysUseElements) {
+  check_array<detail::default_inline_bytes, jbyteArray, jbyte> (257, false);
+  check_array<detail::default_inline_bytes, jbyteArray, jbyte> (4096, false);
+}
+
+
+TEST (ArrayFromJava, InlineSizeCountsBytesNotElements) {
+  check_array<detail::default_inline_bytes, jintArray, jint> (63, true);
+  check_array<detail::default_inline_bytes, jintArray, jint> (64, true);
+  check_array<detail::default_inline_bytes, jintArray, jint> (65, false);
+}
+
+
+TEST (ArrayFromJava, CallSiteInlineSize) {
+  // The exact size of a public key is copied, one more byte is not.
+  check_array<32, jbyteArray, jbyte> (31, true);
+  check_array<32, jbyteArray, jbyte> (32, true);
+  check_array<32, jbyteArray, jbyte> (33, false);
+
+  check_array<32, jlongArray, jlong> (3, true);
+  check_array<32, jlongArray, jlong> (4, true);
+  check_array<32, jlongArray, jlong> (5, false);
+}
+
+
+TEST (ArrayFromJava, FromJavaArrayWithInlineSize) {
+  mock_jni *env = mock_jnienv ();
+  jbyteArray const key = env->NewArray<jbyteArray> (iota<jbyte> (32));
+  jbyteArray const longer = env->NewArray<jbyteArray> (iota<jbyte> (33));
+
+  auto const inline_key = fromJavaArray<32> (env, key);
+  EXPECT_EQ (32u, inline_key.size ());
+  EXPECT_TRUE (is_inline (inline_key));
+  EXPECT_EQ (1, env->region_calls);
+
+  auto const fallback = fromJavaArray<32> (env, longer);
+  EXPECT_EQ (33u, fallback.size ());
+  EXPECT_FALSE (is_inline (fallback));
+  EXPECT_EQ (1, env->elements_calls);
+
+  // The default would have copied both.
+  auto const by_default = fromJavaArray (env, longer);
+  EXPECT_TRUE (is_inline (by_default));
+  EXPECT_EQ (2, env->region_calls);
+}
+
+
+TEST (ArrayFromJava, UnsignedView) {
+  mock_jni *env = mock_jnienv ();
+  jbyteArray const jArray = env->NewArray<jbyteArray> (std::vector<jbyte> { -1, 0, 1, -128 });
+
+  auto const array = fromJavaArray (env, jArray);
+  EXPECT_EQ (std::vector<uint8_t> ({ 255, 0, 1, 128 }), std::vector<uint8_t> (array.begin (), array.end ()));
+}
+
+
+TEST (ArrayFromJava, EmptyArray) {
+  mock_jni *env = mock_jnienv ();
+  jbyteArray const jArray = env->NewArray<jbyteArray> (std::vector<jbyte> { });
+
+  auto const array = fromJavaArray (env, jArray);
+  EXPECT_TRUE (array.empty ());
+  EXPECT_EQ (0u, array.size ());
+  // Only a null array has null data.
+  EXPECT_NE (nullptr, array.data ());
+  EXPECT_EQ (0, env->region_calls);
+  EXPECT_EQ (0, env->elements_calls);
+}
+
+
+TEST (ArrayFromJava, NullArray) {
+  mock_jni *env = mock_jnienv ();
+
+  {
+    auto const array = fromJavaArray (env, jbyteArray (nullptr));
+    EXPECT_TRUE (array.empty ());
+    EXPECT_EQ (nullptr, array.data ());
+    EXPECT_EQ (array.begin (), array.end ());
+  }
+
+  // Nothing is read or released.
+  EXPECT_EQ (0, env->region_calls);
+  EXPECT_EQ (0, env->elements_calls);
+  EXPECT_EQ (0, env->release_calls);
+}
@@ -0,0 +1,96 @@
+#include "util/mixer.h"
+
+#include <gtest/gtest.h>
+
+#include <random>
+#include <vector>
+
+using mixer::jitter_buffer;
+
+
+TEST (Mixer, VectorMatchesScalar) {
+  std::mt19937 random (1234);
+  for (std::size_t count : { 0, 1, 7, 8, 9, 960, 1923 })
+    for (bool with_own : { false, true })
+      {
+        std::vector<int32_t> sum (count);
+        std::vector<int16_t> own (count);
+        for (std::size_t i = 0; i < count; i++)
+          {
+            own[i] = random ();
+            // Sums of up to four streams, so that some of them saturate.
+            sum[i] = int32_t (random () % 262144) - 131072;
+          }
+
+        std::vector<int16_t> scalar (count);
+        std::vector<int16_t> vector (count);
+        mixer::mix_minus_scalar (scalar.data (), sum.data (), with_own ? own.data () : nullptr, count);
+        mixer::mix_minus (vector.data (), sum.data (), with_own ? own.data () : nullptr, count);
+        ASSERT_EQ (scalar, vector) << count << " samples";
+      }
+}
+
+
+TEST (Mixer, MixesOthersWithSaturation) {
+  int16_t const a[] = { 100, 30000, -30000, 0 };
+  int16_t const b[] = { 200, 30000, -30000, 0 };
+  int16_t const c[] = { 300, 30000, -30000, 0 };
+
+  int32_t sum[4] = { };
+  for (int16_t const *pcm : { a, b, c })
+    mixer::accumulate (sum, pcm, 4);
+
+  int16_t mix[4];
+  mixer::mix_minus (mix, sum, a, 4);
+  EXPECT_EQ (500, mix[0]);
+  EXPECT_EQ (INT16_MAX, mix[1]);
+  EXPECT_EQ (INT16_MIN, mix[2]);
+  EXPECT_EQ (0, mix[3]);
+
+  // A participant without audio hears everyone.
+  mixer::mix_minus (mix, sum, nullptr, 4);
+  EXPECT_EQ (600, mix[0]);
+}
+
+
+TEST (Mixer, JitterBufferWaitsForDepth) {
+  jitter_buffer buffer (4, 2);
+  int16_t const pcm[] = { 1, 2, 3, 4, 5, 6, 7, 8 };
+  int16_t frame[4] = { };
+
+  buffer.push (pcm, 6);
+  EXPECT_FALSE (buffer.pop (frame));
+
+  buffer.push (pcm + 6, 2);
+  ASSERT_TRUE (buffer.pop (frame));
+  EXPECT_EQ (1, frame[0]);
+  EXPECT_EQ (4, frame[3]);
+  ASSERT_TRUE (buffer.pop (frame));
+  EXPECT_EQ (5, frame[0]);
+
+  // After the underrun, it waits for two frames again.
+  EXPECT_FALSE (buffer.pop (frame));
+  buffer.push (pcm, 4);
+  EXPECT_FALSE (buffer.pop (frame));
+}
+
+
+TEST (Mixer, JitterBufferDropsOldest) {
+  jitter_buffer buffer (2, 1);
+  std::vector<int16_t> pcm (10);
+  for (std::size_t i = 0; i < pcm.size (); i++)
+    pcm[i] = i;
+
+  // Capacity is two frames, so only the last four samples remain.
+  buffer.push (pcm.data (), 3);
+  buffer.push (pcm.data () + 3, 7);
+  EXPECT_EQ (4u, buffer.size ());
+
+  int16_t frame[2];
+  ASSERT_TRUE (buffer.pop (frame));
+  EXPECT_EQ (6, frame[0]);
+  EXPECT_EQ (7, frame[1]);
+  ASSERT_TRUE (buffer.pop (frame));
+  EXPECT_EQ (8, frame[0]);
+  EXPECT_EQ (9, frame[1]);
+}
@@ -0,0 +1,115 @@
+#include "util/resampler.h"
+
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <vector>
+
+using resampler::polyphase;
+
+
+static std::vector<int16_t>
+sine (uint32_t rate, double frequency, std::size_t sample_count, uint8_t channels)
+{
+  std::vector<int16_t> pcm;
+  for (std::size_t i = 0; i < sample_count; i++)
+    for (uint8_t c = 0; c < channels; c++)
+      pcm.push_back (std::lrint (10000 * std::sin (2 * 3.14159265358979323846 * frequency * i / rate)));
+  return pcm;
+}
+
+
+static double
+rms (std::vector<int16_t> const &pcm, std::size_t skip)
+{
+  double sum = 0;
+  for (std::size_t i = skip; i < pcm.size (); i++)
+    sum += double (pcm[i]) * pcm[i];
+  return std::sqrt (sum / (pcm.size () - skip));
+}
+
+
+/**
+ * Feed 20 ms frames of the input to a fresh resampler.
+ */
+static std::vector<int16_t>
+convert (std::vector<int16_t> const &pcm, uint32_t input_rate, uint8_t input_channels,
+         uint32_t output_rate, uint8_t output_channels)
+{
+  polyphase resampler (input_rate, input_channels, output_rate, output_channels);
+  std::vector<int16_t> output;
+  std::size_t const frame = input_rate / 50;
+  std::size_t const sample_count = pcm.size () / input_channels;
+  for (std::size_t i = 0; i < sample_count; i += frame)
+    resampler.process (&pcm[i * input_channels], std::min (frame, sample_count - i), output);
+  return output;
+}
+
+
+TEST (Resampler, OutputLengthFollowsRatio) {
+  for (uint32_t input_rate : { 8000, 11025, 16000, 44100, 48000 })
+    for (uint32_t output_rate : { 8000, 24000, 48000 })
+      {
+        std::vector<int16_t> const pcm (input_rate, 0);
+        std::vector<int16_t> const output = convert (pcm, input_rate, 1, output_rate, 1);
+        EXPECT_NEAR (output_rate, output.size (), 1) << input_rate << " to " << output_rate;
+      }
+}
+
+
+TEST (Resampler, KeepsConstantSignals) {
+  for (uint32_t input_rate : { 8000, 44100 })
+    {
+      std::vector<int16_t> const pcm (input_rate, 12345);
+      std::vector<int16_t> const output = convert (pcm, input_rate, 1, 48000, 1);
+      // Skip the filter's warm-up from the silent history.
+      for (std::size_t i = 1000; i < output.size (); i++)
+        ASSERT_NEAR (12345, output[i], 2) << "at " << i;
+    }
+}
+
+
+TEST (Resampler, PassesAudibleTones) {
+  std::vector<int16_t> const pcm = sine (16000, 1000, 16000, 1);
+  EXPECT_NEAR (rms (pcm, 0), rms (convert (pcm, 16000, 1, 48000, 1), 1000), 100);
+  EXPECT_NEAR (rms (pcm, 0), rms (convert (pcm, 16000, 1, 8000, 1), 1000), 100);
+}
+
+
+TEST (Resampler, RemovesTonesAboveNyquist) {
+  // 6 kHz cannot be represented at 8 kHz and must not alias down to 2 kHz.
+  std::vector<int16_t> const pcm = sine (48000, 6000, 48000, 1);
+  EXPECT_LT (rms (convert (pcm, 48000, 1, 8000, 1), 1000), 100);
+}
+
+
+TEST (Resampler, ConvertsChannels) {
+  std::vector<int16_t> const mono = sine (24000, 500, 4800, 1);
+  std::vector<int16_t> const stereo = convert (mono, 24000, 1, 48000, 2);
+  ASSERT_EQ (9600u * 2, stereo.size ());
+  for (std::size_t i = 0; i < stereo.size (); i += 2)
+    ASSERT_EQ (stereo[i], stereo[i + 1]);
+
+  // Opposite channels cancel out when mixed down.
+  std::vector<int16_t> opposite;
+  for (int16_t sample : mono)
+    {
+      opposite.push_back (sample);
+      opposite.push_back (-sample);
+    }
+  for (int16_t sample : convert (opposite, 24000, 2, 48000, 1))
+    ASSERT_EQ (0, sample);
+}
+
+
+TEST (Resampler, RejectsUnwieldyRates) {
+  EXPECT_TRUE (polyphase::supported (44100, 48000));
+  EXPECT_TRUE (polyphase::supported (48000, 11025));
+  EXPECT_TRUE (polyphase::supported (192000, 48000));
+
+  EXPECT_FALSE (polyphase::supported (0, 48000));
+  EXPECT_FALSE (polyphase::supported (192001, 48000));
+  EXPECT_FALSE (polyphase::supported (2147483647, 48000));
+  // Within range, but sharing no factor with 48000.
+  EXPECT_FALSE (polyphase::supported (191999, 48000));
+}
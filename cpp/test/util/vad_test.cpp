@@ -0,0 +1,60 @@
+#include "util/vad.h"
+
+#include <gtest/gtest.h>
+
+#include <random>
+#include <vector>
+
+using vad::detector;
+
+
+TEST (Vad, VectorMatchesScalar) {
+  std::mt19937 random (42);
+  for (std::size_t count : { 0, 1, 7, 8, 9, 960, 1921 })
+    {
+      std::vector<int16_t> pcm (count);
+      for (int16_t &sample : pcm)
+        sample = random ();
+      ASSERT_EQ (vad::sum_of_squares_scalar (pcm.data (), count), vad::sum_of_squares (pcm.data (), count))
+        << count << " samples";
+    }
+}
+
+
+TEST (Vad, PeakVectorMatchesScalar) {
+  std::mt19937 random (43);
+  for (std::size_t count : { 0, 1, 7, 8, 9, 960, 1921 })
+    {
+      std::vector<int16_t> pcm (count);
+      for (int16_t &sample : pcm)
+        sample = int16_t (random () % 20001) - 10000;
+      ASSERT_EQ (vad::peak_scalar (pcm.data (), count), vad::peak (pcm.data (), count))
+        << count << " samples";
+    }
+}
+
+
+TEST (Vad, FullScaleDoesNotOverflow) {
+  std::vector<int16_t> pcm (1024, INT16_MIN);
+  EXPECT_EQ (uint64_t (1024) << 30, vad::sum_of_squares (pcm.data (), pcm.size ()));
+  EXPECT_EQ (32768u, vad::peak (pcm.data (), pcm.size ()));
+
+  pcm.assign (1024, -5);
+  pcm[77] = INT16_MAX;
+  EXPECT_EQ (32767u, vad::peak (pcm.data (), pcm.size ()));
+}
+
+
+TEST (Vad, HangoverKeepsVoiceAfterSpeech) {
+  // 20 ms frames at 8 kHz, with 50 ms of hangover.
+  detector voice (-40, 50);
+  std::vector<int16_t> const loud (160, 3000);
+  std::vector<int16_t> const quiet (160, 10);
+
+  EXPECT_FALSE (voice.update (quiet.data (), 160, 1, 8000));
+  EXPECT_TRUE (voice.update (loud.data (), 160, 1, 8000));
+  EXPECT_TRUE (voice.update (quiet.data (), 160, 1, 8000));
+  EXPECT_TRUE (voice.update (quiet.data (), 160, 1, 8000));
+  EXPECT_TRUE (voice.update (quiet.data (), 160, 1, 8000));
+  EXPECT_FALSE (voice.update (quiet.data (), 160, 1, 8000));
+}
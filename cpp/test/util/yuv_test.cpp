@@ -0,0 +1,204 @@
+#include "util/yuv.h"
+
+#include <gtest/gtest.h>
+
+#include <random>
+#include <vector>
+
+using yuv::pixel_order;
+
+
+struct frame
+{
+  frame (uint16_t width, uint16_t height, int32_t padding)
+    : width (width)
+    , height (height)
+    , ystride (width + padding)
+    , uvstride (width / 2 + padding)
+    , y (ystride * height)
+    , u (uvstride * (height / 2))
+    , v (uvstride * (height / 2))
+  {
+    std::mt19937 random (width * 1000 + height);
+    for (auto *plane : { &y, &u, &v })
+      for (uint8_t &sample : *plane)
+        sample = random ();
+  }
+
+  std::vector<uint8_t>
+  convert (pixel_order order, bool vector) const
+  {
+    std::vector<uint8_t> pixels (std::size_t (width) * height * 4);
+    auto convert = vector ? yuv::i420_to_pixels : yuv::i420_to_pixels_scalar;
+    convert (pixels.data (),
+             y.data (), ystride,
+             u.data (), uvstride,
+             v.data (), uvstride,
+             width, height, order);
+    return pixels;
+  }
+
+  uint16_t width;
+  uint16_t height;
+  int32_t ystride;
+  int32_t uvstride;
+  std::vector<uint8_t> y;
+  std::vector<uint8_t> u;
+  std::vector<uint8_t> v;
+};
+
+
+TEST (Yuv, VectorMatchesScalar) {
+  for (uint16_t width : { 1, 2, 7, 8, 16, 33, 640 })
+    for (uint16_t height : { 1, 2, 3, 480 })
+      for (int32_t padding : { 0, 13 })
+        {
+          frame const input (width, height, padding);
+          for (pixel_order order : { pixel_order::RGBA, pixel_order::ARGB })
+            ASSERT_EQ (input.convert (order, false), input.convert (order, true))
+              << width << "x" << height << " padding " << padding;
+        }
+}
+
+
+TEST (Yuv, BlackAndWhite) {
+  uint8_t const y[] = { 16, 235, 16, 235, 16, 235, 16, 235, 16, 235, 16, 235, 16, 235, 16, 235 };
+  uint8_t const uv[] = { 128, 128, 128, 128, 128, 128, 128, 128 };
+  uint8_t pixels[16 * 4];
+
+  yuv::i420_to_pixels (pixels, y, 16, uv, 8, uv, 8, 16, 1, pixel_order::RGBA);
+  for (int x = 0; x < 16; x++)
+    {
+      uint8_t const expected = x % 2 == 0 ? 0 : 253;
+      EXPECT_EQ (expected, pixels[x * 4 + 0]);
+      EXPECT_EQ (expected, pixels[x * 4 + 1]);
+      EXPECT_EQ (expected, pixels[x * 4 + 2]);
+      EXPECT_EQ (0xff, pixels[x * 4 + 3]);
+    }
+}
+
+
+TEST (Yuv, ArgbOrder) {
+  // Pure red in BT.601 studio swing.
+  uint8_t const y[] = { 81, 81, 81, 81 };
+  uint8_t const u[] = { 90 };
+  uint8_t const v[] = { 240 };
+  uint8_t pixels[2 * 2 * 4];
+
+  yuv::i420_to_pixels (pixels, y, 2, u, 1, v, 1, 2, 2, pixel_order::ARGB);
+  for (int x = 0; x < 4; x++)
+    {
+      EXPECT_EQ (0xff, pixels[x * 4 + 0]);
+      EXPECT_GE (pixels[x * 4 + 1], 250);
+      EXPECT_LE (pixels[x * 4 + 2], 5);
+      EXPECT_LE (pixels[x * 4 + 3], 5);
+    }
+}
+
+
+TEST (Yuv, BottomUpPlanes) {
+  frame const input (16, 4, 0);
+  std::vector<uint8_t> top_down = input.convert (pixel_order::RGBA, true);
+
+  // Pass the last row first with negated strides.
+  std::vector<uint8_t> bottom_up (top_down.size ());
+  yuv::i420_to_pixels (bottom_up.data (),
+                       input.y.data () + input.ystride * 3, -input.ystride,
+                       input.u.data () + input.uvstride, -input.uvstride,
+                       input.v.data () + input.uvstride, -input.uvstride,
+                       16, 4, pixel_order::RGBA);
+
+  std::size_t const row = 16 * 4;
+  for (std::size_t i = 0; i < 4; i++)
+    ASSERT_TRUE (std::equal (top_down.begin () + i * row, top_down.begin () + (i + 1) * row,
+                             bottom_up.begin () + (3 - i) * row));
+}
+
+
+static std::vector<uint8_t>
+random_pixels (uint16_t width, uint16_t height, int32_t stride)
+{
+  std::mt19937 random (width * 1000 + height);
+  std::vector<uint8_t> pixels (std::size_t (stride) * height);
+  for (uint8_t &byte : pixels)
+    byte = random ();
+  return pixels;
+}
+
+
+TEST (Yuv, PixelsVectorMatchesScalar) {
+  for (uint16_t width : { 1, 2, 7, 8, 16, 33, 640 })
+    for (uint16_t height : { 1, 2, 3, 480 })
+      for (int32_t padding : { 0, 12 })
+        for (pixel_order order : { pixel_order::RGBA, pixel_order::ARGB })
+          {
+            int32_t const stride = width * 4 + padding;
+            std::vector<uint8_t> const pixels = random_pixels (width, height, stride);
+
+            std::size_t const y_size = std::size_t (width) * height;
+            std::size_t const uv_size = std::size_t (width / 2) * (height / 2);
+            std::vector<uint8_t> scalar (y_size + uv_size * 2);
+            std::vector<uint8_t> vector (y_size + uv_size * 2);
+
+            yuv::pixels_to_i420_scalar (scalar.data (), scalar.data () + y_size, scalar.data () + y_size + uv_size,
+                                        pixels.data (), stride, width, height, order);
+            yuv::pixels_to_i420 (vector.data (), vector.data () + y_size, vector.data () + y_size + uv_size,
+                                 pixels.data (), stride, width, height, order);
+            ASSERT_EQ (scalar, vector) << width << "x" << height << " padding " << padding;
+          }
+}
+
+
+TEST (Yuv, PixelsRoundTrip) {
+  // A smooth gradient survives the conversion to I420 and back closely.
+  uint16_t const width = 64;
+  uint16_t const height = 32;
+  std::vector<uint8_t> pixels (width * height * 4);
+  for (int row = 0; row < height; row++)
+    for (int x = 0; x < width; x++)
+      {
+        uint8_t *pixel = &pixels[(row * width + x) * 4];
+        pixel[0] = x * 4;
+        pixel[1] = row * 8;
+        pixel[2] = 255 - x * 2;
+        pixel[3] = 0xff;
+      }
+
+  std::vector<uint8_t> y (width * height);
+  std::vector<uint8_t> u (width / 2 * height / 2);
+  std::vector<uint8_t> v (width / 2 * height / 2);
+  yuv::pixels_to_i420 (y.data (), u.data (), v.data (), pixels.data (), width * 4, width, height, pixel_order::RGBA);
+
+  std::vector<uint8_t> result (pixels.size ());
+  yuv::i420_to_pixels (result.data (), y.data (), width, u.data (), width / 2, v.data (), width / 2, width, height, pixel_order::RGBA);
+
+  for (std::size_t i = 0; i < pixels.size (); i++)
+    ASSERT_NEAR (pixels[i], result[i], 12) << "at byte " << i;
+}
+
+
+TEST (Yuv, ScaleHalvesByAveraging) {
+  uint8_t const plane[] = {
+    10, 20, 30, 40, 0,
+    30, 40, 50, 60, 0,
+  };
+  uint8_t dest[2];
+  yuv::scale_plane (dest, 2, 1, plane, 5, 4, 2);
+  EXPECT_EQ (25, dest[0]);
+  EXPECT_EQ (45, dest[1]);
+}
+
+
+TEST (Yuv, ScaleKeepsUniformPlanes) {
+  std::vector<uint8_t> plane (1280 * 720, 77);
+  std::vector<uint8_t> dest (320 * 180);
+  yuv::scale_plane (dest.data (), 320, 180, plane.data (), 1280, 1280, 720);
+  for (uint8_t sample : dest)
+    ASSERT_EQ (77, sample);
+
+  // Ratios that are not integers still cover every source sample.
+  std::vector<uint8_t> odd (7 * 5);
+  yuv::scale_plane (odd.data (), 7, 5, plane.data (), 1280, 33, 17);
+  for (uint8_t sample : odd)
+    ASSERT_EQ (77, sample);
+}
@@ -0,0 +1,13 @@
+package im.tox.tox4j.impl.jni
+
+import im.tox.tox4j.core.data.ToxFriendNumber
+
+/**
+ * Receives the levels of each received audio frame, computed natively after
+ * [[ToxAvImpl.setAudioMetering]] enabled metering. The peak is the largest
+ * sample magnitude, up to 32768, and the RMS level is in the same units.
+ * Event listeners mix this in to get the levels.
+ */
+trait AudioLevelsCallback[ToxCoreState] {
+  def audioReceiveLevels(friendNumber: ToxFriendNumber, peak: Int, rms: Float)(state: ToxCoreState): ToxCoreState = state
+}
@@ -0,0 +1,19 @@
+package im.tox.tox4j.impl.jni
+
+import im.tox.tox4j.av.data.{ AudioChannels, SamplingRate }
+import im.tox.tox4j.core.data.ToxFriendNumber
+
+/**
+ * Told about received audio frames that voice activity detection, enabled
+ * with [[ToxAvImpl.setVoiceActivityDetection]], found silent. Their samples
+ * are not passed to Java. Event listeners mix this in to keep track of the
+ * stream's timing; listeners that don't will not see these frames at all.
+ */
+trait AudioReceiveSilenceCallback[ToxCoreState] {
+  def audioReceiveSilence(
+    friendNumber: ToxFriendNumber,
+    sampleCount: Int,
+    channels: AudioChannels,
+    samplingRate: SamplingRate
+  )(state: ToxCoreState): ToxCoreState = state
+}
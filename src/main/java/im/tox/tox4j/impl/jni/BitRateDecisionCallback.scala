@@ -0,0 +1,19 @@
+package im.tox.tox4j.impl.jni
+
+import im.tox.tox4j.av.data.BitRate
+import im.tox.tox4j.av.proto.BitRateDecision
+import im.tox.tox4j.core.data.ToxFriendNumber
+
+/**
+ * Told about each change the native bit rate controller, enabled with
+ * [[ToxAvImpl.setBitRateControl]], made to a call. A bit rate the controller
+ * does not manage is 0. Event listeners mix this in to follow the rates.
+ */
+trait BitRateDecisionCallback[ToxCoreState] {
+  def bitRateDecision(
+    friendNumber: ToxFriendNumber,
+    audioBitRate: BitRate,
+    videoBitRate: BitRate,
+    reason: BitRateDecision.Reason
+  )(state: ToxCoreState): ToxCoreState = state
+}
@@ -1,5 +1,6 @@
 package im.tox.tox4j.impl.jni
 
+import java.nio.{ ByteBuffer, ByteOrder }
 import java.util
 
 import com.google.protobuf.ByteString
@@ -77,22 +78,76 @@ object ToxAvEventDispatch {
     }
   }
 
+  private def dispatchBitRateDecision[S](handler: ToxAvEventListener[S], bitRateDecision: Seq[BitRateDecision])(state: S): S = {
+    handler match {
+      case decisionHandler: BitRateDecisionCallback[S @unchecked] =>
+        bitRateDecision.foldLeft(state) {
+          case (state, BitRateDecision(friendNumber, audioBitRate, videoBitRate, reason)) =>
+            decisionHandler.bitRateDecision(
+              ToxFriendNumber.unsafeFromInt(friendNumber),
+              BitRate.unsafeFromInt(audioBitRate),
+              BitRate.unsafeFromInt(videoBitRate),
+              reason
+            )(state)
+        }
+      case _ =>
+        state
+    }
+  }
+
+  /**
+   * The native code sends samples in native byte order, so this is a bulk
+   * copy rather than a per-element conversion.
+   */
   private def toShortArray(bytes: ByteString): Array[Short] = {
-    val shortBuffer = bytes.asReadOnlyByteBuffer().asShortBuffer()
+    val shortBuffer = bytes.asReadOnlyByteBuffer().order(ByteOrder.nativeOrder()).asShortBuffer()
     val shortArray = Array.ofDim[Short](shortBuffer.capacity)
     shortBuffer.get(shortArray)
     shortArray
   }
 
+  private def dispatchAudioReceiveLevels[S](handler: AudioReceiveFrameCallback[S], friendNumber: Int, levels: AudioLevels)(state: S): S = {
+    handler match {
+      case levelsHandler: AudioLevelsCallback[S @unchecked] =>
+        levelsHandler.audioReceiveLevels(ToxFriendNumber.unsafeFromInt(friendNumber), levels.peak, levels.rms)(state)
+      case _ =>
+        state
+    }
+  }
+
   private def dispatchAudioReceiveFrame[S](handler: AudioReceiveFrameCallback[S], audioReceiveFrame: Seq[AudioReceiveFrame])(state: S): S = {
     audioReceiveFrame.foldLeft(state) {
-      case (state, AudioReceiveFrame(friendNumber, pcm, channels, samplingRate)) =>
+      case (state, AudioReceiveFrame(friendNumber, pcm, channels, samplingRate, levels)) =>
         handler.audioReceiveFrame(
           ToxFriendNumber.unsafeFromInt(friendNumber),
           toShortArray(pcm),
           AudioChannels.unsafeFromInt(channels),
           SamplingRate.unsafeFromInt(samplingRate)
-        )(state)
+        )(levels.fold(state)(dispatchAudioReceiveLevels(handler, friendNumber, _)(state)))
+    }
+  }
+
+  private def dispatchAudioReceiveLevelsOnly[S](handler: AudioReceiveFrameCallback[S], audioReceiveLevels: Seq[AudioReceiveLevels])(state: S): S = {
+    audioReceiveLevels.foldLeft(state) {
+      case (state, AudioReceiveLevels(friendNumber, levels)) =>
+        levels.fold(state)(dispatchAudioReceiveLevels(handler, friendNumber, _)(state))
+    }
+  }
+
+  private def dispatchAudioReceiveSilence[S](handler: AudioReceiveFrameCallback[S], audioReceiveSilence: Seq[AudioReceiveSilence])(state: S): S = {
+    handler match {
+      case silenceHandler: AudioReceiveSilenceCallback[S @unchecked] =>
+        audioReceiveSilence.foldLeft(state) {
+          case (state, AudioReceiveSilence(friendNumber, sampleCount, channels, samplingRate)) =>
+            silenceHandler.audioReceiveSilence(
+              ToxFriendNumber.unsafeFromInt(friendNumber),
+              sampleCount,
+              AudioChannels.unsafeFromInt(channels),
+              SamplingRate.unsafeFromInt(samplingRate)
+            )(state)
+        }
+      case _ =>
+        state
     }
   }
 
@@ -111,12 +166,79 @@ object ToxAvEventDispatch {
     }
   }
 
-  private def dispatchVideoReceiveFrame[S](handler: VideoReceiveFrameCallback[S], videoReceiveFrame: Seq[VideoReceiveFrame])(state: S): S = {
+  private def convert(
+    arrays: Option[(Array[Byte], Array[Byte], Array[Byte])],
+    frame: ByteBuffer, ySize: Int, uvSize: Int
+  ): (Array[Byte], Array[Byte], Array[Byte]) = {
+    val (y, u, v) = arrays.getOrElse((new Array[Byte](ySize), new Array[Byte](uvSize), new Array[Byte](uvSize)))
+    frame.position(0)
+    frame.get(y, 0, ySize)
+    frame.get(u, 0, uvSize)
+    frame.get(v, 0, uvSize)
+    (y, u, v)
+  }
+
+  @SuppressWarnings(Array("org.wartremover.warts.Equals"))
+  private def dispatchVideoReceiveFramePixels[S](
+    handler: VideoReceiveFrameCallback[S],
+    framePool: Array[ByteBuffer],
+    frame: VideoReceiveFrame
+  )(state: S): S = {
+    handler match {
+      case pixelHandler: VideoReceiveFramePixelsCallback[S @unchecked] =>
+        val w = Width.unsafeFromInt(frame.width)
+        val h = Height.unsafeFromInt(frame.height)
+        val size = frame.width * frame.height * 4
+        val pixels = pixelHandler.videoFrameCachedPixels(w, h).getOrElse(new Array[Byte](size))
+        if (frame.frameSlot == 0) {
+          frame.y.copyTo(pixels, 0)
+        } else {
+          val buffer = framePool(frame.frameSlot - 1)
+          buffer.position(0)
+          buffer.get(pixels, 0, size)
+        }
+        pixelHandler.videoReceiveFramePixels(ToxFriendNumber.unsafeFromInt(frame.friendNumber), w, h, frame.format, pixels)(state)
+      case _ =>
+        state
+    }
+  }
+
+  private def dispatchVideoFramesDropped[S](
+    handler: VideoReceiveFrameCallback[S],
+    frame: VideoReceiveFrame
+  )(state: S): S = {
+    handler match {
+      case droppedHandler: VideoFramesDroppedCallback[S @unchecked] =>
+        droppedHandler.videoFramesDropped(ToxFriendNumber.unsafeFromInt(frame.friendNumber), frame.droppedFrames)(state)
+      case _ =>
+        state
+    }
+  }
+
+  @SuppressWarnings(Array("org.wartremover.warts.Equals"))
+  private def dispatchVideoReceiveFrame[S](
+    handler: VideoReceiveFrameCallback[S],
+    framePool: Array[ByteBuffer],
+    videoReceiveFrame: Seq[VideoReceiveFrame]
+  )(state: S): S = {
     videoReceiveFrame.foldLeft(state) {
-      case (state, VideoReceiveFrame(friendNumber, width, height, y, u, v, yStride, uStride, vStride)) =>
+      case (state, frame) if frame.droppedFrames != 0 =>
+        (state
+          |> dispatchVideoFramesDropped(handler, frame)
+          |> dispatchVideoReceiveFrame(handler, framePool, Seq(frame.copy(droppedFrames = 0))))
+      case (state, frame) if frame.format != VideoFormat.I420 =>
+        dispatchVideoReceiveFramePixels(handler, framePool, frame)(state)
+      case (state, VideoReceiveFrame(friendNumber, width, height, y, u, v, yStride, uStride, vStride, frameSlot, _, _)) =>
         val w = Width.unsafeFromInt(width)
         val h = Height.unsafeFromInt(height)
-        val (yArray, uArray, vArray) = convert(handler.videoFrameCachedYUV(h, yStride, uStride, vStride), y, u, v)
+        val cached = handler.videoFrameCachedYUV(h, yStride, uStride, vStride)
+        val (yArray, uArray, vArray) =
+          if (frameSlot == 0) {
+            convert(cached, y, u, v)
+          } else {
+            // The native side wrote packed planes into a registered buffer.
+            convert(cached, framePool(frameSlot - 1), width * height, (width / 2) * (height / 2))
+          }
 
         handler.videoReceiveFrame(
           ToxFriendNumber.unsafeFromInt(friendNumber),
@@ -132,13 +254,16 @@ object ToxAvEventDispatch {
     }
   }
 
-  private def dispatchEvents[S](handler: ToxAvEventListener[S], events: AvEvents)(state: S): S = {
+  private def dispatchEvents[S](handler: ToxAvEventListener[S], framePool: Array[ByteBuffer], events: AvEvents)(state: S): S = {
     (state
       |> dispatchCall(handler, events.call)
       |> dispatchCallState(handler, events.callState)
       |> dispatchBitRateStatus(handler, events.bitRateStatus)
+      |> dispatchBitRateDecision(handler, events.bitRateDecision)
       |> dispatchAudioReceiveFrame(handler, events.audioReceiveFrame)
-      |> dispatchVideoReceiveFrame(handler, events.videoReceiveFrame))
+      |> dispatchAudioReceiveSilence(handler, events.audioReceiveSilence)
+      |> dispatchAudioReceiveLevelsOnly(handler, events.audioReceiveLevels)
+      |> dispatchVideoReceiveFrame(handler, framePool, events.videoReceiveFrame))
   }
 
   private def decodeInt32(eventData: Array[Byte]): Int = {
@@ -150,17 +275,29 @@ object ToxAvEventDispatch {
       | eventData(3) << (8 * 0))
   }
 
+  def dispatch[S](handler: ToxAvEventListener[S], @Nullable eventData: Array[Byte])(state: S): S = {
+    dispatch(handler, Array.empty[ByteBuffer], eventData)(state)
+  }
+
+  /**
+   * Dispatch events whose video frames may refer to the buffers registered
+   * with [[ToxAvJni.toxavSetVideoFramePool]], in the same order.
+   */
   @SuppressWarnings(Array(
     "org.wartremover.warts.ArrayEquals",
     "org.wartremover.warts.Equals",
     "org.wartremover.warts.Null"
   ))
-  def dispatch[S](handler: ToxAvEventListener[S], @Nullable eventData: Array[Byte])(state: S): S = {
+  def dispatch[S](
+    handler: ToxAvEventListener[S],
+    framePool: Array[ByteBuffer],
+    @Nullable eventData: Array[Byte]
+  )(state: S): S = {
     if (eventData == null) { // scalastyle:ignore null
       state
     } else {
       val events = AvEvents.parseFrom(eventData)
-      dispatchEvents(handler, events)(state)
+      dispatchEvents(handler, framePool, events)(state)
     }
   }
 
@@ -1,5 +1,6 @@
 package im.tox.tox4j.impl.jni
 
+import java.nio.ByteBuffer
 import java.util
 
 import com.typesafe.scalalogging.Logger
@@ -8,6 +9,7 @@ import im.tox.tox4j.av.callbacks._
 import im.tox.tox4j.av.data._
 import im.tox.tox4j.av.enums.{ ToxavCallControl, ToxavFriendCallState }
 import im.tox.tox4j.av.exceptions._
+import im.tox.tox4j.av.proto.{ AudioMetering, AvStats, VideoFormat }
 import im.tox.tox4j.core.ToxCore
 import im.tox.tox4j.core.data.ToxFriendNumber
 import im.tox.tox4j.impl.jni.ToxAvImpl.logger
@@ -32,6 +34,13 @@ final class ToxAvImpl(@NotNull private val tox: ToxCoreImpl) extends ToxAv {
 
   private[jni] val instanceNumber = ToxAvJni.toxavNew(tox.instanceNumber)
 
+  /**
+   * The buffers currently registered for received video frames. Holding them
+   * here keeps them alive while the native side writes into them.
+   */
+  @SuppressWarnings(Array("org.wartremover.warts.Var"))
+  @volatile private[this] var videoFramePool = Array.empty[ByteBuffer]
+
   @SuppressWarnings(Array("org.wartremover.warts.AsInstanceOf"))
   override def create(tox: ToxCore): ToxAv = {
     try {
@@ -58,7 +67,174 @@ final class ToxAvImpl(@NotNull private val tox: ToxCoreImpl) extends ToxAv {
   }
 
   override def iterate[S](@NotNull handler: ToxAvEventListener[S])(state: S): S = {
-    ToxAvEventDispatch.dispatch(handler, ToxAvJni.toxavIterate(instanceNumber))(state)
+    ToxAvEventDispatch.dispatch(handler, videoFramePool, ToxAvJni.toxavIterate(instanceNumber))(state)
+  }
+
+  /**
+   * Register direct buffers to receive video frames into. A frame that fits
+   * into a free buffer is written there as packed Y, U and V planes instead
+   * of being sent through the event message, and the buffer is reused after
+   * the next [[iterate]]. Frames that fit nowhere are delivered as before.
+   * Pass an empty array to stop using the pool.
+   */
+  def setVideoFramePool(buffers: Array[ByteBuffer]): Unit = {
+    val pool = buffers.clone()
+    ToxAvJni.toxavSetVideoFramePool(instanceNumber, pool)
+    videoFramePool = pool
+  }
+
+  /**
+   * Choose how received video frames are passed to event listeners. For
+   * [[VideoFormat.RGBA]] and [[VideoFormat.ARGB]], frames are converted
+   * natively and go to listeners implementing [[VideoReceiveFramePixelsCallback]]
+   * instead of videoReceiveFrame.
+   */
+  def setVideoFormat(format: VideoFormat): Unit =
+    ToxAvJni.toxavSetVideoFormat(instanceNumber, format.value)
+
+  /**
+   * Choose whether received audio frames carry their peak and RMS levels,
+   * computed natively, for listeners mixing in [[AudioLevelsCallback]]. With
+   * [[AudioMetering.LEVELS_ONLY]], the samples are not passed to Java at all.
+   */
+  def setAudioMetering(metering: AudioMetering): Unit =
+    ToxAvJni.toxavSetAudioMetering(instanceNumber, metering.value)
+
+  /**
+   * Limit the video received from a friend before it reaches Java. Frames
+   * larger than maxWidth by maxHeight are scaled down to fit, keeping their
+   * aspect ratio, and frames beyond maxFps per second are dropped. Zero means
+   * no limit; all zeros restore full delivery.
+   */
+  def setVideoReceiveOptions(friendNumber: ToxFriendNumber, maxWidth: Int, maxHeight: Int, maxFps: Int): Unit =
+    ToxAvJni.toxavSetVideoReceiveOptions(instanceNumber, friendNumber.value, maxWidth, maxHeight, maxFps)
+
+  /**
+   * Keep at most one undelivered video frame from a friend. Its frames no
+   * longer go to the [[iterate]] listener, but wait natively until they are
+   * taken with [[takeVideoFrame]], and a newer frame replaces the one still
+   * waiting. A slow consumer then always renders the latest frame and memory
+   * stays bounded at one frame per friend. Disabling the mailbox drops the
+   * waiting frame.
+   */
+  def setVideoMailbox(friendNumber: ToxFriendNumber, enabled: Boolean): Unit =
+    ToxAvJni.toxavSetVideoMailbox(instanceNumber, friendNumber.value, enabled)
+
+  /**
+   * Pass the frame waiting in a friend's video mailbox to the handler, if a
+   * frame arrived since the last call. Handlers mixing in
+   * [[VideoFramesDroppedCallback]] are first told how many frames it
+   * replaced. A frame in a frame pool buffer stays there untouched until the
+   * next call for the same friend.
+   */
+  def takeVideoFrame[S](friendNumber: ToxFriendNumber, @NotNull handler: ToxAvEventListener[S])(state: S): S =
+    ToxAvEventDispatch.dispatch(handler, videoFramePool, ToxAvJni.toxavTakeVideoFrame(instanceNumber, friendNumber.value))(state)
+
+  /**
+   * Convert all received audio to one format natively, with a resampler per
+   * friend, before it is passed to the listener.
+   */
+  def setAudioReceiveFormat(samplingRate: SamplingRate, channels: AudioChannels): Unit =
+    ToxAvJni.toxavSetAudioReceiveFormat(instanceNumber, samplingRate.value, channels.value)
+
+  /**
+   * Pass received audio on in the format it arrived in, the default.
+   */
+  def clearAudioReceiveFormat(): Unit =
+    ToxAvJni.toxavSetAudioReceiveFormat(instanceNumber, 0, 0)
+
+  /**
+   * Detect silence by its energy natively. Frames whose mean power is below
+   * thresholdDbfs (dB relative to full scale, e.g. -50) more than hangoverMs
+   * after the last louder frame are silent. If send is true, silent frames
+   * passed to [[audioSendFrame]] are dropped. If receive is true, received
+   * silent frames are reported to listeners mixing in
+   * [[AudioReceiveSilenceCallback]] instead of being delivered.
+   */
+  def setVoiceActivityDetection(thresholdDbfs: Int, hangoverMs: Int, send: Boolean, receive: Boolean): Unit =
+    ToxAvJni.toxavSetVoiceActivityDetection(instanceNumber, thresholdDbfs, hangoverMs, send, receive)
+
+  /**
+   * Send a friend's video from a native pacing thread. Frames queued with
+   * [[videoEnqueueFrame]] go out at most maxFps times a second; the oldest is
+   * dropped when more than queueDepth are waiting, as are frames captured
+   * too soon after the last one sent. If videoBitRate is not 0, toxav
+   * reporting a lower video bit rate lowers the frame rate in proportion.
+   * A maxFps of 0 stops pacing and discards the queued frames.
+   */
+  def setVideoPacing(friendNumber: ToxFriendNumber, maxFps: Int, queueDepth: Int, videoBitRate: BitRate): Unit =
+    ToxAvJni.toxavSetVideoPacing(instanceNumber, friendNumber.value, maxFps, queueDepth, videoBitRate.value)
+
+  /**
+   * Set a call's bit rates natively, within [audioMin, audioMax] and
+   * [videoMin, videoMax] kbit/s, starting from the rates toxav first reports
+   * for the call and again for each new call with the friend. Lower rates
+   * suggested by toxav are followed at once and higher ones after the rate
+   * has held for holdMs. Video frames
+   * that fail with RTP_FAILED, or with SYNC after a retry, lower the video
+   * bit rate, also at most once per holdMs. A maximum of 0 leaves that rate
+   * alone, and both 0 turns the controller off. Changes are reported to
+   * listeners mixing in [[BitRateDecisionCallback]].
+   */
+  def setBitRateControl(
+    friendNumber: ToxFriendNumber,
+    audioMin: Int, audioMax: Int,
+    videoMin: Int, videoMax: Int,
+    holdMs: Int
+  ): Unit =
+    ToxAvJni.toxavSetBitRateControl(instanceNumber, friendNumber.value, audioMin, audioMax, videoMin, videoMax, holdMs)
+
+  /**
+   * Skip sending video frames that are identical to the last frame sent to
+   * the same friend, compared by a hash of their planes. An unchanged frame
+   * is still sent once keepAliveMs have passed since the last one; 0 never
+   * resends it. Skipped frames count as sent and are counted per friend.
+   *
+   * Video is sent over lossy RTP, so the last frame sent may never arrive.
+   * With a keepAliveMs of 0, the friend's picture then stays frozen on an
+   * older frame, or blank, until the video changes. Use 0 only for sources
+   * that change often enough to repair this themselves.
+   */
+  def setVideoDedup(enabled: Boolean, keepAliveMs: Int): Unit =
+    ToxAvJni.toxavSetVideoDedup(instanceNumber, enabled, keepAliveMs)
+
+  /**
+   * The number of unchanged video frames not sent to a friend since
+   * [[setVideoDedup]] was last called.
+   */
+  def videoFramesSkipped(friendNumber: ToxFriendNumber): Long =
+    ToxAvJni.toxavGetVideoFramesSkipped(instanceNumber, friendNumber.value)
+
+  /**
+   * A snapshot of the per-friend media counters: frames, bytes, send time and
+   * failures by error code for each direction sent, mean arrival interval and
+   * arrival-interval jitter for each direction received, and resolution
+   * changes. Counters of friends deleted from the Tox instance are dropped.
+   */
+  def stats: AvStats =
+    AvStats.parseFrom(ToxAvJni.toxavGetStats(instanceNumber))
+
+  /**
+   * Mix a conference natively. Audio received from the given friends is no
+   * longer passed to the listener. Instead, each of them is sent the mix of
+   * all the others in frames of sampleCount samples, from [[iterate]], after
+   * buffering jitterFrames frames of their audio. Calling this again with
+   * the same mixer number changes the participants, and an empty array
+   * removes the mixer. A friend can be in only one mixer at a time,
+   * and only once in the array.
+   */
+  def setAudioMixer(
+    mixerNumber: Int,
+    friendNumbers: Array[ToxFriendNumber],
+    sampleCount: SampleCount,
+    channels: AudioChannels,
+    samplingRate: SamplingRate,
+    jitterFrames: Int
+  ): Unit = {
+    ToxAvJni.toxavSetAudioMixer(
+      instanceNumber, mixerNumber, friendNumbers.map(_.value),
+      sampleCount.value, channels.value, samplingRate.value, jitterFrames
+    )
   }
 
   override def iterationInterval: Int =
@@ -91,6 +267,70 @@ final class ToxAvImpl(@NotNull private val tox: ToxCoreImpl) extends ToxAv {
     ToxAvJni.toxavAudioSendFrame(instanceNumber, friendNumber.value, pcm, sampleCount.value, channels.value, samplingRate.value)
   }
 
+  /**
+   * Send interleaved 16 bit samples in native byte order, starting at the
+   * position of a direct buffer. A buffer that is not direct, too small or
+   * not aligned for shorts throws IllegalArgumentException.
+   */
+  @throws[ToxavSendFrameException]
+  def audioSendFrame(
+    friendNumber: ToxFriendNumber,
+    pcm: ByteBuffer,
+    sampleCount: SampleCount,
+    channels: AudioChannels,
+    samplingRate: SamplingRate
+  ): Unit = {
+    ToxAvJni.toxavAudioSendFrameDirect(instanceNumber, friendNumber.value, pcm, pcm.position, sampleCount.value, channels.value, samplingRate.value)
+  }
+
+  /**
+   * Send audio at any sampling rate up to 192 kHz. Rates that toxav does not
+   * support are converted to 48 kHz natively, and sent in frames of the same
+   * duration as the input frames. Rates whose conversion would need an
+   * unreasonably large filter, such as primes, fail with INVALID.
+   */
+  @throws[ToxavSendFrameException]
+  def audioSendFrameResampled(
+    friendNumber: ToxFriendNumber,
+    pcm: Array[Short],
+    sampleCount: Int,
+    channels: AudioChannels,
+    samplingRate: Int
+  ): Unit = {
+    ToxAvJni.toxavAudioSendFrame(instanceNumber, friendNumber.value, pcm, sampleCount, channels.value, samplingRate)
+  }
+
+  /**
+   * Like [[audioSendFrame]], but failures are returned instead of thrown.
+   *
+   * @return 0 on success, or -(ordinal + 1) of the [[ToxavSendFrameException.Code]].
+   */
+  def audioSendFrameNoThrow(
+    friendNumber: ToxFriendNumber,
+    pcm: Array[Short],
+    sampleCount: SampleCount,
+    channels: AudioChannels,
+    samplingRate: SamplingRate
+  ): Long = {
+    ToxAvJni.toxavAudioSendFrameNoThrow(instanceNumber, friendNumber.value, pcm, sampleCount.value, channels.value, samplingRate.value)
+  }
+
+  /**
+   * Send the same audio frame to several friends with a single native call.
+   *
+   * @return for each friend in order, 0 on success or -(ordinal + 1) of the
+   *         [[ToxavSendFrameException.Code]].
+   */
+  def audioSendFrameMany(
+    friendNumbers: Array[ToxFriendNumber],
+    pcm: Array[Short],
+    sampleCount: SampleCount,
+    channels: AudioChannels,
+    samplingRate: SamplingRate
+  ): Array[Int] = {
+    ToxAvJni.toxavAudioSendFrameMany(instanceNumber, friendNumbers.map(_.value), pcm, sampleCount.value, channels.value, samplingRate.value)
+  }
+
   @throws[ToxavSendFrameException]
   override def videoSendFrame(
     friendNumber: ToxFriendNumber,
@@ -100,6 +340,72 @@ final class ToxAvImpl(@NotNull private val tox: ToxCoreImpl) extends ToxAv {
     ToxAvJni.toxavVideoSendFrame(instanceNumber, friendNumber.value, width, height, y, u, v)
   }
 
+  /**
+   * Send an I420 frame whose Y, U and V planes follow each other without
+   * padding, starting at the position of a direct buffer. Invalid dimensions
+   * fail with INVALID, and a buffer that is not direct or too small throws
+   * IllegalArgumentException.
+   */
+  @throws[ToxavSendFrameException]
+  def videoSendFrame(friendNumber: ToxFriendNumber, width: Int, height: Int, yuv: ByteBuffer): Unit = {
+    ToxAvJni.toxavVideoSendFrameDirect(instanceNumber, friendNumber.value, width, height, yuv, yuv.position)
+  }
+
+  /**
+   * Send a frame of RGBA pixels, starting at the position of a direct buffer
+   * with rows stride bytes apart. The conversion to I420 happens natively.
+   * Invalid dimensions or a stride below the row size fail with INVALID, and
+   * a buffer that is not direct or too small throws IllegalArgumentException.
+   */
+  @throws[ToxavSendFrameException]
+  def videoSendFrameRgba(friendNumber: ToxFriendNumber, width: Int, height: Int, rgba: ByteBuffer, stride: Int): Unit = {
+    // The native side reads from the start of the buffer.
+    val pixels = if (rgba.position == 0) rgba else rgba.slice()
+    ToxAvJni.toxavVideoSendFrameRgba(instanceNumber, friendNumber.value, width, height, pixels, stride)
+  }
+
+  /**
+   * Like [[videoSendFrame]], but failures are returned instead of thrown.
+   *
+   * @return 0 on success, or -(ordinal + 1) of the [[ToxavSendFrameException.Code]].
+   */
+  def videoSendFrameNoThrow(
+    friendNumber: ToxFriendNumber,
+    width: Int, height: Int,
+    y: Array[Byte], u: Array[Byte], v: Array[Byte]
+  ): Long = {
+    ToxAvJni.toxavVideoSendFrameNoThrow(instanceNumber, friendNumber.value, width, height, y, u, v)
+  }
+
+  /**
+   * Send the same video frame to several friends with a single native call.
+   *
+   * @return for each friend in order, 0 on success or -(ordinal + 1) of the
+   *         [[ToxavSendFrameException.Code]].
+   */
+  def videoSendFrameMany(
+    friendNumbers: Array[ToxFriendNumber],
+    width: Int, height: Int,
+    y: Array[Byte], u: Array[Byte], v: Array[Byte]
+  ): Array[Int] = {
+    ToxAvJni.toxavVideoSendFrameMany(instanceNumber, friendNumbers.map(_.value), width, height, y, u, v)
+  }
+
+  /**
+   * Queue a frame for the pacing thread set up with [[setVideoPacing]]. The
+   * planes are copied, so they can be reused as soon as this returns. The
+   * capture time is in milliseconds on any monotonic clock.
+   */
+  @throws[ToxavSendFrameException]
+  def videoEnqueueFrame(
+    friendNumber: ToxFriendNumber,
+    captureTimeMs: Long,
+    width: Int, height: Int,
+    y: Array[Byte], u: Array[Byte], v: Array[Byte]
+  ): Unit = {
+    ToxAvJni.toxavVideoEnqueueFrame(instanceNumber, friendNumber.value, captureTimeMs, width, height, y, u, v)
+  }
+
   def invokeAudioReceiveFrame(friendNumber: ToxFriendNumber, pcm: Array[Short], channels: AudioChannels, samplingRate: SamplingRate): Unit =
     ToxAvJni.invokeAudioReceiveFrame(instanceNumber, friendNumber.value, pcm, channels.value, samplingRate.value)
   def invokeBitRateStatus(friendNumber: ToxFriendNumber, audioBitRate: BitRate, videoBitRate: BitRate): Unit =
@@ -4,6 +4,8 @@ import im.tox.tox4j.av.exceptions.*;
 import org.jetbrains.annotations.NotNull;
 import org.jetbrains.annotations.Nullable;
 
+import java.nio.ByteBuffer;
+
 @SuppressWarnings({"checkstyle:emptylineseparator", "checkstyle:linelength"})
 public final class ToxAvJni {
 
@@ -17,6 +19,27 @@ public final class ToxAvJni {
   static native int toxavIterationInterval(int instanceNumber);
   @Nullable
   static native byte[] toxavIterate(int instanceNumber);
+  static native void toxavSetVideoFramePool(int instanceNumber, @Nullable ByteBuffer[] buffers);
+  static native void toxavSetVideoFormat(int instanceNumber, int format);
+  static native void toxavSetAudioMetering(int instanceNumber, int metering);
+  static native void toxavSetVideoReceiveOptions(int instanceNumber, int friendNumber, int maxWidth, int maxHeight, int maxFps);
+  static native void toxavSetVideoMailbox(int instanceNumber, int friendNumber, boolean enabled);
+  @Nullable
+  static native byte[] toxavTakeVideoFrame(int instanceNumber, int friendNumber);
+  static native void toxavSetAudioReceiveFormat(int instanceNumber, int samplingRate, int channels);
+  static native void toxavSetVoiceActivityDetection(int instanceNumber, int thresholdDbfs, int hangoverMs, boolean send, boolean receive);
+  static native void toxavSetVideoPacing(int instanceNumber, int friendNumber, int maxFps, int queueDepth, int videoBitRate);
+  static native void toxavSetBitRateControl(int instanceNumber, int friendNumber, int audioMin, int audioMax, int videoMin, int videoMax, int holdMs);
+  static native void toxavSetVideoDedup(int instanceNumber, boolean enabled, int keepAliveMs);
+  static native long toxavGetVideoFramesSkipped(int instanceNumber, int friendNumber);
+  @NotNull
+  static native byte[] toxavGetStats(int instanceNumber);
+  static native void toxavSetAudioMixer(
+      int instanceNumber,
+      int mixerNumber,
+      @NotNull int[] friendNumbers,
+      int sampleCount, int channels, int samplingRate, int jitterFrames
+  );
   static native void toxavCall(int instanceNumber, int friendNumber, int audioBitRate, int videoBitRate) throws ToxavCallException;
   static native void toxavAnswer(int instanceNumber, int friendNumber, int audioBitRate, int videoBitRate) throws ToxavAnswerException;
   static native void toxavCallControl(int instanceNumber, int friendNumber, int control) throws ToxavCallControlException;
@@ -28,6 +51,24 @@ public final class ToxAvJni {
       @NotNull short[] pcm, int sampleCount, int channels, int samplingRate
   ) throws ToxavSendFrameException;
 
+  static native void toxavAudioSendFrameDirect(
+      int instanceNumber,
+      int friendNumber,
+      @NotNull ByteBuffer pcm, int offset, int sampleCount, int channels, int samplingRate
+  ) throws ToxavSendFrameException;
+
+  static native long toxavAudioSendFrameNoThrow(
+      int instanceNumber,
+      int friendNumber,
+      @NotNull short[] pcm, int sampleCount, int channels, int samplingRate
+  );
+
+  static native int[] toxavAudioSendFrameMany(
+      int instanceNumber,
+      @NotNull int[] friendNumbers,
+      @NotNull short[] pcm, int sampleCount, int channels, int samplingRate
+  );
+
   @SuppressWarnings("checkstyle:parametername")
   static native void toxavVideoSendFrame(
       int instanceNumber,
@@ -36,6 +77,45 @@ public final class ToxAvJni {
       @NotNull byte[] y, @NotNull byte[] u, @NotNull byte[] v
   ) throws ToxavSendFrameException;
 
+  static native void toxavVideoSendFrameDirect(
+      int instanceNumber,
+      int friendNumber,
+      int width, int height,
+      @NotNull ByteBuffer yuv, int offset
+  ) throws ToxavSendFrameException;
+
+  static native void toxavVideoSendFrameRgba(
+      int instanceNumber,
+      int friendNumber,
+      int width, int height,
+      @NotNull ByteBuffer rgba, int stride
+  ) throws ToxavSendFrameException;
+
+  @SuppressWarnings("checkstyle:parametername")
+  static native long toxavVideoSendFrameNoThrow(
+      int instanceNumber,
+      int friendNumber,
+      int width, int height,
+      @NotNull byte[] y, @NotNull byte[] u, @NotNull byte[] v
+  );
+
+  @SuppressWarnings("checkstyle:parametername")
+  static native int[] toxavVideoSendFrameMany(
+      int instanceNumber,
+      @NotNull int[] friendNumbers,
+      int width, int height,
+      @NotNull byte[] y, @NotNull byte[] u, @NotNull byte[] v
+  );
+
+  @SuppressWarnings("checkstyle:parametername")
+  static native void toxavVideoEnqueueFrame(
+      int instanceNumber,
+      int friendNumber,
+      long captureTimeMs,
+      int width, int height,
+      @NotNull byte[] y, @NotNull byte[] u, @NotNull byte[] v
+  ) throws ToxavSendFrameException;
+
   static native void invokeAudioReceiveFrame(int instanceNumber, int friendNumber, short[] pcm, int channels, int samplingRate);
   static native void invokeBitRateStatus(int instanceNumber, int friendNumber, int audioBitRate, int videoBitRate);
   static native void invokeCall(int instanceNumber, int friendNumber, boolean audioEnabled, boolean videoEnabled);
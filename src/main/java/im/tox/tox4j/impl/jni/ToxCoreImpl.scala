@@ -1,5 +1,7 @@
 package im.tox.tox4j.impl.jni
 
+import java.nio.ByteBuffer
+
 import com.typesafe.scalalogging.Logger
 import im.tox.core.network.Port
 import im.tox.tox4j.core._
@@ -233,6 +235,24 @@ final class ToxCoreImpl(@NotNull val options: ToxOptions) extends ToxCore {
   override def friendSendMessage(friendNumber: ToxFriendNumber, messageType: ToxMessageType, timeDelta: Int, message: ToxFriendMessage): Int =
     ToxCoreJni.toxFriendSendMessage(instanceNumber, friendNumber.value, messageType.ordinal, timeDelta, message.value)
 
+  /**
+   * Send the remaining bytes of a direct buffer as a message, without copying
+   * them. The buffer's position is not changed.
+   */
+  @throws[ToxFriendSendMessageException]
+  def friendSendMessage(friendNumber: ToxFriendNumber, messageType: ToxMessageType, timeDelta: Int, message: ByteBuffer): Int =
+    ToxCoreJni.toxFriendSendMessageDirect(instanceNumber, friendNumber.value, messageType.ordinal, timeDelta, message, message.position, message.remaining)
+
+  /**
+   * Like [[friendSendMessage]], but failures are returned instead of thrown,
+   * so that routine errors like FRIEND_NOT_CONNECTED or SENDQ don't allocate.
+   *
+   * @return The message ID if non-negative. Otherwise, the failure is the
+   *         [[ToxFriendSendMessageException.Code]] with ordinal -(result + 1).
+   */
+  def friendSendMessageNoThrow(friendNumber: ToxFriendNumber, messageType: ToxMessageType, timeDelta: Int, message: ToxFriendMessage): Long =
+    ToxCoreJni.toxFriendSendMessageNoThrow(instanceNumber, friendNumber.value, messageType.ordinal, timeDelta, message.value)
+
   @throws[ToxFileControlException]
   override def fileControl(friendNumber: ToxFriendNumber, fileNumber: Int, control: ToxFileControl): Unit =
     ToxCoreJni.toxFileControl(instanceNumber, friendNumber.value, fileNumber, control.ordinal)
@@ -249,6 +269,16 @@ final class ToxCoreImpl(@NotNull val options: ToxOptions) extends ToxCore {
   override def fileSendChunk(friendNumber: ToxFriendNumber, fileNumber: Int, position: Long, data: Array[Byte]): Unit =
     ToxCoreJni.toxFileSendChunk(instanceNumber, friendNumber.value, fileNumber, position, data)
 
+  @throws[ToxFileSendChunkException]
+  def fileSendChunk(friendNumber: ToxFriendNumber, fileNumber: Int, position: Long, data: ByteBuffer): Unit =
+    ToxCoreJni.toxFileSendChunkDirect(instanceNumber, friendNumber.value, fileNumber, position, data, data.position, data.remaining)
+
+  /**
+   * @return 0 on success, or -(ordinal + 1) of the [[ToxFileSendChunkException.Code]].
+   */
+  def fileSendChunkNoThrow(friendNumber: ToxFriendNumber, fileNumber: Int, position: Long, data: Array[Byte]): Long =
+    ToxCoreJni.toxFileSendChunkNoThrow(instanceNumber, friendNumber.value, fileNumber, position, data)
+
   @throws[ToxFileGetException]
   override def getFileFileId(friendNumber: ToxFriendNumber, fileNumber: Int): ToxFileId =
     ToxFileId.unsafeFromValue(ToxCoreJni.toxFileGetFileId(instanceNumber, friendNumber.value, fileNumber))
@@ -257,10 +287,30 @@ final class ToxCoreImpl(@NotNull val options: ToxOptions) extends ToxCore {
   override def friendSendLossyPacket(friendNumber: ToxFriendNumber, data: ToxLossyPacket): Unit =
     ToxCoreJni.toxFriendSendLossyPacket(instanceNumber, friendNumber.value, data.value)
 
+  @throws[ToxFriendCustomPacketException]
+  def friendSendLossyPacket(friendNumber: ToxFriendNumber, data: ByteBuffer): Unit =
+    ToxCoreJni.toxFriendSendLossyPacketDirect(instanceNumber, friendNumber.value, data, data.position, data.remaining)
+
+  /**
+   * @return 0 on success, or -(ordinal + 1) of the [[ToxFriendCustomPacketException.Code]].
+   */
+  def friendSendLossyPacketNoThrow(friendNumber: ToxFriendNumber, data: ToxLossyPacket): Long =
+    ToxCoreJni.toxFriendSendLossyPacketNoThrow(instanceNumber, friendNumber.value, data.value)
+
   @throws[ToxFriendCustomPacketException]
   override def friendSendLosslessPacket(friendNumber: ToxFriendNumber, data: ToxLosslessPacket): Unit =
     ToxCoreJni.toxFriendSendLosslessPacket(instanceNumber, friendNumber.value, data.value)
 
+  @throws[ToxFriendCustomPacketException]
+  def friendSendLosslessPacket(friendNumber: ToxFriendNumber, data: ByteBuffer): Unit =
+    ToxCoreJni.toxFriendSendLosslessPacketDirect(instanceNumber, friendNumber.value, data, data.position, data.remaining)
+
+  /**
+   * @return 0 on success, or -(ordinal + 1) of the [[ToxFriendCustomPacketException.Code]].
+   */
+  def friendSendLosslessPacketNoThrow(friendNumber: ToxFriendNumber, data: ToxLosslessPacket): Long =
+    ToxCoreJni.toxFriendSendLosslessPacketNoThrow(instanceNumber, friendNumber.value, data.value)
+
   def invokeFriendName(friendNumber: ToxFriendNumber, @NotNull name: ToxNickname): Unit =
     ToxCoreJni.invokeFriendName(instanceNumber, friendNumber.value, name.value)
   def invokeFriendStatusMessage(friendNumber: ToxFriendNumber, @NotNull message: Array[Byte]): Unit =
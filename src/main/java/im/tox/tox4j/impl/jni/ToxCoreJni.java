@@ -4,6 +4,8 @@ import im.tox.tox4j.core.exceptions.*;
 import org.jetbrains.annotations.NotNull;
 import org.jetbrains.annotations.Nullable;
 
+import java.nio.ByteBuffer;
+
 @SuppressWarnings({"checkstyle:emptylineseparator", "checkstyle:linelength"})
 public final class ToxCoreJni {
 
@@ -70,14 +72,22 @@ public final class ToxCoreJni {
   static native int[] toxSelfGetFriendList(int instanceNumber);
   static native void toxSelfSetTyping(int instanceNumber, int friendNumber, boolean typing) throws ToxSetTypingException;
   static native int toxFriendSendMessage(int instanceNumber, int friendNumber, int type, int timeDelta, @NotNull byte[] message) throws ToxFriendSendMessageException;
+  static native int toxFriendSendMessageDirect(int instanceNumber, int friendNumber, int type, int timeDelta, @NotNull ByteBuffer message, int offset, int length) throws ToxFriendSendMessageException;
+  static native long toxFriendSendMessageNoThrow(int instanceNumber, int friendNumber, int type, int timeDelta, @NotNull byte[] message);
   static native void toxFileControl(int instanceNumber, int friendNumber, int fileNumber, int control) throws ToxFileControlException;
   static native void toxFileSeek(int instanceNumber, int friendNumber, int fileNumber, long position) throws ToxFileSeekException;
   static native int toxFileSend(int instanceNumber, int friendNumber, int kind, long fileSize, @NotNull byte[] fileId, @NotNull byte[] filename) throws ToxFileSendException;
   static native void toxFileSendChunk(int instanceNumber, int friendNumber, int fileNumber, long position, @NotNull byte[] data) throws ToxFileSendChunkException;
+  static native void toxFileSendChunkDirect(int instanceNumber, int friendNumber, int fileNumber, long position, @NotNull ByteBuffer data, int offset, int length) throws ToxFileSendChunkException;
+  static native long toxFileSendChunkNoThrow(int instanceNumber, int friendNumber, int fileNumber, long position, @NotNull byte[] data);
   @NotNull
   static native byte[] toxFileGetFileId(int instanceNumber, int friendNumber, int fileNumber) throws ToxFileGetException;
   static native void toxFriendSendLossyPacket(int instanceNumber, int friendNumber, @NotNull byte[] data) throws ToxFriendCustomPacketException;
+  static native void toxFriendSendLossyPacketDirect(int instanceNumber, int friendNumber, @NotNull ByteBuffer data, int offset, int length) throws ToxFriendCustomPacketException;
+  static native long toxFriendSendLossyPacketNoThrow(int instanceNumber, int friendNumber, @NotNull byte[] data);
   static native void toxFriendSendLosslessPacket(int instanceNumber, int friendNumber, @NotNull byte[] data) throws ToxFriendCustomPacketException;
+  static native void toxFriendSendLosslessPacketDirect(int instanceNumber, int friendNumber, @NotNull ByteBuffer data, int offset, int length) throws ToxFriendCustomPacketException;
+  static native long toxFriendSendLosslessPacketNoThrow(int instanceNumber, int friendNumber, @NotNull byte[] data);
 
   static native void invokeSelfConnectionStatus(int instanceNumber, int connectionStatus);
   static native void invokeFileRecvControl(int instanceNumber, int friendNumber, int fileNumber, int control);
@@ -100,5 +110,9 @@ public final class ToxCoreJni {
   static native void tox4jSetMaxLogSize(int maxSize);
   static native int tox4jGetMaxLogSize();
   static native void tox4jSetLogFilter(String[] filter);
+  static native boolean tox4jSetLogFile(String path, long segmentSize);
+  static native void tox4jSetLatencyAggregation(boolean enabled);
+  static native boolean tox4jGetLatencyAggregation();
+  static native byte[] tox4jLastLatencyStats();
 
 }
@@ -1,6 +1,6 @@
 package im.tox.tox4j.impl.jni
 
-import java.io.{ PrintWriter, StringWriter }
+import java.io.{ InputStream, PrintWriter, StringWriter }
 
 import com.google.protobuf.InvalidProtocolBufferException
 import com.typesafe.scalalogging.Logger
@@ -61,6 +61,45 @@ case object ToxJniLog {
     fromBytes(ToxCoreJni.tox4jLastLog())
   }
 
+  /**
+   * Stream every log entry to memory-mapped files named "$path.0", "$path.1", etc.
+   * from a native background thread. Each file is about $segmentSize bytes and
+   * contains length-delimited [[JniLogEntry]] messages. While streaming, [[maxSize]]
+   * is ignored and [[apply]] returns the empty log.
+   *
+   * Returns false if the first file could not be created.
+   */
+  def streamTo(path: String, segmentSize: Long = 64L * 1024 * 1024): Boolean = {
+    ToxCoreJni.tox4jSetLogFile(path, segmentSize)
+  }
+
+  /**
+   * Stop streaming and close the current trace file after all pending entries
+   * are written.
+   */
+  def stopStreaming(): Unit = ToxCoreJni.tox4jSetLogFile(null, 0)
+
+  /**
+   * Enable or disable latency aggregation. While enabled, every native call is
+   * counted in a per-function, per-instance histogram, regardless of [[maxSize]].
+   */
+  def latencyAggregation_=(enabled: Boolean): Unit = ToxCoreJni.tox4jSetLatencyAggregation(enabled)
+  def latencyAggregation: Boolean = ToxCoreJni.tox4jGetLatencyAggregation
+
+  /**
+   * Retrieve and reset the aggregated latency statistics. Each call returns the
+   * statistics for the calls made since the previous one.
+   */
+  def latencyStats(): JniLatencyStats = {
+    try {
+      JniLatencyStats.parseFrom(ToxCoreJni.tox4jLastLatencyStats())
+    } catch {
+      case e: InvalidProtocolBufferException =>
+        logger.error(s"${e.getMessage}; unfinished message: ${e.getUnfinishedMessage}")
+        JniLatencyStats.defaultInstance
+    }
+  }
+
   /**
    * Parse a protobuf message from bytes to [[JniLog]]. Logs an error and returns
    * [[JniLog.defaultInstance]] if $bytes is invalid. Returns [[JniLog.defaultInstance]]
@@ -76,6 +115,14 @@ case object ToxJniLog {
     }
   }
 
+  /**
+   * Read length-delimited [[JniLogEntry]] messages as written by [[streamTo]] until
+   * the end of the stream.
+   */
+  def readTrace(in: InputStream): Iterator[JniLogEntry] = {
+    Iterator.continually(JniLogEntry.parseDelimitedFrom(in)).takeWhile(_.isDefined).flatten
+  }
+
   @SuppressWarnings(Array("org.wartremover.warts.While"))
   private def printDelimited[A](list: Iterable[A], separator: String)(print: A => PrintWriter => Unit)(out: PrintWriter): Unit = {
     val i = list.iterator
@@ -140,6 +187,8 @@ case object ToxJniLog {
     out.print('[')
     printFormattedTimeDiff(entry.timestamp.getOrElse(Timestamp.defaultInstance), startTime)(out)
     out.print("] ")
+    // Indent callbacks and other nested calls below the call they were made from.
+    out.print("  " * entry.depth)
     out.print(entry.name)
     out.print('(')
     printDelimited(entry.arguments, ", ")(print)(out)
@@ -189,6 +238,48 @@ case object ToxJniLog {
     print(member._2)(out)
   }
 
+  private def printJsonString(string: String)(out: PrintWriter): Unit = {
+    out.print('"')
+    string.foreach {
+      case '"'          => out.print("\\\"")
+      case '\\'         => out.print("\\\\")
+      case c if c < ' ' => out.print(f"\\u${c.toInt}%04x")
+      case c            => out.print(c)
+    }
+    out.print('"')
+  }
+
+  /**
+   * Print the entries in Chrome's trace event format, which can be loaded into
+   * chrome://tracing or the Perfetto UI. Each instance is shown as a process and
+   * each native thread as a thread within it, so that callbacks appear nested
+   * inside the iterate call that invoked them.
+   */
+  @SuppressWarnings(Array("org.wartremover.warts.Var"))
+  def printChromeTrace(entries: TraversableOnce[JniLogEntry])(out: PrintWriter): Unit = {
+    out.println("{\"displayTimeUnit\":\"ns\",\"traceEvents\":[")
+    var first = true
+    for (entry <- entries) {
+      if (!first) {
+        out.println(',')
+      }
+      first = false
+
+      val timestamp = entry.timestamp.getOrElse(Timestamp.defaultInstance)
+      out.print("{\"name\":")
+      printJsonString(entry.name)(out)
+      out.print(",\"ph\":\"X\"")
+      // Microseconds with nanosecond precision, printed as a string to avoid
+      // losing precision in a Double.
+      out.print(f",\"ts\":${timestamp.seconds}%d${timestamp.nanos / 1000}%06d.${timestamp.nanos % 1000}%03d")
+      out.print(f",\"dur\":${entry.elapsedNanos / 1000}%d.${entry.elapsedNanos % 1000}%03d")
+      out.print(s",\"pid\":${entry.instanceNumber},\"tid\":${entry.threadId}")
+      out.print(s",\"args\":{\"depth\":${entry.depth}}}")
+    }
+    out.println()
+    out.println("]}")
+  }
+
   def toString(log: JniLog): String = {
     val stringWriter = new StringWriter
     val out = new PrintWriter(stringWriter)
@@ -0,0 +1,13 @@
+package im.tox.tox4j.impl.jni
+
+import im.tox.tox4j.core.data.ToxFriendNumber
+
+/**
+ * Told how many frames were replaced in a friend's video mailbox, enabled
+ * with [[ToxAvImpl.setVideoMailbox]], before the frame that replaced them is
+ * taken with [[ToxAvImpl.takeVideoFrame]]. Event listeners mix this in to
+ * find out how far behind they are.
+ */
+trait VideoFramesDroppedCallback[ToxCoreState] {
+  def videoFramesDropped(friendNumber: ToxFriendNumber, count: Int)(state: ToxCoreState): ToxCoreState = state
+}
@@ -0,0 +1,27 @@
+package im.tox.tox4j.impl.jni
+
+import im.tox.tox4j.av.data.{ Height, Width }
+import im.tox.tox4j.av.proto.VideoFormat
+import im.tox.tox4j.core.data.ToxFriendNumber
+
+/**
+ * Receives video frames that were converted to 32 bit pixels, after
+ * [[ToxAvImpl.setVideoFormat]] selected [[VideoFormat.RGBA]] or
+ * [[VideoFormat.ARGB]]. Event listeners mix this in to get those frames;
+ * listeners that don't will not see them.
+ */
+trait VideoReceiveFramePixelsCallback[ToxCoreState] {
+  /**
+   * An array of at least width * height * 4 bytes to receive the next frame
+   * into, or None to allocate a new one.
+   */
+  def videoFrameCachedPixels(width: Width, height: Height): Option[Array[Byte]] = None
+
+  def videoReceiveFramePixels(
+    friendNumber: ToxFriendNumber,
+    width: Width,
+    height: Height,
+    format: VideoFormat,
+    pixels: Array[Byte]
+  )(state: ToxCoreState): ToxCoreState = state
+}
@@ -1,5 +1,6 @@
 package im.tox.tox4j.av.callbacks
 
+import java.nio.ByteBuffer
 import java.util
 
 import im.tox.tox4j.av.callbacks.AvInvokeTest._
@@ -9,7 +10,7 @@ import im.tox.tox4j.core.SmallNat
 import im.tox.tox4j.core.callbacks.InvokeTest.{ ByteArray, ShortArray }
 import im.tox.tox4j.core.data.ToxFriendNumber
 import im.tox.tox4j.core.options.ToxOptions
-import im.tox.tox4j.impl.jni.{ ToxAvImpl, ToxCoreImpl }
+import im.tox.tox4j.impl.jni.{ ToxAvImpl, ToxCoreImpl, VideoFramesDroppedCallback }
 import org.scalacheck.Arbitrary.arbitrary
 import org.scalacheck.{ Arbitrary, Gen }
 import org.scalatest.FunSuite
@@ -19,6 +20,7 @@ import scala.collection.JavaConverters._
 import scala.language.implicitConversions
 import scala.util.Random
 
+@SuppressWarnings(Array("org.wartremover.warts.Equals"))
 final class AvInvokeTest extends FunSuite with PropertyChecks {
 
   final class TestEventListener extends ToxAvEventListener[Option[Event]] {
@@ -36,7 +38,7 @@ final class AvInvokeTest extends FunSuite with PropertyChecks {
     // scalastyle:on line.size.limit
   }
 
-  def callbackTest(invoke: ToxAvEventSynth => Unit, expected: Event): Unit = {
+  def callbackTest(invoke: ToxAvImpl => Unit, expected: Event): Unit = {
     val tox = new ToxCoreImpl(ToxOptions())
     val toxav = new ToxAvImpl(tox)
 
@@ -139,19 +141,127 @@ final class AvInvokeTest extends FunSuite with PropertyChecks {
     }
   }
 
+  /**
+   * The rows of a plane as toxav would pass them for the given stride, packed
+   * and top-down. For negative strides, the first row is the last in memory.
+   */
+  private def packed(plane: Array[Byte], width: Int, height: Int, stride: Int): Array[Byte] = {
+    (0 until height).toArray.flatMap { row =>
+      val start =
+        if (stride < 0) {
+          (height - 1 - row) * -stride
+        } else {
+          row * stride
+        }
+      plane.slice(start, start + width)
+    }
+  }
+
   test("VideoReceiveFrame") {
-    forAll { (friendNumber: ToxFriendNumber, width: Width, height: Height, yStride: SmallNat, uStride: SmallNat, vStride: SmallNat) =>
+    forAll { (friendNumber: ToxFriendNumber, width: Width, height: Height, yStride: SmallNat, uStride: SmallNat, vStride: SmallNat, bottomUp: Boolean) =>
       val w = width.value
       val h = height.value
+      val sign = if (bottomUp) -1 else 1
       val y = Array.ofDim[Byte]((w max yStride) * h)
-      val u = Array.ofDim[Byte](((w / 2) max Math.abs(uStride)) * (h / 2))
-      val v = Array.ofDim[Byte](((w / 2) max Math.abs(vStride)) * (h / 2))
+      val u = Array.ofDim[Byte](((w / 2) max uStride) * (h / 2))
+      val v = Array.ofDim[Byte](((w / 2) max vStride) * (h / 2))
       random.nextBytes(y)
       random.nextBytes(u)
       random.nextBytes(v)
+      val strides = (sign * (w max yStride), sign * ((w / 2) max uStride), sign * ((w / 2) max vStride))
+      callbackTest(
+        _.invokeVideoReceiveFrame(friendNumber, width, height, y, u, v, strides._1, strides._2, strides._3),
+        VideoReceiveFrame(
+          friendNumber, width, height,
+          packed(y, w, h, strides._1),
+          packed(u, w / 2, h / 2, strides._2),
+          packed(v, w / 2, h / 2, strides._3),
+          w, w / 2, w / 2
+        )
+      )
+    }
+  }
+
+  test("VideoReceiveFrame into frame pool") {
+    forAll { (friendNumber: ToxFriendNumber, width: Width, height: Height) =>
+      val w = width.value
+      val h = height.value
+      val y = Array.ofDim[Byte](w * h)
+      val u = Array.ofDim[Byte]((w / 2) * (h / 2))
+      val v = Array.ofDim[Byte]((w / 2) * (h / 2))
+      random.nextBytes(y)
+      random.nextBytes(u)
+      random.nextBytes(v)
+      callbackTest(
+        { toxav =>
+          toxav.setVideoFramePool(Array(ByteBuffer.allocateDirect(y.length + u.length + v.length)))
+          toxav.invokeVideoReceiveFrame(friendNumber, width, height, y, u, v, w, w / 2, w / 2)
+        },
+        VideoReceiveFrame(friendNumber, width, height, y, u, v, w, w / 2, w / 2)
+      )
+    }
+  }
+
+  test("VideoReceiveFrame in mailbox mode across iterations") {
+    forAll { (friendNumber: ToxFriendNumber, width: Width, height: Height) =>
+      val w = width.value
+      val h = height.value
+      val frames = List.fill(3) {
+        val y = Array.ofDim[Byte](w * h)
+        val u = Array.ofDim[Byte]((w / 2) * (h / 2))
+        val v = Array.ofDim[Byte]((w / 2) * (h / 2))
+        random.nextBytes(y)
+        random.nextBytes(u)
+        random.nextBytes(v)
+        (y, u, v)
+      }
+      val (y, u, v) = frames.last
+
+      val tox = new ToxCoreImpl(ToxOptions())
+      val toxav = new ToxAvImpl(tox)
+      try {
+        toxav.setVideoMailbox(friendNumber, enabled = true)
+        // One frame per iteration, as toxav delivers them. None of them reach
+        // the iterate listener.
+        frames.foreach {
+          case (y, u, v) =>
+            toxav.invokeVideoReceiveFrame(friendNumber, width, height, y, u, v, w, w / 2, w / 2)
+            assert(toxav.iterate(new TestEventListener)(None).isEmpty)
+        }
+
+        val dropped = new ToxAvEventAdapter[Int] with VideoFramesDroppedCallback[Int] {
+          override def videoFramesDropped(friendNumber: ToxFriendNumber, count: Int)(state: Int): Int = state + count
+        }
+        toxav.invokeVideoReceiveFrame(friendNumber, width, height, y, u, v, w, w / 2, w / 2)
+        assert(toxav.takeVideoFrame(friendNumber, dropped)(0) == frames.length)
+
+        // The mailbox is empty until the next frame arrives.
+        assert(toxav.takeVideoFrame(friendNumber, new TestEventListener)(None).isEmpty)
+        toxav.invokeVideoReceiveFrame(friendNumber, width, height, y, u, v, w, w / 2, w / 2)
+        assert(toxav.iterate(new TestEventListener)(None).isEmpty)
+        val event = toxav.takeVideoFrame(friendNumber, new TestEventListener)(None)
+        assert(event.contains(VideoReceiveFrame(friendNumber, width, height, y, u, v, w, w / 2, w / 2)))
+      } finally {
+        toxav.close()
+        tox.close()
+      }
+    }
+  }
+
+  test("received frames are counted in stats") {
+    forAll { (friendNumber: ToxFriendNumber, width: Width, height: Height) =>
+      val w = width.value
+      val h = height.value
+      val y = Array.ofDim[Byte](w * h)
+      val u = Array.ofDim[Byte]((w / 2) * (h / 2))
+      val v = Array.ofDim[Byte]((w / 2) * (h / 2))
       callbackTest(
-        _.invokeVideoReceiveFrame(friendNumber, width, height, y, u, v, yStride, uStride, vStride),
-        VideoReceiveFrame(friendNumber, width, height, y, u, v, yStride, uStride, vStride)
+        { toxav =>
+          toxav.invokeVideoReceiveFrame(friendNumber, width, height, y, u, v, w, w / 2, w / 2)
+          val friend = toxav.stats.friends.find(_.friendNumber == friendNumber.value)
+          assert(friend.flatMap(_.videoReceived).map(_.frames).contains(1L))
+        },
+        VideoReceiveFrame(friendNumber, width, height, y, u, v, w, w / 2, w / 2)
       )
     }
   }
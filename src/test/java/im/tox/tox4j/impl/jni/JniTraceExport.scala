@@ -0,0 +1,25 @@
+package im.tox.tox4j.impl.jni
+
+import java.io.PrintWriter
+
+/**
+ * Converts trace files written by [[ToxJniLog.streamTo]] to Chrome's trace event
+ * JSON format on standard output. Open the result in chrome://tracing or
+ * https://ui.perfetto.dev to see where each call, including the callbacks made
+ * from inside iterate, spends its time.
+ *
+ * Usage: JniTraceExport trace.0 trace.1 ... > trace.json
+ */
+object JniTraceExport {
+
+  def export(fileNames: Seq[String])(out: PrintWriter): Unit = {
+    ToxJniLog.printChromeTrace(JniTraceStats.readFiles(fileNames))(out)
+  }
+
+  def main(args: Array[String]): Unit = {
+    val out = new PrintWriter(System.out)
+    export(args)(out)
+    out.flush()
+  }
+
+}
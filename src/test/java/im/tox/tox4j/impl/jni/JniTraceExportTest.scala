@@ -0,0 +1,79 @@
+package im.tox.tox4j.impl.jni
+
+import java.io.{ File, PrintWriter, StringWriter }
+
+import im.tox.tox4j.core.data.ToxFriendNumber
+import im.tox.tox4j.impl.jni.proto.{ JniLogEntry, Timestamp }
+import org.scalatest.FunSuite
+
+@SuppressWarnings(Array("org.wartremover.warts.Equals"))
+final class JniTraceExportTest extends FunSuite {
+
+  private val friendNumber = ToxFriendNumber.fromInt(0).get
+
+  private def chromeTrace(print: PrintWriter => Unit): List[String] = {
+    val stringWriter = new StringWriter
+    val out = new PrintWriter(stringWriter)
+    print(out)
+    out.close()
+    stringWriter.toString.split("\r?\n").toList
+  }
+
+  test("entries are exported as complete events in microseconds") {
+    val entries = Seq(
+      JniLogEntry(
+        name = "toxav_iterate",
+        instanceNumber = 1,
+        timestamp = Some(Timestamp(1500000000, 123456789)),
+        elapsedNanos = 2500,
+        threadId = 3
+      ),
+      JniLogEntry(
+        name = "callback \"a\\b\"",
+        instanceNumber = 1,
+        timestamp = Some(Timestamp(1500000000, 123457000)),
+        elapsedNanos = 5,
+        depth = 1,
+        threadId = 3
+      )
+    )
+
+    assert(chromeTrace(ToxJniLog.printChromeTrace(entries)) == List(
+      "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[",
+      "{\"name\":\"toxav_iterate\",\"ph\":\"X\",\"ts\":1500000000123456.789,\"dur\":2.500," +
+        "\"pid\":1,\"tid\":3,\"args\":{\"depth\":0}},",
+      "{\"name\":\"callback \\\"a\\\\b\\\"\",\"ph\":\"X\",\"ts\":1500000000123457.000,\"dur\":0.005," +
+        "\"pid\":1,\"tid\":3,\"args\":{\"depth\":1}}",
+      "]}"
+    ))
+  }
+
+  test("streamed timestamps are exported in system time") {
+    val path = File.createTempFile("JniTraceExportTest", "")
+    path.delete()
+
+    val startMicros = System.currentTimeMillis * 1000
+    assert(ToxJniLog.streamTo(path.getPath))
+    try {
+      ToxCoreImplFactory.withToxUnit { tox => tox.friendExists(friendNumber) }
+    } finally {
+      ToxJniLog.stopStreaming()
+    }
+    val endMicros = System.currentTimeMillis * 1000
+
+    val file = new File(s"${path.getPath}.0")
+    try {
+      val events = chromeTrace(JniTraceExport.export(Seq(file.getPath))).filter(_.startsWith("{\"name\""))
+      assert(events.exists(_.contains("\"tox_friend_exists\"")))
+
+      // The clock is calibrated against the system time, so every call lies
+      // within the test, give or take the calibration error.
+      val timestamps = events.map(event => BigDecimal("\"ts\":([0-9.]+)".r.findFirstMatchIn(event).map(_.group(1)).getOrElse("0")))
+      val slackMicros = 1000000
+      assert(timestamps.forall(ts => ts >= startMicros - slackMicros && ts <= endMicros + slackMicros))
+    } finally {
+      file.delete()
+    }
+  }
+
+}
@@ -0,0 +1,79 @@
+package im.tox.tox4j.impl.jni
+
+import java.io.{ BufferedInputStream, FileInputStream, PrintWriter }
+
+import im.tox.tox4j.impl.jni.proto.JniLogEntry
+
+/**
+ * Reads trace files written by [[ToxJniLog.streamTo]] and prints the call count
+ * and latency percentiles of every native function, slowest total first.
+ *
+ * Usage: JniTraceStats trace.0 trace.1 ...
+ */
+object JniTraceStats {
+
+  final case class FunctionStats(
+    name: String,
+    calls: Int,
+    totalNanos: Long,
+    p50: Long,
+    p99: Long,
+    p999: Long,
+    max: Long
+  )
+
+  private def percentile(sorted: IndexedSeq[Long], fraction: Double): Long = {
+    sorted(math.min(sorted.length - 1, (fraction * sorted.length).toInt))
+  }
+
+  /**
+   * The latency statistics of each function in the entries, slowest total first.
+   */
+  def summarize(entries: TraversableOnce[JniLogEntry]): Seq[FunctionStats] = {
+    entries.toSeq.groupBy(_.name).toSeq.map {
+      case (name, calls) =>
+        val sorted = calls.map(_.elapsedNanos.toLong).sorted.toIndexedSeq
+        FunctionStats(
+          name,
+          sorted.length,
+          sorted.sum,
+          percentile(sorted, 0.5),
+          percentile(sorted, 0.99),
+          percentile(sorted, 0.999),
+          sorted(sorted.length - 1)
+        )
+    }.sortBy(-_.totalNanos)
+  }
+
+  /**
+   * Read all entries of the given trace files in order.
+   */
+  def readFiles(fileNames: Seq[String]): Seq[JniLogEntry] = {
+    fileNames.flatMap { fileName =>
+      val in = new BufferedInputStream(new FileInputStream(fileName))
+      try {
+        ToxJniLog.readTrace(in).toList
+      } finally {
+        in.close()
+      }
+    }
+  }
+
+  def print(stats: Seq[FunctionStats])(out: PrintWriter): Unit = {
+    out.println(f"${"function"}%-50s ${"calls"}%10s ${"p50"}%10s ${"p99"}%10s ${"p99.9"}%10s ${"max"}%10s")
+    for (function <- stats) {
+      out.println(
+        f"${function.name}%-50s ${function.calls}%10d " +
+          f"${function.p50}%10d ${function.p99}%10d " +
+          f"${function.p999}%10d ${function.max}%10d ns"
+      )
+    }
+  }
+
+  def main(args: Array[String]): Unit = {
+    val out = new PrintWriter(System.out)
+    print(summarize(readFiles(args)))(out)
+    out.flush()
+  }
+
+}
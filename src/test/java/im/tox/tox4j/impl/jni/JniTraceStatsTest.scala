@@ -0,0 +1,54 @@
+package im.tox.tox4j.impl.jni
+
+import java.io.File
+
+import im.tox.tox4j.core.data.ToxFriendNumber
+import im.tox.tox4j.impl.jni.JniTraceStats.FunctionStats
+import im.tox.tox4j.impl.jni.proto.JniLogEntry
+import org.scalatest.FunSuite
+
+@SuppressWarnings(Array("org.wartremover.warts.Equals"))
+final class JniTraceStatsTest extends FunSuite {
+
+  private val friendNumber = ToxFriendNumber.fromInt(0).get
+
+  test("latency percentiles per function, slowest total first") {
+    val entries =
+      (1 to 100).map(nanos => JniLogEntry(name = "fast", elapsedNanos = nanos)) :+
+        JniLogEntry(name = "slow", elapsedNanos = 10000)
+
+    assert(JniTraceStats.summarize(entries) == Seq(
+      FunctionStats("slow", 1, 10000, 10000, 10000, 10000, 10000),
+      FunctionStats("fast", 100, 5050, 51, 100, 100, 100)
+    ))
+  }
+
+  test("streamed trace files can be read back") {
+    val path = File.createTempFile("JniTraceStatsTest", "")
+    path.delete()
+
+    val callCount = 1000
+    // Small segments, so that the calls span several files.
+    assert(ToxJniLog.streamTo(path.getPath, 4096))
+    try {
+      ToxCoreImplFactory.withToxUnit { tox =>
+        for (_ <- 0 until callCount) {
+          tox.friendExists(friendNumber)
+        }
+      }
+    } finally {
+      ToxJniLog.stopStreaming()
+    }
+
+    val files = Stream.from(0).map(index => new File(s"${path.getPath}.$index")).takeWhile(_.exists)
+    try {
+      assert(files.length > 1)
+      val entries = JniTraceStats.readFiles(files.map(_.getPath))
+      assert(entries.forall(_.name.nonEmpty))
+      assert(JniTraceStats.summarize(entries).find(_.name == "tox_friend_exists").map(_.calls) == Some(callCount))
+    } finally {
+      files.foreach(_.delete())
+    }
+  }
+
+}
@@ -0,0 +1,119 @@
+package im.tox.tox4j.impl.jni
+
+import java.nio.ByteBuffer
+
+import im.tox.tox4j.av.data.{ AudioChannels, AudioLength, SampleCount, SamplingRate }
+import im.tox.tox4j.av.exceptions.ToxavSendFrameException
+import im.tox.tox4j.core.data.ToxFriendNumber
+import im.tox.tox4j.core.options.ToxOptions
+import im.tox.tox4j.testing.ToxExceptionChecks
+import org.scalatest.FunSuite
+
+/**
+ * The direct buffer send overloads validate their dimensions and buffer
+ * regions before calling toxav. Valid frames reach toxav and fail with
+ * FRIEND_NOT_FOUND, since there are no friends.
+ */
+final class ToxAvDirectSendTest extends FunSuite with ToxExceptionChecks {
+
+  private val friendNumber = ToxFriendNumber.fromInt(0).get
+
+  private val width = 8
+  private val height = 4
+  private val frameSize = width * height * 3 / 2
+
+  private def withToxAv(f: ToxAvImpl => Unit): Unit = {
+    val tox = new ToxCoreImpl(ToxOptions())
+    try {
+      val toxav = new ToxAvImpl(tox)
+      try {
+        f(toxav)
+      } finally {
+        toxav.close()
+      }
+    } finally {
+      tox.close()
+    }
+  }
+
+  test("valid direct video frame reaches toxav") {
+    withToxAv { toxav =>
+      intercept(ToxavSendFrameException.Code.FRIEND_NOT_FOUND) {
+        toxav.videoSendFrame(friendNumber, width, height, ByteBuffer.allocateDirect(frameSize))
+      }
+    }
+  }
+
+  test("direct video frame with invalid dimensions") {
+    withToxAv { toxav =>
+      for ((w, h) <- Seq((0, height), (width, 0), (-width, height), (width, -height), (65536, 2))) {
+        intercept(ToxavSendFrameException.Code.INVALID) {
+          toxav.videoSendFrame(friendNumber, w, h, ByteBuffer.allocateDirect(frameSize))
+        }
+      }
+    }
+  }
+
+  test("direct video frame outside the buffer") {
+    withToxAv { toxav =>
+      assertThrows[IllegalArgumentException] {
+        toxav.videoSendFrame(friendNumber, width, height, ByteBuffer.allocateDirect(frameSize - 1))
+      }
+      val buffer = ByteBuffer.allocateDirect(frameSize)
+      buffer.position(1)
+      assertThrows[IllegalArgumentException] {
+        toxav.videoSendFrame(friendNumber, width, height, buffer)
+      }
+      assertThrows[IllegalArgumentException] {
+        ToxAvJni.toxavVideoSendFrameDirect(toxav.instanceNumber, friendNumber.value, width, height, buffer, -1)
+      }
+      assertThrows[IllegalArgumentException] {
+        toxav.videoSendFrame(friendNumber, width, height, ByteBuffer.allocate(frameSize))
+      }
+    }
+  }
+
+  test("direct RGBA frame with invalid dimensions or stride") {
+    withToxAv { toxav =>
+      val buffer = ByteBuffer.allocateDirect(width * height * 4)
+      for ((w, h, stride) <- Seq((0, height, width * 4), (width, -1, width * 4), (width, height, width * 4 - 1))) {
+        intercept(ToxavSendFrameException.Code.INVALID) {
+          toxav.videoSendFrameRgba(friendNumber, w, h, buffer, stride)
+        }
+      }
+      assertThrows[IllegalArgumentException] {
+        toxav.videoSendFrameRgba(friendNumber, width, height, buffer, width * 4 + 1)
+      }
+    }
+  }
+
+  test("direct audio frame") {
+    val sampleCount = SampleCount(AudioLength.Length20, SamplingRate.Rate48k)
+    val pcmBytes = sampleCount.value * 2 * 2
+
+    withToxAv { toxav =>
+      intercept(ToxavSendFrameException.Code.FRIEND_NOT_FOUND) {
+        toxav.audioSendFrame(friendNumber, ByteBuffer.allocateDirect(pcmBytes), sampleCount, AudioChannels.Stereo, SamplingRate.Rate48k)
+      }
+
+      // Misaligned for shorts.
+      val misaligned = ByteBuffer.allocateDirect(pcmBytes + 1)
+      misaligned.position(1)
+      assertThrows[IllegalArgumentException] {
+        toxav.audioSendFrame(friendNumber, misaligned, sampleCount, AudioChannels.Stereo, SamplingRate.Rate48k)
+      }
+
+      assertThrows[IllegalArgumentException] {
+        toxav.audioSendFrame(friendNumber, ByteBuffer.allocateDirect(pcmBytes - 2), sampleCount, AudioChannels.Stereo, SamplingRate.Rate48k)
+      }
+
+      intercept(ToxavSendFrameException.Code.INVALID) {
+        ToxAvJni.toxavAudioSendFrameDirect(toxav.instanceNumber, friendNumber.value, ByteBuffer.allocateDirect(pcmBytes), 0, -1, 2, 48000)
+      }
+      intercept(ToxavSendFrameException.Code.INVALID) {
+        ToxAvJni.toxavAudioSendFrameDirect(toxav.instanceNumber, friendNumber.value, ByteBuffer.allocateDirect(pcmBytes), 0, sampleCount.value, -2, 48000)
+      }
+    }
+  }
+
+}
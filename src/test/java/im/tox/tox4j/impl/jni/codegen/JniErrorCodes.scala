@@ -9,11 +9,27 @@ import im.tox.tox4j.impl.jni.codegen.cxx.Ast._
 
 object JniErrorCodes extends CodeGenerator {
 
-  def generateErrorCode[E <: Enum[E]](values: Array[E]): Decl = {
-    val exceptionClass = {
-      val name = cxxTypeName(values(0).getClass.getEnclosingClass.getSimpleName)
-      name.substring(name.indexOf('_') + 1, name.lastIndexOf('_'))
-    }
+  private def exceptionClassName(values: Array[_ <: Enum[_]]): String = {
+    val name = cxxTypeName(values(0).getClass.getEnclosingClass.getSimpleName)
+    name.substring(name.indexOf('_') + 1, name.lastIndexOf('_'))
+  }
+
+  /**
+   * The table of exception classes cached in JNI_OnLoad.
+   */
+  def generateExceptionTable(table: String, codes: Seq[Array[_ <: Enum[_]]]): Decl = {
+    MacroCall(
+      FunCall(
+        Identifier("TOX_EXCEPTIONS"),
+        Identifier(table) +: codes.map { values =>
+          FunCall(Identifier("EXCEPTION_CLASS"), Seq(Identifier(exceptionClassName(values))))
+        }
+      )
+    )
+  }
+
+  def generateErrorCode(values: Array[_ <: Enum[_]]): Decl = {
+    val exceptionClass = exceptionClassName(values)
 
     val javaEnum = values(0).getClass.getSimpleName
     val cxxEnum = cxxTypeName(javaEnum)
@@ -46,48 +62,45 @@ object JniErrorCodes extends CodeGenerator {
     )
   }
 
-  writeCode("ToxAv/generated/errors.cpp") {
-    Include("../ToxAv.h") +:
-      Seq(
-        generateErrorCode(ToxavAnswerException.Code.values),
-        generateErrorCode(ToxavBitRateSetException.Code.values),
-        generateErrorCode(ToxavCallControlException.Code.values),
-        generateErrorCode(ToxavCallException.Code.values),
-        generateErrorCode(ToxavNewException.Code.values),
-        generateErrorCode(ToxavSendFrameException.Code.values)
-      )
+  private def writeErrorCodes(path: String, header: String, table: String)(codes: Array[_ <: Enum[_]]*): Unit = {
+    writeCode(path) {
+      Include(header) +: (codes.map(generateErrorCode) :+ generateExceptionTable(table, codes))
+    }
   }
 
-  writeCode("ToxCore/generated/errors.cpp") {
-    Include("../ToxCore.h") +:
-      Seq(
-        generateErrorCode(ToxBootstrapException.Code.values),
-        generateErrorCode(ToxFileControlException.Code.values),
-        generateErrorCode(ToxFileGetException.Code.values),
-        generateErrorCode(ToxFileSeekException.Code.values),
-        generateErrorCode(ToxFileSendChunkException.Code.values),
-        generateErrorCode(ToxFileSendException.Code.values),
-        generateErrorCode(ToxFriendAddException.Code.values),
-        generateErrorCode(ToxFriendByPublicKeyException.Code.values),
-        generateErrorCode(ToxFriendCustomPacketException.Code.values),
-        generateErrorCode(ToxFriendDeleteException.Code.values),
-        generateErrorCode(ToxFriendGetPublicKeyException.Code.values),
-        generateErrorCode(ToxFriendSendMessageException.Code.values),
-        generateErrorCode(ToxGetPortException.Code.values),
-        generateErrorCode(ToxNewException.Code.values),
-        generateErrorCode(ToxSetInfoException.Code.values),
-        generateErrorCode(ToxSetTypingException.Code.values)
-      )
-  }
+  writeErrorCodes("ToxAv/generated/errors.cpp", "../ToxAv.h", "toxav_exceptions")(
+    ToxavAnswerException.Code.values,
+    ToxavBitRateSetException.Code.values,
+    ToxavCallControlException.Code.values,
+    ToxavCallException.Code.values,
+    ToxavNewException.Code.values,
+    ToxavSendFrameException.Code.values
+  )
 
-  writeCode("ToxCrypto/generated/errors.cpp") {
-    Include("../ToxCrypto.h") +:
-      Seq(
-        generateErrorCode(ToxDecryptionException.Code.values),
-        generateErrorCode(ToxEncryptionException.Code.values),
-        generateErrorCode(ToxGetSaltException.Code.values),
-        generateErrorCode(ToxKeyDerivationException.Code.values)
-      )
-  }
+  writeErrorCodes("ToxCore/generated/errors.cpp", "../ToxCore.h", "tox_exceptions")(
+    ToxBootstrapException.Code.values,
+    ToxFileControlException.Code.values,
+    ToxFileGetException.Code.values,
+    ToxFileSeekException.Code.values,
+    ToxFileSendChunkException.Code.values,
+    ToxFileSendException.Code.values,
+    ToxFriendAddException.Code.values,
+    ToxFriendByPublicKeyException.Code.values,
+    ToxFriendCustomPacketException.Code.values,
+    ToxFriendDeleteException.Code.values,
+    ToxFriendGetPublicKeyException.Code.values,
+    ToxFriendSendMessageException.Code.values,
+    ToxGetPortException.Code.values,
+    ToxNewException.Code.values,
+    ToxSetInfoException.Code.values,
+    ToxSetTypingException.Code.values
+  )
+
+  writeErrorCodes("ToxCrypto/generated/errors.cpp", "../ToxCrypto.h", "toxcrypto_exceptions")(
+    ToxDecryptionException.Code.values,
+    ToxEncryptionException.Code.values,
+    ToxGetSaltException.Code.values,
+    ToxKeyDerivationException.Code.values
+  )
 
 }
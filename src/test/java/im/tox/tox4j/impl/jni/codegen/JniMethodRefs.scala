@@ -1,6 +1,6 @@
 package im.tox.tox4j.impl.jni.codegen
 
-import java.lang.reflect.Modifier
+import java.lang.reflect.{ Method, Modifier }
 
 import im.tox.tox4j.impl.jni.codegen.NameConversions.cxxVarName
 import im.tox.tox4j.impl.jni.codegen.cxx.Ast._
@@ -23,19 +23,72 @@ object JniMethodRefs extends CodeGenerator {
       }
   }
 
+  private val primitiveSignatures = Map[Class[_], String](
+    classOf[Boolean] -> "Z",
+    classOf[Byte] -> "B",
+    classOf[Char] -> "C",
+    classOf[Short] -> "S",
+    classOf[Int] -> "I",
+    classOf[Long] -> "J",
+    classOf[Float] -> "F",
+    classOf[Double] -> "D",
+    classOf[Unit] -> "V"
+  )
+
+  private def typeSignature(clazz: Class[_]): String = {
+    if (clazz.isArray) {
+      "[" + typeSignature(clazz.getComponentType)
+    } else {
+      primitiveSignatures.getOrElse(clazz, "L" + clazz.getName.replace('.', '/') + ";")
+    }
+  }
+
+  def methodSignature(method: Method): String = {
+    method.getParameterTypes.map(typeSignature).mkString("(", "", ")") + typeSignature(method.getReturnType)
+  }
+
+  /**
+   * All native methods with their JNI signatures, for RegisterNatives.
+   */
+  def generateRegistrations(clazz: Class[_]): TranslationUnit = {
+    clazz.getDeclaredMethods
+      .filter(method => Modifier.isNative(method.getModifiers))
+      .map(method => (method.getName, methodSignature(method)))
+      .sorted
+      .map {
+        case (name, signature) =>
+          MacroCall(FunCall(Identifier("JNI_NATIVE"), Seq(Identifier(name), StringLiteral(signature))))
+      }
+  }
+
   writeCode("ToxAv/generated/natives.h", "\n") {
     Comment(classOf[ToxAvJni].getName) +:
       generateNativeDecls(classOf[ToxAvJni])
   }
 
+  writeCode("ToxAv/generated/registrations.h", "\n") {
+    Comment(classOf[ToxAvJni].getName) +:
+      generateRegistrations(classOf[ToxAvJni])
+  }
+
   writeCode("ToxCore/generated/natives.h", "\n") {
     Comment(classOf[ToxCoreJni].getName) +:
       generateNativeDecls(classOf[ToxCoreJni])
   }
 
+  writeCode("ToxCore/generated/registrations.h", "\n") {
+    Comment(classOf[ToxCoreJni].getName) +:
+      generateRegistrations(classOf[ToxCoreJni])
+  }
+
   writeCode("ToxCrypto/generated/natives.h", "\n") {
     Comment(classOf[ToxCryptoJni].getName) +:
       generateNativeDecls(classOf[ToxCryptoJni])
   }
 
+  writeCode("ToxCrypto/generated/registrations.h", "\n") {
+    Comment(classOf[ToxCryptoJni].getName) +:
+      generateRegistrations(classOf[ToxCryptoJni])
+  }
+
 }